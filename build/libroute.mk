@@ -4,6 +4,7 @@ ROUTE_SOURCES = \
 	$(ROUTE_SRC_DIR)/Config.cpp \
 	$(ROUTE_SRC_DIR)/RoutePlanner.cpp \
 	$(ROUTE_SRC_DIR)/AirspaceRoute.cpp \
+	$(ROUTE_SRC_DIR)/AirspaceClearanceGrid.cpp \
 	$(ROUTE_SRC_DIR)/TerrainRoute.cpp \
 	$(ROUTE_SRC_DIR)/RouteLink.cpp \
 	$(ROUTE_SRC_DIR)/RoutePolar.cpp \
@@ -101,7 +101,7 @@ TEST_NAMES = \
 	TestColorRamp TestGeoPoint TestDiffFilter \
 	TestFileUtil TestPolars TestCSVLine TestGlidePolar \
 	test_replay_task TestProjection TestFlatPoint TestFlatLine TestFlatGeoPoint \
-	TestMacCready TestOrderedTask TestAATPoint \
+	TestMacCready TestOrderedTask TestTaskOptTarget TestTaskDijkstra TestAATPoint \
 	TestPlanes \
 	TestTaskPoint \
 	TestTaskWaypoint \
@@ -122,7 +122,9 @@ TEST_NAMES = \
 	TestIGCFilenameFormatter \
 	TestLXNToIGC \
 	TestLeastSquares \
-	TestThermalBand
+	TestThermalBand \
+	TestAirspaceWarningManager \
+	TestCloudJournal
 
 
 TESTS = $(call name-to-bin,$(TEST_NAMES))
@@ -149,6 +151,18 @@ $(TEST_SRC_DIR)/tap.c \
 $(TEST_SRC_DIR)/TestThermalBand.cpp
 $(eval $(call link-program,TestThermalBand,TEST_THERMALBAND))
 
+TEST_AIRSPACE_WARNING_MANAGER_SOURCES = \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(SRC)/Engine/Task/Stats/TaskStats.cpp \
+	$(SRC)/Engine/Task/Stats/CommonStats.cpp \
+	$(SRC)/Engine/Task/Stats/ElementStat.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceWarningManager.cpp
+TEST_AIRSPACE_WARNING_MANAGER_DEPENDS = AIRSPACE GLIDE GEO MATH UTIL
+$(eval $(call link-program,TestAirspaceWarningManager,TEST_AIRSPACE_WARNING_MANAGER))
+
 TEST_OVERWRITING_RING_BUFFER_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestOverwritingRingBuffer.cpp
@@ -238,9 +252,25 @@ TEST_ORDERED_TASK_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestOrderedTask.cpp
 TEST_ORDERED_TASK_OBJS = $(call SRC_TO_OBJ,$(TEST_ORDERED_TASK_SOURCES))
-TEST_ORDERED_TASK_DEPENDS = TASK ROUTE GLIDE WAYPOINT GEO TIME MATH UTIL
+TEST_ORDERED_TASK_DEPENDS = TASK ROUTE GLIDE WAYPOINT GEO TIME OS MATH UTIL
 $(eval $(call link-program,TestOrderedTask,TEST_ORDERED_TASK))
 
+TEST_TASK_OPT_TARGET_SOURCES = \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(SRC)/Engine/Util/Gradient.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTaskOptTarget.cpp
+TEST_TASK_OPT_TARGET_OBJS = $(call SRC_TO_OBJ,$(TEST_TASK_OPT_TARGET_SOURCES))
+TEST_TASK_OPT_TARGET_DEPENDS = TASK ROUTE GLIDE WAYPOINT GEO TIME OS MATH UTIL
+$(eval $(call link-program,TestTaskOptTarget,TEST_TASK_OPT_TARGET))
+
+TEST_TASK_DIJKSTRA_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTaskDijkstra.cpp
+TEST_TASK_DIJKSTRA_OBJS = $(call SRC_TO_OBJ,$(TEST_TASK_DIJKSTRA_SOURCES))
+TEST_TASK_DIJKSTRA_DEPENDS = TASK GEO OS MATH UTIL
+$(eval $(call link-program,TestTaskDijkstra,TEST_TASK_DIJKSTRA))
+
 TEST_AAT_POINT_SOURCES = \
 	$(SRC)/Engine/Util/Gradient.cpp \
 	$(SRC)/Engine/Navigation/Aircraft.cpp \
@@ -293,7 +323,7 @@ TEST_TROUTE_SOURCES = \
 	$(TEST_SRC_DIR)/Printing.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/test_troute.cpp
-TEST_TROUTE_DEPENDS = TERRAIN IO ZZIP OS ROUTE GLIDE GEO MATH UTIL
+TEST_TROUTE_DEPENDS = TERRAIN IO ZZIP OS ROUTE GLIDE THREAD GEO MATH UTIL
 $(eval $(call link-program,test_troute,TEST_TROUTE))
 
 TEST_REACH_SOURCES = \
@@ -302,7 +332,7 @@ TEST_REACH_SOURCES = \
 	$(TEST_SRC_DIR)/Printing.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/test_reach.cpp
-TEST_REACH_DEPENDS = TERRAIN IO ZZIP OS ROUTE GLIDE GEO MATH UTIL
+TEST_REACH_DEPENDS = TERRAIN IO ZZIP OS ROUTE GLIDE THREAD GEO MATH UTIL
 $(eval $(call link-program,test_reach,TEST_REACH))
 
 TEST_ROUTE_SOURCES = \
@@ -318,7 +348,7 @@ TEST_ROUTE_SOURCES = \
 	$(TEST_SRC_DIR)/harness_airspace.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/test_route.cpp
-TEST_ROUTE_DEPENDS = TERRAIN IO ZZIP OS ROUTE AIRSPACE GLIDE GEO MATH UTIL
+TEST_ROUTE_DEPENDS = TERRAIN IO ZZIP OS ROUTE AIRSPACE GLIDE THREAD GEO MATH UTIL
 $(eval $(call link-program,test_route,TEST_ROUTE))
 
 TEST_REPLAY_TASK_SOURCES = \
@@ -529,6 +559,18 @@ TEST_FILE_UTIL_SOURCES = \
 TEST_FILE_UTIL_DEPENDS = UTIL
 $(eval $(call link-program,TestFileUtil,TEST_FILE_UTIL))
 
+TEST_CLOUD_JOURNAL_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/Serialiser.cpp \
+	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/Thermal.cpp \
+	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/Journal.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestCloudJournal.cpp
+TEST_CLOUD_JOURNAL_DEPENDS = IO OS GEO MATH UTIL
+$(eval $(call link-program,TestCloudJournal,TEST_CLOUD_JOURNAL))
+
 TEST_GEO_POINT_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestGeoPoint.cpp
@@ -726,11 +768,14 @@ DEBUG_PROGRAM_NAMES = \
 	TestTrace \
 	FlightTable \
 	RunTrace \
-	RunOLCAnalysis \
+	RunOLCAnalysis BenchmarkOLCTriangle BenchmarkContest \
+	BenchmarkAirspaceWarnings \
 	RunWaveComputer \
 	FlightPath \
 	BenchmarkProjection \
+	BenchmarkGlideSolvers \
 	BenchmarkFAITriangleSector \
+	BenchmarkPolygonInterior \
 	DumpTextFile DumpTextZip DumpTextInflate WriteTextFile RunTextWriter \
 	DumpHexColor \
 	RunXMLParser \
@@ -740,7 +785,7 @@ DEBUG_PROGRAM_NAMES = \
 	ReadGRecord VerifyGRecord AppendGRecord FixGRecord \
 	AddChecksum \
 	KeyCodeDumper \
-	LoadTopography LoadTerrain \
+	LoadTopography LoadTerrain BenchmarkTerrainSampling \
 	RunHeightMatrix \
 	RunInputParser \
 	RunWaypointParser RunAirspaceParser \
@@ -768,6 +813,7 @@ DEBUG_PROGRAM_NAMES = \
 	RunHorizonRenderer \
 	RunFinalGlideBarRenderer \
 	RunFAITriangleSectorRenderer \
+	BenchmarkTerrainRenderer \
 	RunFlightListRenderer \
 	RunProgressWindow \
 	RunJobDialog \
@@ -801,7 +847,7 @@ DEBUG_PROGRAM_NAMES += \
 endif
 
 ifeq ($(HAVE_HTTP),y)
-DEBUG_PROGRAM_NAMES += DownloadFile RunDownloadToFile RunNOAADownloader RunSkyLinesTracking RunLiveTrack24
+DEBUG_PROGRAM_NAMES += DownloadFile RunDownloadToFile RunNOAADownloader RunSkyLinesTracking RunCloudLoad RunLiveTrack24
 endif
 
 ifeq ($(TARGET_IS_LINUX),y)
@@ -816,6 +862,10 @@ ifeq ($(LUA),y)
 DEBUG_PROGRAM_NAMES += RunLua
 endif
 
+ifeq ($(OPENGL),y)
+DEBUG_PROGRAM_NAMES += PackTopography
+endif
+
 DEBUG_PROGRAMS = $(call name-to-bin,$(DEBUG_PROGRAM_NAMES))
 
 ifeq ($(LUA),y)
@@ -897,6 +947,12 @@ BENCHMARK_PROJECTION_DEPENDS = MATH
 BENCHMARK_PROJECTION_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,BenchmarkProjection,BENCHMARK_PROJECTION))
 
+BENCHMARK_GLIDE_SOLVERS_SOURCES = \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(TEST_SRC_DIR)/BenchmarkGlideSolvers.cpp
+BENCHMARK_GLIDE_SOLVERS_DEPENDS = TASK ROUTE GLIDE WAYPOINT GEO TIME OS MATH UTIL
+$(eval $(call link-program,BenchmarkGlideSolvers,BENCHMARK_GLIDE_SOLVERS))
+
 BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 	$(ENGINE_SRC_DIR)/Task/Shapes/FAITriangleSettings.cpp \
 	$(ENGINE_SRC_DIR)/Task/Shapes/FAITriangleArea.cpp \
@@ -904,6 +960,11 @@ BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 BENCHMARK_FAI_TRIANGLE_SECTOR_DEPENDS = GEO MATH
 $(eval $(call link-program,BenchmarkFAITriangleSector,BENCHMARK_FAI_TRIANGLE_SECTOR))
 
+BENCHMARK_POLYGON_INTERIOR_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkPolygonInterior.cpp
+BENCHMARK_POLYGON_INTERIOR_DEPENDS = GEO MATH OS UTIL
+$(eval $(call link-program,BenchmarkPolygonInterior,BENCHMARK_POLYGON_INTERIOR))
+
 DUMP_TEXT_FILE_SOURCES = \
 	$(TEST_SRC_DIR)/DumpTextFile.cpp
 DUMP_TEXT_FILE_DEPENDS = IO OS ZZIP UTIL
@@ -1013,6 +1074,12 @@ RUN_SL_TRACKING_LDADD = $(DEBUG_REPLAY_LDADD)
 RUN_SL_TRACKING_DEPENDS = LIBNET OS GEO MATH UTIL TIME
 $(eval $(call link-program,RunSkyLinesTracking,RUN_SL_TRACKING))
 
+RUN_CLOUD_LOAD_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(TEST_SRC_DIR)/RunCloudLoad.cpp
+RUN_CLOUD_LOAD_DEPENDS = GEO MATH UTIL
+$(eval $(call link-program,RunCloudLoad,RUN_CLOUD_LOAD))
+
 RUN_LIVETRACK24_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/Tracking/LiveTrack24.cpp \
@@ -1116,6 +1183,8 @@ $(eval $(call link-program,KeyCodeDumper,KEY_CODE_DUMPER))
 LOAD_TOPOGRAPHY_SOURCES = \
 	$(SRC)/Topography/TopographyStore.cpp \
 	$(SRC)/Topography/TopographyFile.cpp \
+	$(SRC)/Topography/PackedTopography.cpp \
+	$(SRC)/Topography/ShapeArena.cpp \
 	$(SRC)/Topography/XShape.cpp \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
@@ -1125,24 +1194,45 @@ ifeq ($(OPENGL),y)
 LOAD_TOPOGRAPHY_SOURCES += \
 	$(SCREEN_SRC_DIR)/OpenGL/Triangulate.cpp
 endif
-LOAD_TOPOGRAPHY_DEPENDS = RESOURCE GEO MATH THREAD IO UTIL SHAPELIB ZZIP
+LOAD_TOPOGRAPHY_DEPENDS = RESOURCE GEO MATH THREAD IO OS UTIL SHAPELIB ZZIP
 LOAD_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,LoadTopography,LOAD_TOPOGRAPHY))
 
+PACK_TOPOGRAPHY_SOURCES = \
+	$(SRC)/Topography/TopographyFile.cpp \
+	$(SRC)/Topography/PackedTopography.cpp \
+	$(SRC)/Topography/ShapeArena.cpp \
+	$(SRC)/Topography/PackedTopographyWriter.cpp \
+	$(SRC)/Topography/XShape.cpp \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SCREEN_SRC_DIR)/OpenGL/Triangulate.cpp \
+	$(TEST_SRC_DIR)/PackTopography.cpp
+PACK_TOPOGRAPHY_DEPENDS = GEO MATH THREAD IO OS UTIL SHAPELIB ZZIP
+PACK_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,PackTopography,PACK_TOPOGRAPHY))
+
 LOAD_TERRAIN_SOURCES = \
 	$(SRC)/Operation/Operation.cpp \
 	$(TEST_SRC_DIR)/LoadTerrain.cpp
 LOAD_TERRAIN_CPPFLAGS = $(SCREEN_CPPFLAGS)
-LOAD_TERRAIN_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+LOAD_TERRAIN_DEPENDS = TERRAIN THREAD GEO MATH IO OS ZZIP UTIL
 $(eval $(call link-program,LoadTerrain,LOAD_TERRAIN))
 
+BENCHMARK_TERRAIN_SAMPLING_SOURCES = \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/BenchmarkTerrainSampling.cpp
+BENCHMARK_TERRAIN_SAMPLING_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_TERRAIN_SAMPLING_DEPENDS = TERRAIN THREAD GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrainSampling,BENCHMARK_TERRAIN_SAMPLING))
+
 RUN_HEIGHT_MATRIX_SOURCES = \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
 	$(SRC)/Operation/Operation.cpp \
 	$(TEST_SRC_DIR)/RunHeightMatrix.cpp
 RUN_HEIGHT_MATRIX_CPPFLAGS = $(SCREEN_CPPFLAGS)
-RUN_HEIGHT_MATRIX_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+RUN_HEIGHT_MATRIX_DEPENDS = TERRAIN THREAD GEO MATH IO OS ZZIP UTIL
 $(eval $(call link-program,RunHeightMatrix,RUN_HEIGHT_MATRIX))
 
 RUN_INPUT_PARSER_SOURCES = \
@@ -1209,6 +1299,7 @@ $(eval $(call link-program,RunFlightParser,RUN_FLIGHT_PARSER))
 
 RUN_AIRSPACE_PARSER_SOURCES = \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Units/Descriptor.cpp \
 	$(SRC)/Units/System.cpp \
 	$(SRC)/Operation/Operation.cpp \
@@ -1664,9 +1755,41 @@ RUN_OLC_SOURCES = \
 	$(TEST_SRC_DIR)/ContestPrinting.cpp \
 	$(TEST_SRC_DIR)/RunOLCAnalysis.cpp
 RUN_OLC_LDADD = $(DEBUG_REPLAY_LDADD)
-RUN_OLC_DEPENDS = CONTEST UTIL GEO MATH TIME
+RUN_OLC_DEPENDS = CONTEST THREAD UTIL GEO MATH TIME
 $(eval $(call link-program,RunOLCAnalysis,RUN_OLC))
 
+BENCHMARK_OLC_TRIANGLE_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/NMEA/Aircraft.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkOLCTriangle.cpp
+BENCHMARK_OLC_TRIANGLE_LDADD = $(DEBUG_REPLAY_LDADD)
+BENCHMARK_OLC_TRIANGLE_DEPENDS = CONTEST THREAD OS UTIL GEO MATH TIME
+$(eval $(call link-program,BenchmarkOLCTriangle,BENCHMARK_OLC_TRIANGLE))
+
+BENCHMARK_CONTEST_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/NMEA/Aircraft.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkContest.cpp
+BENCHMARK_CONTEST_LDADD = $(DEBUG_REPLAY_LDADD)
+BENCHMARK_CONTEST_DEPENDS = CONTEST IO OS UTIL GEO MATH TIME
+$(eval $(call link-program,BenchmarkContest,BENCHMARK_CONTEST))
+
+BENCHMARK_AIRSPACE_WARNINGS_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/NMEA/Aircraft.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaceWarnings.cpp
+BENCHMARK_AIRSPACE_WARNINGS_LDADD = $(DEBUG_REPLAY_LDADD)
+BENCHMARK_AIRSPACE_WARNINGS_DEPENDS = AIRSPACE IO OS ZZIP UTIL GEO MATH TIME
+$(eval $(call link-program,BenchmarkAirspaceWarnings,BENCHMARK_AIRSPACE_WARNINGS))
+
 RUN_WAVE_COMPUTER_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/Computer/WaveComputer.cpp \
@@ -1698,7 +1821,7 @@ ANALYSE_FLIGHT_SOURCES = \
 	$(TEST_SRC_DIR)/FlightPhaseDetector.cpp \
 	$(TEST_SRC_DIR)/AnalyseFlight.cpp
 ANALYSE_FLIGHT_LDADD = $(DEBUG_REPLAY_LDADD)
-ANALYSE_FLIGHT_DEPENDS = CONTEST UTIL GEO MATH TIME
+ANALYSE_FLIGHT_DEPENDS = CONTEST THREAD UTIL GEO MATH TIME
 $(eval $(call link-program,AnalyseFlight,ANALYSE_FLIGHT))
 
 FLIGHT_PATH_SOURCES = \
@@ -1855,6 +1978,8 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Task/ProtectedRoutePlanner.cpp \
 	$(SRC)/Task/RoutePlannerGlue.cpp \
 	$(SRC)/Topography/TopographyFile.cpp \
+	$(SRC)/Topography/PackedTopography.cpp \
+	$(SRC)/Topography/ShapeArena.cpp \
 	$(SRC)/Topography/TopographyStore.cpp \
 	$(SRC)/Topography/Thread.cpp \
 	$(SRC)/Topography/TopographyFileRenderer.cpp \
@@ -2168,6 +2293,20 @@ RUN_FAI_TRIANGLE_SECTOR_RENDERER_SOURCES = \
 RUN_FAI_TRIANGLE_SECTOR_RENDERER_DEPENDS = FORM SCREEN EVENT RESOURCE ASYNC OS THREAD GEO MATH UTIL
 $(eval $(call link-program,RunFAITriangleSectorRenderer,RUN_FAI_TRIANGLE_SECTOR_RENDERER))
 
+BENCHMARK_TERRAIN_RENDERER_SOURCES = \
+	$(MORE_SCREEN_SOURCES) \
+	$(SRC)/Look/ButtonLook.cpp \
+	$(SRC)/Screen/Ramp.cpp \
+	$(SRC)/Renderer/GeoBitmapRenderer.cpp \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/FakeAsset.cpp \
+	$(TEST_SRC_DIR)/Fonts.cpp \
+	$(TEST_SRC_DIR)/BenchmarkTerrainRenderer.cpp
+BENCHMARK_TERRAIN_RENDERER_DEPENDS = TERRAIN FORM SCREEN EVENT RESOURCE IO ASYNC OS THREAD ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkTerrainRenderer,BENCHMARK_TERRAIN_RENDERER))
+
 RUN_FLIGHT_LIST_RENDERER_SOURCES = \
 	$(MORE_SCREEN_SOURCES) \
 	$(SRC)/Look/ButtonLook.cpp \
@@ -2338,6 +2477,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
 	$(SRC)/Renderer/AirspaceRendererSettings.cpp \
@@ -0,0 +1,292 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Util/tstring.hpp"
+
+#include <memory>
+
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+
+struct CacheHeader {
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t version;
+  uint32_t n_airspaces;
+  uint32_t n_points;
+  uint32_t n_chars;
+};
+
+struct CacheAltitude {
+  double altitude, flight_level, altitude_above_terrain;
+  int8_t reference;
+  uint8_t reserved[7];
+};
+
+/**
+ * One airspace.  Its points and strings follow in separate arrays,
+ * in the order of the records.
+ */
+struct CacheAirspace {
+  CacheAltitude base, top;
+
+  /**
+   * The radius of a circle [m].
+   */
+  double radius;
+
+  /**
+   * The number of points; for a circle, this is 1 (the center).
+   */
+  uint32_t n_points;
+
+  uint32_t name_length, radio_length;
+
+  uint8_t shape, type, days, reserved;
+};
+
+struct CachePoint {
+  double longitude, latitude;
+};
+
+static_assert(sizeof(CacheHeader) % 8 == 0, "Wrong size");
+static_assert(sizeof(CacheAirspace) % 8 == 0, "Wrong size");
+static_assert(sizeof(AirspaceActivity) == 1, "Wrong size");
+
+}
+
+static CacheAltitude
+ExportAltitude(const AirspaceAltitude &src)
+{
+  CacheAltitude dest;
+  memset(&dest, 0, sizeof(dest));
+  dest.altitude = src.altitude;
+  dest.flight_level = src.flight_level;
+  dest.altitude_above_terrain = src.altitude_above_terrain;
+  dest.reference = int8_t(src.reference);
+  return dest;
+}
+
+static AirspaceAltitude
+ImportAltitude(const CacheAltitude &src)
+{
+  AirspaceAltitude dest;
+  dest.altitude = src.altitude;
+  dest.flight_level = src.flight_level;
+  dest.altitude_above_terrain = src.altitude_above_terrain;
+  dest.reference = AltitudeReference(src.reference);
+  return dest;
+}
+
+static CachePoint
+ExportPoint(const GeoPoint &src)
+{
+  return {src.longitude.Native(), src.latitude.Native()};
+}
+
+static GeoPoint
+ImportPoint(const CachePoint &src)
+{
+  return GeoPoint(Angle::Native(src.longitude), Angle::Native(src.latitude));
+}
+
+template<typename T>
+static bool
+WriteArray(FILE *file, const std::vector<T> &v)
+{
+  return fwrite(v.data(), sizeof(T), v.size(), file) == v.size();
+}
+
+bool
+SaveAirspaceCache(FILE *file,
+                  const std::vector<const AbstractAirspace *> &airspaces)
+{
+  std::vector<CacheAirspace> records;
+  std::vector<CachePoint> points;
+  std::vector<TCHAR> chars;
+
+  records.reserve(airspaces.size());
+
+  for (const AbstractAirspace *as : airspaces) {
+    CacheAirspace record;
+    memset(&record, 0, sizeof(record));
+
+    record.base = ExportAltitude(as->GetBase());
+    record.top = ExportAltitude(as->GetTop());
+    record.shape = uint8_t(as->GetShape());
+    record.type = as->GetType();
+
+    const AirspaceActivity days = as->GetDays();
+    memcpy(&record.days, &days, sizeof(days));
+
+    if (as->GetShape() == AbstractAirspace::Shape::CIRCLE) {
+      const AirspaceCircle &circle = (const AirspaceCircle &)*as;
+      record.radius = circle.GetRadius();
+      record.n_points = 1;
+      points.push_back(ExportPoint(circle.GetCenter()));
+    } else {
+      record.n_points = as->GetPoints().size();
+      for (const auto &p : as->GetPoints())
+        points.push_back(ExportPoint(p.GetLocation()));
+    }
+
+    const TCHAR *name = as->GetName();
+    record.name_length = _tcslen(name);
+    chars.insert(chars.end(), name, name + record.name_length);
+
+    const tstring &radio = as->GetRadioText();
+    record.radio_length = radio.length();
+    chars.insert(chars.end(), radio.begin(), radio.end());
+
+    records.push_back(record);
+  }
+
+  CacheHeader header;
+  memset(&header, 0, sizeof(header));
+  header.version = CacheHeader::VERSION;
+  header.n_airspaces = records.size();
+  header.n_points = points.size();
+  header.n_chars = chars.size();
+
+  return fwrite(&header, sizeof(header), 1, file) == 1 &&
+    WriteArray(file, records) &&
+    WriteArray(file, points) &&
+    WriteArray(file, chars);
+}
+
+/**
+ * Check the records against the array sizes in the header.
+ */
+static bool
+Verify(const CacheHeader &header, const CacheAirspace *records)
+{
+  uint64_t n_points = 0, n_chars = 0;
+
+  for (unsigned i = 0; i < header.n_airspaces; ++i) {
+    const CacheAirspace &record = records[i];
+
+    if (record.type >= AIRSPACECLASSCOUNT)
+      return false;
+
+    switch (AbstractAirspace::Shape(record.shape)) {
+    case AbstractAirspace::Shape::CIRCLE:
+      if (record.n_points != 1)
+        return false;
+      break;
+
+    case AbstractAirspace::Shape::POLYGON:
+      if (record.n_points < 3)
+        return false;
+      break;
+
+    default:
+      return false;
+    }
+
+    n_points += record.n_points;
+    n_chars += uint64_t(record.name_length) + record.radio_length;
+  }
+
+  return n_points == header.n_points && n_chars == header.n_chars;
+}
+
+bool
+LoadAirspaceCache(FILE *file, Airspaces &airspaces)
+{
+  /* read the remainder of the file into memory at once */
+
+  const long start = ftell(file);
+  if (start < 0 || fseek(file, 0, SEEK_END) != 0)
+    return false;
+
+  const long end = ftell(file);
+  if (end < start || fseek(file, start, SEEK_SET) != 0)
+    return false;
+
+  const size_t size = end - start;
+  if (size < sizeof(CacheHeader))
+    return false;
+
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[size]);
+  if (fread(buffer.get(), 1, size, file) != size)
+    return false;
+
+  const CacheHeader &header = *(const CacheHeader *)buffer.get();
+  if (header.version != CacheHeader::VERSION ||
+      size != sizeof(header) +
+      uint64_t(header.n_airspaces) * sizeof(CacheAirspace) +
+      uint64_t(header.n_points) * sizeof(CachePoint) +
+      uint64_t(header.n_chars) * sizeof(TCHAR))
+    return false;
+
+  const CacheAirspace *record = (const CacheAirspace *)(&header + 1);
+  const CachePoint *point = (const CachePoint *)(record + header.n_airspaces);
+  const TCHAR *chars = (const TCHAR *)(point + header.n_points);
+
+  if (!Verify(header, record))
+    return false;
+
+  /* now build the airspaces */
+
+  std::vector<GeoPoint> polygon;
+
+  for (unsigned i = 0; i < header.n_airspaces; ++i, ++record) {
+    AbstractAirspace *as;
+    if (AbstractAirspace::Shape(record->shape) ==
+        AbstractAirspace::Shape::CIRCLE) {
+      as = new AirspaceCircle(ImportPoint(*point), record->radius);
+    } else {
+      polygon.clear();
+      for (unsigned j = 0; j < record->n_points; ++j)
+        polygon.push_back(ImportPoint(point[j]));
+
+      as = new AirspacePolygon(polygon);
+    }
+
+    point += record->n_points;
+
+    tstring name(chars, record->name_length);
+    chars += record->name_length;
+
+    as->SetProperties(std::move(name), AirspaceClass(record->type),
+                      ImportAltitude(record->base),
+                      ImportAltitude(record->top));
+
+    as->SetRadio(tstring(chars, record->radio_length));
+    chars += record->radio_length;
+
+    AirspaceActivity days;
+    memcpy(&days, &record->days, sizeof(days));
+    as->SetDays(days);
+
+    airspaces.Add(as);
+  }
+
+  return true;
+}
@@ -0,0 +1,53 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_CACHE_HPP
+#define XCSOAR_AIRSPACE_CACHE_HPP
+
+#include <vector>
+
+#include <stdio.h>
+
+class AbstractAirspace;
+class Airspaces;
+
+/**
+ * Write the given airspaces (as they were returned by the parser,
+ * i.e. before altitudes were adjusted to QNH or terrain) to a cache
+ * file.  The format is specific to the platform and build; it is
+ * versioned, and will simply be rejected by LoadAirspaceCache() if
+ * it doesn't match.
+ */
+bool
+SaveAirspaceCache(FILE *file,
+                  const std::vector<const AbstractAirspace *> &airspaces);
+
+/**
+ * Read all airspaces from a cache file written by
+ * SaveAirspaceCache() with a single read and add them to the
+ * #Airspaces object.  If the file is invalid, nothing is added.
+ */
+bool
+LoadAirspaceCache(FILE *file, Airspaces &airspaces);
+
+#endif
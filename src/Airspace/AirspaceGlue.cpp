@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "Airspace/AirspaceGlue.hpp"
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Profile/ProfileKeys.hpp"
 #include "Operation/Operation.hpp"
@@ -33,10 +34,18 @@ Copyright_License {
 #include "IO/ZipArchive.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "IO/MapFile.hpp"
+#include "IO/FileCache.hpp"
 #include "Profile/Profile.hpp"
 
+#include <vector>
+
 #include <string.h>
 
+static const TCHAR *const airspace_cache_name = _T("airspace");
+static const TCHAR *const additional_airspace_cache_name =
+  _T("airspace-additional");
+static const TCHAR *const map_airspace_cache_name = _T("airspace-map");
+
 static bool
 ParseAirspaceFile(AirspaceParser &parser, Path path,
                   OperationEnvironment &operation)
@@ -74,8 +83,77 @@ try {
   return false;
 }
 
+static bool
+LoadCache(FileCache &cache, const TCHAR *name, Path original_path,
+          Airspaces &airspaces)
+{
+  bool success = false;
+
+  FILE *file = cache.Load(name, original_path);
+  if (file != nullptr) {
+    success = LoadAirspaceCache(file, airspaces);
+    fclose(file);
+
+    if (!success)
+      cache.Flush(name);
+  }
+
+  return success;
+}
+
+/**
+ * Save the airspaces which were added to the #Airspaces object
+ * starting at the given position of Airspaces::GetPending().
+ */
+static void
+SaveCache(FileCache &cache, const TCHAR *name, Path original_path,
+          const Airspaces &airspaces, unsigned first)
+{
+  const auto &pending = airspaces.GetPending();
+  if (first >= pending.size())
+    return;
+
+  const std::vector<const AbstractAirspace *> v(pending.begin() + first,
+                                                pending.end());
+
+  FILE *file = cache.Save(name, original_path);
+  if (file != nullptr) {
+    if (SaveAirspaceCache(file, v))
+      cache.Commit(name, file);
+    else
+      cache.Cancel(name, file);
+  }
+}
+
+/**
+ * Load an airspace file, from the #FileCache if it is up to date, or
+ * else by parsing it (and updating the cache).
+ *
+ * @param cache_path the file the cache entry is checked against
+ */
+template<typename P>
+static bool
+LoadAirspaceFile(Airspaces &airspaces,
+                  FileCache *cache, const TCHAR *cache_name,
+                  Path cache_path, P &&parse)
+{
+  if (cache != nullptr &&
+      LoadCache(*cache, cache_name, cache_path, airspaces))
+    return true;
+
+  const unsigned first = airspaces.GetPending().size();
+
+  if (!parse())
+    return false;
+
+  if (cache != nullptr)
+    SaveCache(*cache, cache_name, cache_path, airspaces, first);
+
+  return true;
+}
+
 void
-ReadAirspace(Airspaces &airspaces,
+ReadAirspace(Airspaces &airspaces, FileCache *cache,
              RasterTerrain *terrain,
              const AtmosphericPressure &press,
              OperationEnvironment &operation)
@@ -90,16 +168,28 @@ ReadAirspace(Airspaces &airspaces,
   // Read the airspace filenames from the registry
   auto path = Profile::GetPath(ProfileKeys::AirspaceFile);
   if (!path.IsNull())
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+    airspace_ok |= LoadAirspaceFile(airspaces, cache, airspace_cache_name,
+                                    path, [&](){
+        return ParseAirspaceFile(parser, path, operation);
+      });
 
   path = Profile::GetPath(ProfileKeys::AdditionalAirspaceFile);
   if (!path.IsNull())
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+    airspace_ok |= LoadAirspaceFile(airspaces, cache,
+                                    additional_airspace_cache_name,
+                                    path, [&](){
+        return ParseAirspaceFile(parser, path, operation);
+      });
 
   auto archive = OpenMapFile();
-  if (archive)
-    airspace_ok |= ParseAirspaceFile(parser, archive->get(), "airspace.txt",
-                                     operation);
+  if (archive) {
+    const auto map_path = Profile::GetPath(ProfileKeys::MapFile);
+    airspace_ok |= LoadAirspaceFile(airspaces, cache, map_airspace_cache_name,
+                                    map_path, [&](){
+        return ParseAirspaceFile(parser, archive->get(), "airspace.txt",
+                                 operation);
+      });
+  }
 
   if (airspace_ok) {
     airspaces.Optimise();
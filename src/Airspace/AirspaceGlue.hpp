@@ -27,13 +27,16 @@ Copyright_License {
 class RasterTerrain;
 class AtmosphericPressure;
 class Airspaces;
+class FileCache;
 class OperationEnvironment;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache an optional cache for the parsed airspace files
  */
 void
-ReadAirspace(Airspaces &airspaces,
+ReadAirspace(Airspaces &airspaces, FileCache *cache,
              RasterTerrain *terrain,
              const AtmosphericPressure &press,
              OperationEnvironment &operation);
@@ -23,7 +23,6 @@ Copyright_License {
 
 #include "Client.hpp"
 #include "Serialiser.hpp"
-#include "Geo/Boost/RangeBox.hpp"
 #include "Tracking/SkyLines/Protocol.hpp"
 #include "Tracking/SkyLines/Assemble.hpp"
 #include "Tracking/SkyLines/Import.hpp"
@@ -61,8 +60,8 @@ CloudClientContainer::Make(const boost::asio::ip::udp::endpoint &endpoint,
   auto result = key_set.insert_check(key, key_set.hash_function(),
                                      key_set.key_eq(), hint);
   if (result.second) {
-    auto client = std::make_shared<CloudClient>(endpoint, key, next_id++,
-                                                location, altitude);
+    auto *client = new CloudClient(endpoint, key, next_id++,
+                                   location, altitude);
     Insert(*client);
     return *client;
   } else {
@@ -90,10 +89,8 @@ CloudClientContainer::Refresh(CloudClient &client,
   Refresh(client, endpoint);
 
   if (location != client.location) {
-    auto ptr = client.shared_from_this();
-    rtree.remove(ptr);
     client.location = location;
-    rtree.insert(ptr);
+    grid.Move(client);
   }
 
   client.altitude = altitude;
@@ -105,7 +102,7 @@ CloudClientContainer::Insert(CloudClient &client)
   list.push_front(client);
   key_set.insert(client);
   id_set.push_back(client);
-  rtree.insert(client.shared_from_this());
+  grid.Insert(client);
 }
 
 void
@@ -114,7 +111,33 @@ CloudClientContainer::Remove(CloudClient &client)
   list.erase(list.iterator_to(client));
   key_set.erase(key_set.iterator_to(client));
   id_set.erase(id_set.iterator_to(client));
-  rtree.remove(client.shared_from_this());
+  grid.Remove(client);
+  delete &client;
+}
+
+void
+CloudClientContainer::Restore(const CloudClient &src)
+{
+  auto *client = Find(src.key);
+  if (client != nullptr && client->id != src.id) {
+    /* the client has expired and come back with a new id */
+    Remove(*client);
+    client = nullptr;
+  }
+
+  if (client == nullptr) {
+    client = new CloudClient(src.endpoint, src.key, src.id,
+                             src.location, src.altitude);
+    Insert(*client);
+
+    if (src.id >= next_id)
+      next_id = src.id + 1;
+  } else
+    Refresh(*client, src.endpoint, src.location, src.altitude);
+
+  client->stamp = src.stamp;
+  client->wants_traffic = src.wants_traffic;
+  client->wants_thermals = src.wants_thermals;
 }
 
 void
@@ -127,8 +150,7 @@ CloudClientContainer::Expire(std::chrono::steady_clock::time_point before)
 CloudClientContainer::query_iterator_range
 CloudClientContainer::QueryWithinRange(GeoPoint location, double range) const
 {
-  const auto q = boost::geometry::index::intersects(BoostRangeBox(location, range));
-  return {rtree.qbegin(q), rtree.qend()};
+  return grid.QueryWithinRange(location, range);
 }
 
 inline Serialiser &
@@ -164,6 +186,16 @@ CloudClient::Save(Serialiser &s) const
 
   s << endpoint;
 
+  if (wants_traffic != std::chrono::steady_clock::time_point::min()) {
+    s.Write8(1);
+    s << wants_traffic;
+  }
+
+  if (wants_thermals != std::chrono::steady_clock::time_point::min()) {
+    s.Write8(2);
+    s << wants_thermals;
+  }
+
   s.Write8(0);
 }
 
@@ -181,13 +213,23 @@ CloudClient::Load(Deserialiser &s)
   boost::asio::ip::udp::endpoint endpoint;
   s >> endpoint;
 
-  s.Read8();
-
   CloudClient client(endpoint, FromBE64(fix.header.key),
                      id,
                      SkyLinesTracking::ImportGeoPoint(fix.location),
                      (int16_t)FromBE16(fix.altitude));
   client.stamp = stamp;
+
+  uint8_t section = s.Read8();
+  if (section == 1) {
+    s >> client.wants_traffic;
+    section = s.Read8();
+  }
+
+  if (section == 2) {
+    s >> client.wants_thermals;
+    section = s.Read8();
+  }
+
   return client;
 }
 
@@ -211,7 +253,7 @@ CloudClientContainer::Load(Deserialiser &s)
   next_id = s.Read32();
 
   while (s.Read8() != 0) {
-    auto client = std::make_shared<CloudClient>(CloudClient::Load(s));
+    auto *client = new CloudClient(CloudClient::Load(s));
     Insert(*client);
   }
 
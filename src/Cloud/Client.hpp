@@ -24,16 +24,14 @@ Copyright_License {
 #ifndef XCSOAR_CLOUD_CLIENT_HPP
 #define XCSOAR_CLOUD_CLIENT_HPP
 
-#include "Geo/Boost/GeoPoint.hpp"
+#include "Grid.hpp"
+#include "Geo/GeoPoint.hpp"
 
 #include <boost/intrusive/list.hpp>
 #include <boost/intrusive/set.hpp>
 #include <boost/intrusive/unordered_set.hpp>
-#include <boost/geometry/index/rtree.hpp>
-#include <boost/range/iterator_range_core.hpp>
 #include <boost/asio/ip/udp.hpp>
 
-#include <memory>
 #include <chrono>
 
 class Serialiser;
@@ -43,7 +41,7 @@ class Deserialiser;
  * A client which has submitted data to us recently.
  */
 struct CloudClient
-  : std::enable_shared_from_this<CloudClient>,
+  : CloudGridItem,
     boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
     boost::intrusive::set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
     boost::intrusive::unordered_set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>
@@ -147,23 +145,18 @@ struct CloudClient
   static CloudClient Load(Deserialiser &s);
 };
 
-using CloudClientPtr = std::shared_ptr<CloudClient>;
-
 /**
- * Helper for boost::geometry::index::rtree.
+ * Helper for #CloudGrid.
  */
-struct CloudClientIndexable {
-  typedef GeoPoint result_type;
-
+struct CloudClientLocation {
   gcc_pure
-  result_type operator()(const CloudClientPtr &client) const {
-    return client->location;
+  GeoPoint operator()(const CloudClient &client) const {
+    return client.location;
   }
 };
 
 class CloudClientContainer {
-  typedef boost::geometry::index::rtree<CloudClientPtr, boost::geometry::index::rstar<16>,
-                                        CloudClientIndexable> Tree;
+  typedef CloudGrid<CloudClient, CloudClientLocation> Grid;
 
   typedef boost::intrusive::list<CloudClient,
                                  boost::intrusive::constant_time_size<false>> List;
@@ -178,10 +171,11 @@ class CloudClientContainer {
                                 boost::intrusive::constant_time_size<false>> IdSet;
 
   /**
-   * A geospatial container of all clients, for fast geographic
-   * lookups.
+   * A geospatial index of all clients, for fast geographic lookups.
+   * It is updated on every fix, which is cheap because a client
+   * needs to be relinked only when it moves to another grid cell.
    */
-  Tree rtree;
+  Grid grid;
 
   /**
    * A linked list of clients, sorted by last fix, with fresh items at
@@ -249,18 +243,28 @@ public:
                const boost::asio::ip::udp::endpoint &endpoint,
                const GeoPoint &location, int altitude);
 
+  /**
+   * Add a new #CloudClient which was allocated with "new".  The
+   * container takes over ownership.
+   */
   void Insert(CloudClient &client);
 
   /**
-   * Remove a #CloudClient and its data.  Be careful - the given reference
-   * is invalidated, unless the caller holds another #CloudClientPtr.
+   * Remove a #CloudClient and its data.  Be careful - the given
+   * reference is invalidated.
    */
   void Remove(CloudClient &client);
 
+  /**
+   * Create or update a client with the state loaded from a journal
+   * record, keeping its public id.
+   */
+  void Restore(const CloudClient &src);
+
   void Expire(std::chrono::steady_clock::time_point before);
 
-  typedef Tree::const_query_iterator query_iterator;
-  typedef boost::iterator_range<query_iterator> query_iterator_range;
+  typedef Grid::const_iterator query_iterator;
+  typedef Grid::const_iterator_range query_iterator_range;
 
   gcc_pure
   query_iterator_range QueryWithinRange(GeoPoint location, double range) const;
@@ -57,6 +57,8 @@ CloudData::Save(Serialiser &s) const
   clients.Save(s);
   s.Write8(1);
   thermals.Save(s);
+  s.Write8(2);
+  s.Write64(journal_generation);
   s.Write8(0);
 }
 
@@ -71,8 +73,14 @@ CloudData::Load(Deserialiser &s)
 
   clients.Load(s);
 
-  if (s.Read8() != 0) {
+  uint8_t section = s.Read8();
+  if (section == 1) {
     thermals.Load(s);
-    s.Read8();
+    section = s.Read8();
+  }
+
+  if (section == 2) {
+    journal_generation = s.Read64();
+    section = s.Read8();
   }
 }
@@ -34,6 +34,12 @@ struct CloudData {
   CloudClientContainer clients;
   CloudThermalContainer thermals;
 
+  /**
+   * The generation of the #CloudJournal which applies on top of this
+   * data.  It is incremented each time a snapshot is saved.
+   */
+  uint64_t journal_generation = 0;
+
   void DumpClients();
 
   void Save(Serialiser &s) const;
@@ -0,0 +1,271 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_GRID_HPP
+#define XCSOAR_CLOUD_GRID_HPP
+
+#include "Geo/Boost/RangeBox.hpp"
+#include "Util/Clamp.hpp"
+#include "Compiler.h"
+
+#include <boost/intrusive/list.hpp>
+#include <boost/range/iterator_range_core.hpp>
+
+#include <iterator>
+#include <memory>
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Base class for objects managed by #CloudGrid.
+ */
+struct CloudGridItem
+  : boost::intrusive::list_base_hook<boost::intrusive::tag<CloudGridItem>,
+                                     boost::intrusive::link_mode<boost::intrusive::normal_link>> {
+  /**
+   * The grid cell this object is currently linked into.
+   */
+  uint32_t grid_cell;
+};
+
+/**
+ * A uniform latitude/longitude grid for fast geographic lookups of
+ * objects which move often.  Unlike with an R-tree, updating the
+ * location of an object is O(1): it needs to be relinked only when
+ * it crosses a cell boundary.
+ *
+ * The cells are hashed into a fixed number of buckets, and each
+ * bucket is an intrusive list.
+ *
+ * @param T the object type, derived from #CloudGridItem
+ * @param GetLocation a function object which returns the location
+ * of an object
+ */
+template<typename T, typename GetLocation>
+class CloudGrid {
+  typedef boost::intrusive::list<CloudGridItem,
+                                 boost::intrusive::base_hook<boost::intrusive::list_base_hook<boost::intrusive::tag<CloudGridItem>,
+                                                                                              boost::intrusive::link_mode<boost::intrusive::normal_link>>>,
+                                 boost::intrusive::constant_time_size<false>> List;
+
+  /**
+   * The number of cells per degree.  A cell is about 55 km high,
+   * which is roughly the range of a traffic query.
+   */
+  static constexpr unsigned CELLS_PER_DEGREE = 2;
+
+  static constexpr unsigned N_LATITUDE = 180 * CELLS_PER_DEGREE;
+  static constexpr unsigned N_LONGITUDE = 360 * CELLS_PER_DEGREE;
+
+  static constexpr size_t N_BUCKETS = 65521;
+
+  const std::unique_ptr<List[]> buckets;
+
+public:
+  CloudGrid():buckets(new List[N_BUCKETS]) {}
+
+  CloudGrid(const CloudGrid &) = delete;
+  CloudGrid &operator=(const CloudGrid &) = delete;
+
+  void Insert(T &item) {
+    item.grid_cell = ToCell(GetLocation()(item));
+    GetBucket(item.grid_cell).push_back(item);
+  }
+
+  void Remove(T &item) {
+    GetBucket(item.grid_cell).erase(List::s_iterator_to(item));
+  }
+
+  /**
+   * Update the index after the location of the given object has
+   * changed.
+   */
+  void Move(T &item) {
+    const uint32_t cell = ToCell(GetLocation()(item));
+    if (cell == item.grid_cell)
+      return;
+
+    Remove(item);
+    item.grid_cell = cell;
+    GetBucket(cell).push_back(item);
+  }
+
+  /**
+   * Iterates over all objects within a bounding box.
+   */
+  class const_iterator {
+    friend class CloudGrid;
+
+    const CloudGrid *grid;
+
+    boost::geometry::model::box<GeoPoint> box;
+
+    unsigned first_longitude, last_longitude, last_latitude;
+    unsigned latitude_index, longitude_index;
+
+    typename List::const_iterator i, end;
+
+    const_iterator(const CloudGrid &_grid,
+                   const boost::geometry::model::box<GeoPoint> &_box)
+      :grid(&_grid), box(_box),
+       first_longitude(LongitudeIndex(box.min_corner().longitude)),
+       last_longitude(LongitudeIndex(box.max_corner().longitude)),
+       last_latitude(LatitudeIndex(box.max_corner().latitude)),
+       latitude_index(LatitudeIndex(box.min_corner().latitude)),
+       longitude_index(first_longitude) {
+      LoadCell();
+      Settle();
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef const T *pointer;
+    typedef const T &reference;
+    typedef ptrdiff_t difference_type;
+
+    /**
+     * Construct the "end" iterator.
+     */
+    const_iterator()
+      :grid(nullptr), last_latitude(0), latitude_index(1) {}
+
+    bool IsEnd() const {
+      return latitude_index > last_latitude;
+    }
+
+    reference operator*() const {
+      return static_cast<reference>(*i);
+    }
+
+    pointer operator->() const {
+      return &**this;
+    }
+
+    const_iterator &operator++() {
+      ++i;
+      Settle();
+      return *this;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return IsEnd()
+        ? other.IsEnd()
+        : !other.IsEnd() && i == other.i;
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+
+  private:
+    uint32_t GetCell() const {
+      return latitude_index * N_LONGITUDE + longitude_index;
+    }
+
+    void LoadCell() {
+      const List &bucket = grid->GetBucket(GetCell());
+      i = bucket.begin();
+      end = bucket.end();
+    }
+
+    bool NextCell() {
+      if (++longitude_index > last_longitude) {
+        longitude_index = first_longitude;
+        if (++latitude_index > last_latitude)
+          return false;
+      }
+
+      LoadCell();
+      return true;
+    }
+
+    gcc_pure
+    bool IsMatch(const T &item) const {
+      if (item.grid_cell != GetCell())
+        /* a different cell which shares this bucket */
+        return false;
+
+      const GeoPoint location = GetLocation()(item);
+      return location.latitude >= box.min_corner().latitude &&
+        location.latitude <= box.max_corner().latitude &&
+        location.longitude >= box.min_corner().longitude &&
+        location.longitude <= box.max_corner().longitude;
+    }
+
+    /**
+     * Skip all objects which don't match, and move on to the next
+     * cell at the end of a bucket.
+     */
+    void Settle() {
+      do {
+        for (; i != end; ++i)
+          if (IsMatch(static_cast<const T &>(*i)))
+            return;
+      } while (NextCell());
+    }
+  };
+
+  typedef boost::iterator_range<const_iterator> const_iterator_range;
+
+  /**
+   * Query all objects within the bounding box of the given range.
+   */
+  gcc_pure
+  const_iterator_range QueryWithinRange(GeoPoint location,
+                                        double range) const {
+    return {const_iterator(*this, BoostRangeBox(location, range)),
+            const_iterator()};
+  }
+
+private:
+  gcc_const
+  static unsigned LatitudeIndex(Angle latitude) {
+    const int i = (int)floor((latitude.Degrees() + 90) * CELLS_PER_DEGREE);
+    return Clamp(i, 0, int(N_LATITUDE - 1));
+  }
+
+  gcc_const
+  static unsigned LongitudeIndex(Angle longitude) {
+    const int i = (int)floor((longitude.Degrees() + 180) * CELLS_PER_DEGREE);
+    return Clamp(i, 0, int(N_LONGITUDE - 1));
+  }
+
+  gcc_const
+  static uint32_t ToCell(GeoPoint location) {
+    return LatitudeIndex(location.latitude) * N_LONGITUDE
+      + LongitudeIndex(location.longitude);
+  }
+
+  List &GetBucket(uint32_t cell) {
+    return buckets[cell % N_BUCKETS];
+  }
+
+  const List &GetBucket(uint32_t cell) const {
+    return buckets[cell % N_BUCKETS];
+  }
+};
+
+#endif
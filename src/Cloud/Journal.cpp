@@ -0,0 +1,264 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Journal.hpp"
+#include "Data.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "IO/FileReader.hxx"
+#include "OS/FileUtil.hpp"
+
+#include <stdexcept>
+
+static constexpr uint32_t JOURNAL_MAGIC = 0x5753f610;
+static constexpr uint32_t JOURNAL_VERSION = 1;
+
+enum class JournalRecord : uint8_t {
+  /**
+   * The complete state of a #CloudClient, in the format of
+   * CloudClient::Save().
+   */
+  CLIENT = 1,
+
+  /**
+   * A new #CloudThermal, in the format of CloudThermal::Save().
+   */
+  THERMAL = 2,
+
+  /**
+   * A snapshot of the given generation (64 bit) was taken here; see
+   * CloudJournal::Cut().
+   */
+  CUT = 3,
+};
+
+CloudJournal::CloudJournal(AllocatedPath &&_path)
+  :path(std::move(_path)), serialiser(new Serialiser(memory)) {}
+
+CloudJournal::~CloudJournal()
+{
+  if (file)
+    file->Commit();
+}
+
+void
+CloudJournal::AppendClient(const CloudClient &client)
+{
+  const ScopeLock protect(buffer_mutex);
+  serialiser->Write8(uint8_t(JournalRecord::CLIENT));
+  client.Save(*serialiser);
+}
+
+void
+CloudJournal::AppendThermal(const CloudThermal &thermal)
+{
+  const ScopeLock protect(buffer_mutex);
+  serialiser->Write8(uint8_t(JournalRecord::THERMAL));
+  thermal.Save(*serialiser);
+}
+
+void
+CloudJournal::Flush()
+{
+  const ScopeLock protect(file_mutex);
+
+  std::vector<uint8_t> data;
+
+  {
+    const ScopeLock protect2(buffer_mutex);
+    serialiser->Flush();
+
+    if (cut) {
+      /* keep a copy of the records after the cut for Reset() */
+      carry.insert(carry.end(),
+                   memory.data.begin() + cut_offset, memory.data.end());
+      cut_offset = 0;
+    }
+
+    data.swap(memory.data);
+  }
+
+  if (data.empty())
+    return;
+
+  if (!file)
+    file.reset(new FileOutputStream(path,
+                                    FileOutputStream::Mode::APPEND_EXISTING));
+
+  /* one write() call, so a crash can only truncate the last
+     record */
+  file->Write(data.data(), data.size());
+  file_size += data.size();
+}
+
+uint64_t
+CloudJournal::GetSize()
+{
+  const ScopeLock protect(file_mutex);
+  return file_size;
+}
+
+void
+CloudJournal::Cut(uint64_t generation)
+{
+  const ScopeLock protect(buffer_mutex);
+  serialiser->Write8(uint8_t(JournalRecord::CUT));
+  serialiser->Write64(generation);
+  serialiser->Flush();
+
+  cut = true;
+  cut_offset = memory.data.size();
+  carry.clear();
+}
+
+void
+CloudJournal::Reset(uint64_t generation)
+{
+  const ScopeLock protect(file_mutex);
+
+  std::vector<uint8_t> carried;
+
+  {
+    const ScopeLock protect2(buffer_mutex);
+    serialiser->Flush();
+
+    if (cut) {
+      carried.swap(carry);
+      carried.insert(carried.end(),
+                     memory.data.begin() + cut_offset, memory.data.end());
+      cut = false;
+    }
+
+    memory.data.clear();
+
+    /* a new Serialiser discards its buffer and refreshes the clock
+       reference */
+    serialiser.reset(new Serialiser(memory));
+  }
+
+  if (file) {
+    file->Commit();
+    file.reset();
+  }
+
+  /* replace the old journal atomically */
+  FileOutputStream fos(path);
+
+  {
+    Serialiser s(fos);
+    s.Write32(JOURNAL_MAGIC);
+    s.Write32(JOURNAL_VERSION);
+    s.Write64(generation);
+    s.Flush();
+  }
+
+  if (!carried.empty())
+    fos.Write(carried.data(), carried.size());
+
+  const uint64_t size = fos.Tell();
+  fos.Commit();
+
+  file_size = size;
+}
+
+/**
+ * Has the end of the file been reached, i.e. there are no more
+ * records?
+ */
+static bool
+IsEnd(Deserialiser &s)
+{
+  return s.Read().IsEmpty() && !s.Fill(true);
+}
+
+unsigned
+CloudJournal::Replay(CloudData &data)
+{
+  const ScopeLock protect(file_mutex);
+
+  if (!File::Exists(path))
+    return 0;
+
+  FileReader fr(path);
+  Deserialiser s(fr);
+
+  if (s.Read32() != JOURNAL_MAGIC)
+    throw std::runtime_error("Bad journal magic");
+
+  if (s.Read32() != JOURNAL_VERSION)
+    throw std::runtime_error("Bad journal version");
+
+  const uint64_t generation = s.Read64();
+  if (generation > data.journal_generation)
+    /* doesn't belong to the loaded snapshot */
+    return 0;
+
+  /* if the journal belongs to an older snapshot, the new snapshot
+     was written, but the server crashed before the journal was
+     reset; the records before the snapshot's CUT are already in the
+     snapshot, but the ones after it are not */
+  bool skip = generation < data.journal_generation;
+
+  unsigned n = 0;
+
+  try {
+    while (!IsEnd(s)) {
+      switch (JournalRecord(s.Read8())) {
+      case JournalRecord::CLIENT:
+        {
+          const auto client = CloudClient::Load(s);
+          if (skip)
+            continue;
+
+          data.clients.Restore(client);
+        }
+        break;
+
+      case JournalRecord::THERMAL:
+        {
+          const auto thermal = CloudThermal::Load(s);
+          if (skip)
+            continue;
+
+          data.thermals.Insert(*new CloudThermal(thermal));
+        }
+        break;
+
+      case JournalRecord::CUT:
+        if (s.Read64() == data.journal_generation)
+          skip = false;
+        continue;
+
+      default:
+        throw std::runtime_error("Corrupt journal record");
+      }
+
+      ++n;
+    }
+  } catch (const std::runtime_error &) {
+    /* an incomplete or corrupt record at the end of the journal,
+       probably written during a crash; everything before it has been
+       applied */
+  }
+
+  return n;
+}
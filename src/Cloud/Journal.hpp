@@ -0,0 +1,164 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_JOURNAL_HPP
+#define XCSOAR_CLOUD_JOURNAL_HPP
+
+#include "Serialiser.hpp"
+#include "MemoryOutputStream.hpp"
+#include "Thread/Mutex.hpp"
+#include "OS/Path.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <stdint.h>
+
+struct CloudData;
+struct CloudClient;
+struct CloudThermal;
+class FileOutputStream;
+
+/**
+ * A write-ahead journal of changes to #CloudData.  Changes are
+ * appended to a memory buffer, which is written to the journal file
+ * by Flush().  The cost of this is proportional to the rate of
+ * changes, not to the size of the data set.
+ *
+ * Each journal file belongs to one "generation" of the snapshot
+ * written by CloudData::Save().  When a new snapshot is taken, a
+ * "cut" record with the new generation is appended; after the
+ * snapshot has been written, the journal is reset and starts the new
+ * generation.  If the server crashes between the two, recovery finds
+ * a journal of an older generation, and applies only the records
+ * after the snapshot's cut.
+ *
+ * This class is thread-safe.
+ */
+class CloudJournal {
+  const AllocatedPath path;
+
+  /**
+   * Protects #file and #file_size.  Flush() holds it while writing,
+   * which is why it is separate from #buffer_mutex.
+   */
+  Mutex file_mutex;
+
+  std::unique_ptr<FileOutputStream> file;
+
+  uint64_t file_size = 0;
+
+  /**
+   * Protects #memory, #serialiser and the cut attributes.
+   */
+  Mutex buffer_mutex;
+
+  MemoryOutputStream memory;
+
+  std::unique_ptr<Serialiser> serialiser;
+
+  /**
+   * Has Cut() been called, but not yet Reset()?
+   */
+  bool cut = false;
+
+  /**
+   * The position in #memory where the records appended after Cut()
+   * begin.
+   */
+  size_t cut_offset;
+
+  /**
+   * Records appended after Cut() which have already been removed from
+   * #memory by Flush().  They are carried over to the new journal by
+   * Reset().
+   */
+  std::vector<uint8_t> carry;
+
+public:
+  explicit CloudJournal(AllocatedPath &&_path);
+  ~CloudJournal();
+
+  /**
+   * Record the current state of the given client.
+   */
+  void AppendClient(const CloudClient &client);
+
+  /**
+   * Record a new thermal.
+   */
+  void AppendThermal(const CloudThermal &thermal);
+
+  /**
+   * Write all pending records to the journal file.  Reset() must
+   * have been called before.
+   *
+   * Throws std::runtime_error on error.
+   */
+  void Flush();
+
+  /**
+   * Returns the size of the journal file in bytes.
+   */
+  gcc_pure
+  uint64_t GetSize();
+
+  /**
+   * Mark the point at which a new snapshot of the given generation
+   * was taken.  Records appended after this call are not part of the
+   * snapshot; they are still written to the current journal file by
+   * Flush(), after a "cut" record, and Reset() carries them over to
+   * the new journal.
+   *
+   * This method does not do any file I/O, so it may be called while
+   * the data is locked.
+   */
+  void Cut(uint64_t generation);
+
+  /**
+   * Discard the journal and start a new one for the given snapshot
+   * generation.  Pending records appended before Cut() are discarded
+   * as well; the caller must ensure that they are part of the
+   * snapshot.  Records appended after Cut() are moved to the new
+   * journal.
+   *
+   * Throws std::runtime_error on error.
+   */
+  void Reset(uint64_t generation);
+
+  /**
+   * Apply the journal file to the given #CloudData.  Only records
+   * which are not in the snapshot loaded into it are applied: all of
+   * them if the journal belongs to the snapshot's generation, only
+   * the ones after the snapshot's cut if the journal is older, and
+   * none if it is newer.  Replay stops at the first incomplete
+   * record, which may be the result of a crash.
+   *
+   * Throws std::runtime_error on error.
+   *
+   * @return the number of records which were applied
+   */
+  unsigned Replay(CloudData &data);
+};
+
+#endif
@@ -22,15 +22,20 @@ Copyright_License {
 */
 
 #include "Data.hpp"
+#include "Journal.hpp"
 #include "Dump.hpp"
 #include "Sender.hpp"
 #include "Serialiser.hpp"
+#include "MemoryOutputStream.hpp"
 #include "Tracking/SkyLines/Server.hpp"
 #include "Tracking/SkyLines/Protocol.hpp"
 #include "OS/ByteOrder.hpp"
 #include "IO/FileOutputStream.hxx"
 #include "IO/FileReader.hxx"
 #include "Util/PrintException.hxx"
+#include "Util/NumberParser.hpp"
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
 #include "Compiler.h"
 
 #ifdef __linux__
@@ -40,6 +45,7 @@ Copyright_License {
 #include <boost/asio/steady_timer.hpp>
 
 #include <array>
+#include <forward_list>
 #include <iostream>
 #include <iomanip>
 
@@ -52,6 +58,21 @@ static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chro
 
 static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
 
+/**
+ * How often are pending journal records written to disk?
+ */
+static constexpr std::chrono::steady_clock::duration JOURNAL_FLUSH_INTERVAL = std::chrono::seconds(1);
+
+/**
+ * How often is the journal compacted into a new snapshot?
+ */
+static constexpr std::chrono::steady_clock::duration SAVE_INTERVAL = std::chrono::minutes(15);
+
+/**
+ * Compact the journal earlier if it grows beyond this size.
+ */
+static constexpr uint64_t MAX_JOURNAL_SIZE = 64 * 1024 * 1024;
+
 using std::cout;
 using std::cerr;
 using std::endl;
@@ -65,17 +86,38 @@ class CloudServer final
 {
   const AllocatedPath db_path;
 
-  boost::asio::steady_timer save_timer, expire_timer;
+  /**
+   * Protects #CloudData and the timers.  All I/O threads share one
+   * lock, because every request needs a geographic query over all
+   * clients; decoding and sending happen outside of it.
+   */
+  Mutex mutex;
+
+  /**
+   * Serialises calls to Save(), which writes the snapshot without
+   * holding #mutex.
+   */
+  Mutex save_mutex;
+
+  /**
+   * Records all changes between two snapshots.
+   */
+  CloudJournal journal;
+
+  boost::asio::steady_timer save_timer, journal_timer, expire_timer;
 
 public:
   CloudServer(AllocatedPath &&_db_path, boost::asio::io_service &io_service,
-              boost::asio::ip::udp::endpoint endpoint)
-    :SkyLinesTracking::Server(io_service, endpoint),
+              boost::asio::ip::udp::endpoint endpoint,
+              unsigned n_sockets)
+    :SkyLinesTracking::Server(io_service, endpoint, n_sockets),
 #ifdef __linux__
     SignalListener(io_service),
 #endif
     db_path(std::move(_db_path)),
+    journal(db_path + ".journal"),
     save_timer(io_service),
+    journal_timer(io_service),
     expire_timer(io_service)
   {
 #ifdef __linux__
@@ -83,31 +125,72 @@ public:
 #endif
 
     ScheduleSave();
+    ScheduleFlushJournal();
   }
 
   using SkyLinesTracking::Server::get_io_service;
 
+  /**
+   * Load the most recent snapshot.
+   */
   void Load();
+
+  /**
+   * Apply the journal on top of the loaded snapshot, and compact
+   * both into a new snapshot.
+   */
+  void Recover();
+
+  /**
+   * Write a new snapshot and start a new journal.
+   */
   void Save();
 
 private:
   void ScheduleSave() {
-    save_timer.expires_from_now(std::chrono::minutes(1));
+    save_timer.expires_from_now(SAVE_INTERVAL);
     save_timer.async_wait([this](const boost::system::error_code &ec){
         if (ec)
           return;
 
-        Save();
+        try {
+          Save();
+        } catch (const std::exception &e) {
+          cerr << "Failed to save data" << endl;
+          PrintException(e);
+        }
+
         ScheduleSave();
       });
   }
 
+  void ScheduleFlushJournal() {
+    journal_timer.expires_from_now(JOURNAL_FLUSH_INTERVAL);
+    journal_timer.async_wait([this](const boost::system::error_code &ec){
+        if (ec)
+          return;
+
+        try {
+          journal.Flush();
+
+          if (journal.GetSize() > MAX_JOURNAL_SIZE)
+            Save();
+        } catch (const std::exception &e) {
+          cerr << "Failed to write journal" << endl;
+          PrintException(e);
+        }
+
+        ScheduleFlushJournal();
+      });
+  }
+
   void ScheduleExpire() {
     expire_timer.expires_from_now(std::chrono::minutes(5));
     expire_timer.async_wait([this](const boost::system::error_code &ec){
         if (ec)
           return;
 
+        const ScopeLock protect(mutex);
         clients.Expire(expire_timer.expires_at() - std::chrono::minutes(10));
         if (!clients.empty())
           ScheduleExpire();
@@ -157,11 +240,19 @@ protected:
   void OnSignal(int signo) override {
     switch (signo) {
     case SIGHUP:
-      Save();
+      try {
+        Save();
+      } catch (const std::exception &e) {
+        cerr << "Failed to save data" << endl;
+        PrintException(e);
+      }
       break;
 
     case SIGUSR1:
-      DumpClients();
+      {
+        const ScopeLock protect(mutex);
+        DumpClients();
+      }
       break;
 
     default:
@@ -179,6 +270,9 @@ CloudServer::OnFix(const Client &c,
 {
   (void)time_of_day; // TODO: use this parameter
 
+  SendQueue queue(*this);
+  const ScopeLock protect(mutex);
+
   CloudClient *client;
   if (location.IsValid()) {
     bool was_empty = clients.empty();
@@ -201,20 +295,23 @@ CloudServer::OnFix(const Client &c,
       clients.Refresh(*client, c.endpoint);
   }
 
+  if (client != nullptr)
+    journal.AppendClient(*client);
+
   /* send this new traffic location to all interested clients
      immediately */
   const auto now = std::chrono::steady_clock::now();
   for (const auto &i : clients.QueryWithinRange(location, TRAFFIC_RANGE)) {
-    if (i->key == c.key)
+    if (i.key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
       continue;
 
-    if (now > i->wants_traffic)
+    if (now > i.wants_traffic)
       /* not interested (anymore) */
       continue;
 
-    TrafficResponseSender s(*this, {i->endpoint, i->key});
+    TrafficResponseSender s(queue, {i.endpoint, i.key});
     s.Add(client->id, 0, //TODO: time?
           client->location, client->altitude);
     s.Flush();
@@ -228,6 +325,9 @@ CloudServer::OnTrafficRequest(const Client &c, bool near)
     /* "near" is the only selection flag we know */
     return;
 
+  SendQueue queue(*this);
+  const ScopeLock protect(mutex);
+
   auto *client = clients.Find(c.key);
   if (client == nullptr)
     /* we don't send our data to clients who didn't sent anything to
@@ -237,23 +337,24 @@ CloudServer::OnTrafficRequest(const Client &c, bool near)
   const auto now = std::chrono::steady_clock::now();
 
   client->wants_traffic = now + REQUEST_EXPIRY;
+  journal.AppendClient(*client);
 
   const auto min_stamp = now - MAX_TRAFFIC_AGE;
 
-  TrafficResponseSender s(*this, c);
+  TrafficResponseSender s(queue, c);
 
   unsigned n = 0;
   for (const auto &traffic : clients.QueryWithinRange(client->location,
                                                       TRAFFIC_RANGE)) {
-    if (traffic.get() == client)
+    if (&traffic == client)
       continue;
 
-    if (traffic->stamp < min_stamp)
+    if (traffic.stamp < min_stamp)
       /* don't send stale traffic, it's probably not there anymore */
       continue;
 
-    s.Add(traffic->id, 0, //TODO: time?
-          traffic->location, traffic->altitude);
+    s.Add(traffic.id, 0, //TODO: time?
+          traffic.location, traffic.altitude);
 
     if (++n > 64)
       break;
@@ -270,6 +371,8 @@ CloudServer::OnWaveSubmit(const Client &c,
                           int top_altitude,
                           double lift)
 {
+  const ScopeLock protect(mutex);
+
   auto *client = clients.Find(c.key);
   if (client == nullptr)
     /* we don't trust the client if he didn't sent anything to us
@@ -296,6 +399,9 @@ CloudServer::OnThermalSubmit(const Client &c,
                              int top_altitude,
                              double lift)
 {
+  SendQueue queue(*this);
+  const ScopeLock protect(mutex);
+
   auto *client = clients.Find(c.key);
   if (client == nullptr)
     /* we don't trust the client if he didn't sent anything to us
@@ -316,21 +422,22 @@ CloudServer::OnThermalSubmit(const Client &c,
                   AGeoPoint(bottom_location, bottom_altitude),
                   AGeoPoint(top_location, top_altitude),
                   lift);
+  journal.AppendThermal(thermal);
 
   /* send this new thermal to all interested clients immediately */
   const auto now = std::chrono::steady_clock::now();
   for (const auto &i : clients.QueryWithinRange(bottom_location,
                                                 THERMAL_RANGE)) {
-    if (i->key == c.key)
+    if (i.key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
       continue;
 
-    if (now > i->wants_thermals)
+    if (now > i.wants_thermals)
       /* not interested (anymore) */
       continue;
 
-    ThermalResponseSender s(*this, {i->endpoint, i->key});
+    ThermalResponseSender s(queue, {i.endpoint, i.key});
     s.Add(thermal.Pack());
     s.Flush();
   }
@@ -339,6 +446,9 @@ CloudServer::OnThermalSubmit(const Client &c,
 void
 CloudServer::OnThermalRequest(const Client &c)
 {
+  SendQueue queue(*this);
+  const ScopeLock protect(mutex);
+
   auto *client = clients.Find(c.key);
   if (client == nullptr)
     /* we don't send our data to clients who didn't sent anything to
@@ -348,24 +458,25 @@ CloudServer::OnThermalRequest(const Client &c)
   const auto now = std::chrono::steady_clock::now();
 
   client->wants_thermals = now + REQUEST_EXPIRY;
+  journal.AppendClient(*client);
 
   const auto min_time = now - MAX_THERMAL_AGE;
 
-  ThermalResponseSender s(*this, c);
+  ThermalResponseSender s(queue, c);
 
   unsigned n = 0;
   for (const auto &thermal : thermals.QueryWithinRange(client->location,
                                                        THERMAL_RANGE)) {
-    if (thermal->client_key == c.key)
+    if (thermal.client_key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
       continue;
 
-    if (thermal->time < min_time)
+    if (thermal.time < min_time)
       /* don't send old thermals, they're useless */
       continue;
 
-    s.Add(thermal->Pack());
+    s.Add(thermal.Pack());
 
     if (++n > 256)
       break;
@@ -379,41 +490,113 @@ CloudServer::Load()
 {
   FileReader fr(db_path);
   Deserialiser s(fr);
+
+  const ScopeLock protect(mutex);
   CloudData::Load(s);
 }
 
+void
+CloudServer::Recover()
+{
+  {
+    const ScopeLock protect(mutex);
+
+    try {
+      const unsigned n = journal.Replay(*this);
+      cout << "Replayed " << n << " journal records" << endl;
+    } catch (const std::runtime_error &e) {
+      cerr << "Failed to replay journal" << endl;
+      PrintException(e);
+    }
+
+    if (!clients.empty())
+      ScheduleExpire();
+  }
+
+  Save();
+}
+
 void
 CloudServer::Save()
 {
   cout << "Saving data to " << db_path.c_str() << endl;
 
-  FileOutputStream fos(db_path);
+  const ScopeLock protect_save(save_mutex);
+
+  /* serialise into memory while the data is locked, but write the
+     file after releasing the lock, so the I/O threads are blocked
+     only for the copy */
+  MemoryOutputStream snapshot;
+  uint64_t generation;
 
   {
-    Serialiser s(fos);
+    const ScopeLock protect(mutex);
+
+    generation = ++journal_generation;
+
+    Serialiser s(snapshot);
     CloudData::Save(s);
     s.Flush();
+
+    /* changes made from now on are not in the snapshot */
+    journal.Cut(generation);
   }
 
+  FileOutputStream fos(db_path);
+  fos.Write(snapshot.data.data(), snapshot.data.size());
   fos.Commit();
+
+  /* the snapshot contains everything up to the cut, so the old
+     journal is obsolete; if we crash before this, Replay() finds the
+     records after the cut in the old journal */
+  journal.Reset(generation);
 }
 
+/**
+ * An additional thread which runs the io_service.
+ */
+class IOThread final : public Thread {
+  boost::asio::io_service &io_service;
+
+public:
+  explicit IOThread(boost::asio::io_service &_io_service)
+    :Thread("io"), io_service(_io_service) {}
+
+protected:
+  /* virtual methods from Thread */
+  void Run() override {
+    io_service.run();
+  }
+};
+
 int
 main(int argc, char **argv)
 try {
-  if (argc != 2) {
-    cerr << "Usage: " << argv[0] << " DBPATH" << endl;
+  if (argc < 2 || argc > 3) {
+    cerr << "Usage: " << argv[0] << " DBPATH [THREADS]" << endl;
     return EXIT_FAILURE;
   }
 
   const Path db_path(argv[1]);
 
+  unsigned n_threads = 1;
+  if (argc > 2) {
+    char *endptr;
+    n_threads = ParseUnsigned(argv[2], &endptr);
+    if (endptr == argv[2] || *endptr != 0 || n_threads == 0) {
+      cerr << "Invalid number of threads" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   boost::asio::io_service io_service;
 
   const boost::asio::ip::udp::endpoint endpoint(boost::asio::ip::udp::v4(),
                                                 CloudServer::GetDefaultPort());
 
-  CloudServer server(db_path, io_service, endpoint);
+  /* one receive socket per thread; the kernel distributes incoming
+     datagrams among them */
+  CloudServer server(db_path, io_service, endpoint, n_threads);
 
   try {
     server.Load();
@@ -422,8 +605,24 @@ try {
     PrintException(e);
   }
 
+  server.Recover();
+
+  std::forward_list<IOThread> threads;
+  for (unsigned i = 1; i < n_threads; ++i) {
+    threads.emplace_front(io_service);
+    if (!threads.front().Start()) {
+      threads.pop_front();
+      cerr << "Failed to start I/O thread; running with "
+           << i << " thread(s)" << endl;
+      break;
+    }
+  }
+
   io_service.run();
 
+  for (auto &thread : threads)
+    thread.Join();
+
   server.Save();
 
   return EXIT_SUCCESS;
@@ -33,8 +33,8 @@ Copyright_License {
 struct GeoPoint;
 
 class TrafficResponseSender {
-  SkyLinesTracking::Server &server;
-  const boost::asio::ip::udp::endpoint &endpoint;
+  SkyLinesTracking::Server::SendQueue &queue;
+  const boost::asio::ip::udp::endpoint endpoint;
 
   static constexpr size_t MAX_TRAFFIC_SIZE = 1024;
   static constexpr size_t MAX_TRAFFIC =
@@ -48,9 +48,9 @@ class TrafficResponseSender {
   unsigned n_traffic = 0;
 
 public:
-  TrafficResponseSender(SkyLinesTracking::Server &_server,
+  TrafficResponseSender(SkyLinesTracking::Server::SendQueue &_queue,
                         const SkyLinesTracking::Server::Client &client)
-    :server(_server), endpoint(client.endpoint) {
+    :queue(_queue), endpoint(client.endpoint) {
     data.header.header.magic = ToBE32(SkyLinesTracking::MAGIC);
     data.header.header.type = ToBE16(SkyLinesTracking::Type::TRAFFIC_RESPONSE);
     data.header.header.key = ToBE64(client.key);
@@ -66,8 +66,8 @@ public:
 };
 
 class ThermalResponseSender {
-  SkyLinesTracking::Server &server;
-  const boost::asio::ip::udp::endpoint &endpoint;
+  SkyLinesTracking::Server::SendQueue &queue;
+  const boost::asio::ip::udp::endpoint endpoint;
 
   static constexpr size_t MAX_THERMAL_SIZE = 1024;
   static constexpr size_t MAX_THERMAL =
@@ -81,9 +81,9 @@ class ThermalResponseSender {
   unsigned n_thermal = 0;
 
 public:
-  ThermalResponseSender(SkyLinesTracking::Server &_server,
+  ThermalResponseSender(SkyLinesTracking::Server::SendQueue &_queue,
                         const SkyLinesTracking::Server::Client &client)
-    :server(_server), endpoint(client.endpoint) {
+    :queue(_queue), endpoint(client.endpoint) {
     data.header.header.magic = ToBE32(SkyLinesTracking::MAGIC);
     data.header.header.type = ToBE16(SkyLinesTracking::Type::THERMAL_RESPONSE);
     data.header.header.key = ToBE64(client.key);
@@ -23,7 +23,6 @@ Copyright_License {
 
 #include "Thermal.hpp"
 #include "Serialiser.hpp"
-#include "Geo/Boost/RangeBox.hpp"
 #include "Tracking/SkyLines/Protocol.hpp"
 #include "Tracking/SkyLines/Assemble.hpp"
 #include "Tracking/SkyLines/Import.hpp"
@@ -50,8 +49,8 @@ CloudThermalContainer::Make(uint64_t client_key,
                             const AGeoPoint &top_location,
                             double lift)
 {
-  auto thermal = std::make_shared<CloudThermal>(client_key, bottom_location,
-                                                top_location, lift);
+  auto *thermal = new CloudThermal(client_key, bottom_location,
+                                   top_location, lift);
   Insert(*thermal);
   return *thermal;
 }
@@ -60,14 +59,15 @@ void
 CloudThermalContainer::Insert(CloudThermal &thermal)
 {
   list.push_front(thermal);
-  rtree.insert(thermal.shared_from_this());
+  grid.Insert(thermal);
 }
 
 void
 CloudThermalContainer::Remove(CloudThermal &thermal)
 {
   list.erase(list.iterator_to(thermal));
-  rtree.remove(thermal.shared_from_this());
+  grid.Remove(thermal);
+  delete &thermal;
 }
 
 void
@@ -80,8 +80,7 @@ CloudThermalContainer::Expire(std::chrono::steady_clock::time_point before)
 CloudThermalContainer::query_iterator_range
 CloudThermalContainer::QueryWithinRange(GeoPoint location, double range) const
 {
-  const auto q = boost::geometry::index::intersects(BoostRangeBox(location, range));
-  return {rtree.qbegin(q), rtree.qend()};
+  return grid.QueryWithinRange(location, range);
 }
 
 SkyLinesTracking::Thermal
@@ -108,7 +107,7 @@ CloudThermal
 CloudThermal::Load(Deserialiser &s)
 {
   s.Read8();
-  const unsigned client_key = s.Read64();
+  const uint64_t client_key = s.Read64();
 
   std::chrono::steady_clock::time_point time;
   s >> time;
@@ -146,7 +145,7 @@ CloudThermalContainer::Load(Deserialiser &s)
   s.Read8();
 
   while (s.Read8() != 0) {
-    auto thermal = std::make_shared<CloudThermal>(CloudThermal::Load(s));
+    auto *thermal = new CloudThermal(CloudThermal::Load(s));
     Insert(*thermal);
   }
 
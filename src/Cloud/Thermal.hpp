@@ -24,14 +24,11 @@ Copyright_License {
 #ifndef XCSOAR_CLOUD_THERMAL_HPP
 #define XCSOAR_CLOUD_THERMAL_HPP
 
-#include "Geo/Boost/GeoPoint.hpp"
+#include "Grid.hpp"
+#include "Geo/GeoPoint.hpp"
 
 #include <boost/intrusive/list.hpp>
-#include <boost/geometry/index/rtree.hpp>
-#include <boost/range/iterator_range_core.hpp>
-#include <boost/asio/ip/udp.hpp>
 
-#include <memory>
 #include <chrono>
 
 class Serialiser;
@@ -42,7 +39,7 @@ namespace SkyLinesTracking { struct Thermal; }
  * A client which has submitted data to us recently.
  */
 struct CloudThermal
-  : std::enable_shared_from_this<CloudThermal>,
+  : CloudGridItem,
     boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>
 {
   const uint64_t client_key;
@@ -73,32 +70,26 @@ struct CloudThermal
   static CloudThermal Load(Deserialiser &s);
 };
 
-using CloudThermalPtr = std::shared_ptr<CloudThermal>;
-
 /**
- * Helper for boost::geometry::index::rtree.
+ * Helper for #CloudGrid.
  */
-struct CloudThermalIndexable {
-  typedef GeoPoint result_type;
-
+struct CloudThermalLocation {
   gcc_pure
-  result_type operator()(const CloudThermalPtr &client) const {
-    return client->top_location;
+  GeoPoint operator()(const CloudThermal &thermal) const {
+    return thermal.top_location;
   }
 };
 
 class CloudThermalContainer {
-  typedef boost::geometry::index::rtree<CloudThermalPtr, boost::geometry::index::rstar<16>,
-                                        CloudThermalIndexable> Tree;
+  typedef CloudGrid<CloudThermal, CloudThermalLocation> Grid;
 
   typedef boost::intrusive::list<CloudThermal,
                                  boost::intrusive::constant_time_size<false>> List;
 
   /**
-   * A geospatial container of all thermals, for fast geographic
-   * lookups.
+   * A geospatial index of all thermals, for fast geographic lookups.
    */
-  Tree rtree;
+  Grid grid;
 
   /**
    * A linked list of thermals, sorted by time, with newer items at
@@ -136,18 +127,22 @@ public:
                      const AGeoPoint &top_location,
                      double lift);
 
+  /**
+   * Add a new #CloudThermal which was allocated with "new".  The
+   * container takes over ownership.
+   */
   void Insert(CloudThermal &client);
 
   /**
-   * Remove a #CloudThermal and its data.  Be careful - the given reference
-   * is invalidated, unless the caller holds another #CloudThermalPtr.
+   * Remove a #CloudThermal and its data.  Be careful - the given
+   * reference is invalidated.
    */
   void Remove(CloudThermal &client);
 
   void Expire(std::chrono::steady_clock::time_point before);
 
-  typedef Tree::const_query_iterator query_iterator;
-  typedef boost::iterator_range<query_iterator> query_iterator_range;
+  typedef Grid::const_iterator query_iterator;
+  typedef Grid::const_iterator_range query_iterator_range;
 
   gcc_pure
   query_iterator_range QueryWithinRange(GeoPoint location, double range) const;
@@ -0,0 +1,44 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#ifndef XCSOAR_CALCULATION_WORKERS_HPP
+#define XCSOAR_CALCULATION_WORKERS_HPP
+
+#include "Thread/Parallel.hpp"
+
+#include <algorithm>
+
+/**
+ * The number of threads which a solver called by the calculation
+ * thread may use.  The calculation thread has other duties, so a
+ * solver may use at most one extra core; on single-core devices, this
+ * keeps the serial code path.
+ */
+gcc_pure
+static inline unsigned
+GetCalculationWorkers()
+{
+  return std::min(GetProcessorCount(), 2u);
+}
+
+#endif
@@ -28,14 +28,15 @@ Copyright_License {
 #include "NMEA/Derived.hpp"
 #include "NMEA/Aircraft.hpp"
 #include "Navigation/Aircraft.hpp"
-
-#include <algorithm>
+#include "CalculationWorkers.hpp"
 
 RouteComputer::RouteComputer(const Airspaces &airspace_database,
                              const ProtectedAirspaceWarningManager *warnings)
   :protected_route_planner(route_planner, airspace_database, warnings),
    terrain(NULL)
-{}
+{
+  route_planner.SetParallel(ParallelRun, GetCalculationWorkers());
+}
 
 void
 RouteComputer::ResetFlight()
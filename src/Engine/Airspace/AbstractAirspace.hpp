@@ -239,6 +239,10 @@ public:
     days_of_operation = mask;
   }
 
+  AirspaceActivity GetDays() const {
+    return days_of_operation;
+  }
+
   /**
    * Get type of airspace
    *
@@ -51,6 +51,8 @@ AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
   } else {
     is_convex = TriState::UNKNOWN;
   }
+
+  packed_border.Import(m_border);
 }
 
 const GeoPoint
@@ -82,7 +84,7 @@ AirspacePolygon::GetCenter() const
 bool
 AirspacePolygon::Inside(const GeoPoint &loc) const
 {
-  return m_border.IsInside(loc);
+  return packed_border.IsInside(loc);
 }
 
 AirspaceIntersectionVector
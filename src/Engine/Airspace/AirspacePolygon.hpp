@@ -24,6 +24,8 @@
 #define AIRSPACEPOLYGON_HPP
 
 #include "AbstractAirspace.hpp"
+#include "Geo/PackedPolygon.hpp"
+
 #include <vector>
 
 #ifdef DO_PRINT
@@ -32,6 +34,11 @@
 
 /** General polygon form airspace */
 class AirspacePolygon final : public AbstractAirspace {
+  /**
+   * A copy of #m_border for the point-in-polygon test in Inside().
+   */
+  PackedPolygon packed_border;
+
 public:
   /**
    * Constructor.  For testing, pts vector is a cloud of points,
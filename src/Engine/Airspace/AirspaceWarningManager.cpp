@@ -27,12 +27,37 @@
 #include "AirspaceIntersectionVisitor.hpp"
 #include "AirspaceAircraftPerformance.hpp"
 #include "Task/Stats/TaskStats.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Util/Clamp.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include <math.h>
 
 #define CRUISE_FILTER_FACT 0.5
 
+/**
+ * The minimum distance [m] the aircraft may move before
+ * AirspaceWarningManager::candidates needs to be refilled.
+ */
+static constexpr double CANDIDATE_MARGIN = 5000;
+
+/**
+ * This many projected units are subtracted from
+ * AirspaceWarningManager::Candidate::clear_distance.  The distance is
+ * measured from the unrounded location to the integer border vertices
+ * which AirspacePolygon::Intersects() uses, too; but Intersects()
+ * rounds the vector's end points, and AbstractAirspace::Inside() uses
+ * the unrounded vertices, each of which moves the border by up to
+ * 1/sqrt(2) units.
+ */
+static constexpr double CLEAR_ROUNDING = 2;
+
 AirspaceWarningManager::AirspaceWarningManager(const AirspaceWarningConfig &_config,
                                                const Airspaces &_airspaces)
-  :airspaces(_airspaces), serial(0)
+  :airspaces(_airspaces), serial(0), candidates_valid(false),
+   clearance_cache_enabled(true)
 {
   /* force filter initialisation in the first SetConfig() call */
   config.warning_time = -1;
@@ -65,6 +90,8 @@ AirspaceWarningManager::Reset(const AircraftState &state)
 {
   ++serial;
   warnings.clear();
+  candidates.clear();
+  candidates_valid = false;
   cruise_filter.Reset(state);
   circling_filter.Reset(state);
 }
@@ -116,6 +143,122 @@ AirspaceWarningManager::GetNewWarningPtr(const AbstractAirspace &airspace)
   return &warnings.back();
 }
 
+void
+AirspaceWarningManager::SetClearanceCache(bool enabled)
+{
+  clearance_cache_enabled = enabled;
+
+  for (auto &c : candidates)
+    c.clear_distance = 0;
+}
+
+static constexpr FlatPoint
+ToFlatPoint(const FlatGeoPoint &p)
+{
+  return FlatPoint(p.x, p.y);
+}
+
+/**
+ * Returns the squared distance of #p from the segment #a-#b.
+ */
+gcc_const
+static double
+SegmentDistanceSquared(FlatPoint a, FlatPoint b, FlatPoint p)
+{
+  const FlatPoint ab = b - a, ap = p - a;
+  const double length_squared = ab.DotProduct(ab);
+  const double t = length_squared > 0
+    ? Clamp(ap.DotProduct(ab) / length_squared, 0., 1.)
+    : 0.;
+
+  const FlatPoint delta = ap - ab * t;
+  return delta.DotProduct(delta);
+}
+
+void
+AirspaceWarningManager::Candidate::UpdateClearance(const FlatPoint &location)
+{
+  const AbstractAirspace &as = airspace.GetAirspace();
+
+  clear_location = location;
+
+  if (as.GetShape() != AbstractAirspace::Shape::POLYGON) {
+    clear_distance = 0;
+    return;
+  }
+
+  const SearchPointVector &border = as.GetPoints();
+  double min_squared = std::numeric_limits<double>::max();
+  FlatPoint previous = ToFlatPoint(border.back().GetFlatLocation());
+  for (const auto &i : border) {
+    const FlatPoint current = ToFlatPoint(i.GetFlatLocation());
+    min_squared = std::min(min_squared,
+                           SegmentDistanceSquared(previous, current,
+                                                  location));
+    previous = current;
+  }
+
+  clear_distance = std::max(sqrt(min_squared) - CLEAR_ROUNDING, 0.);
+}
+
+inline void
+AirspaceWarningManager::UpdateCandidatesInside(const GeoPoint &location)
+{
+  const FlatProjection &projection = GetProjection();
+  const auto flat_location = projection.ProjectInteger(location);
+  const auto float_location = projection.ProjectFloat(location);
+
+  for (auto &c : candidates) {
+    if (c.IsClear(float_location))
+      /* no boundary nearby, still on the same side */
+      continue;
+
+    const FlatBoundingBox &box = c.airspace;
+    if (box.IsInside(flat_location)) {
+      c.inside = c.airspace.IsInside(location);
+      if (clearance_cache_enabled)
+        c.UpdateClearance(float_location);
+    } else {
+      /* the old #clear_location may have been on the other side */
+      c.inside = false;
+      c.clear_distance = 0;
+    }
+  }
+}
+
+bool
+AirspaceWarningManager::UpdateCandidates(const GeoPoint &location,
+                                         const GeoPoint &end)
+{
+  const FlatProjection &projection = GetProjection();
+
+  FlatBoundingBox needed(projection.ProjectInteger(location));
+  needed.Expand(projection.ProjectInteger(end));
+  update_box.Merge(needed);
+
+  if (candidates_valid && candidate_serial == airspaces.GetSerial() &&
+      candidate_box.IsInside(needed.GetLowerLeft()) &&
+      candidate_box.IsInside(needed.GetUpperRight()))
+    /* cache is clean */
+    return false;
+
+  /* cover all vectors of this fix (so the checks don't evict each
+     other's candidates) plus a margin, so the list can be reused
+     while the aircraft moves */
+  candidate_box = update_box;
+  candidate_box.Grow(projection.ProjectRangeInteger(location,
+                                                    CANDIDATE_MARGIN));
+  candidate_serial = airspaces.GetSerial();
+  candidates_valid = true;
+
+  candidates.clear();
+  for (const auto &i : airspaces.QueryIntersecting(candidate_box))
+    candidates.emplace_back(i);
+
+  UpdateCandidatesInside(location);
+  return true;
+}
+
 bool 
 AirspaceWarningManager::Update(const AircraftState& state,
                                const GlidePolar &glide_polar,
@@ -136,6 +279,13 @@ AirspaceWarningManager::Update(const AircraftState& state,
   for (auto &w : warnings)
     w.SaveState();
 
+  update_box = FlatBoundingBox(GetProjection().ProjectInteger(state.location));
+
+  /* the point-in-polygon tests are done only once per fix for all
+     checks below */
+  if (!UpdateCandidates(state.location, state.location))
+    UpdateCandidatesInside(state.location);
+
   // check from strongest to weakest alerts
   UpdateInside(state, glide_polar);
   UpdateGlide(state, glide_polar);
@@ -299,15 +449,48 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
                                              warning_state, max_time_limit,
                                              ceiling);
 
-  airspaces.VisitIntersecting(state.location, location_predicted, visitor);
+  UpdateCandidates(state.location, location_predicted);
 
-  visitor.SetMode(true);
+  const FlatProjection &projection = GetProjection();
+  const auto flat_location = projection.ProjectInteger(state.location);
+  const auto flat_predicted = projection.ProjectInteger(location_predicted);
+  FlatBoundingBox vector_box(flat_location);
+  vector_box.Expand(flat_predicted);
+  const auto float_location = projection.ProjectFloat(state.location);
+  const auto float_predicted = projection.ProjectFloat(location_predicted);
+
+  for (auto &c : candidates) {
+    const AbstractAirspace &airspace = c.airspace.GetAirspace();
+
+    /* check the cheap conditions of
+       AirspaceIntersectionWarningVisitor::Intersection() before
+       calculating the intersections */
+    if (!airspace.IsActive() || !config.IsClassEnabled(airspace.GetType()) ||
+        !c.airspace.Overlaps(vector_box))
+      continue;
+
+    if (clearance_cache_enabled && !c.IsClear(float_location) &&
+        !(c.clear_location == float_location))
+      /* not yet calculated by UpdateCandidatesInside() for this
+         location, because it's outside the bounding box */
+      c.UpdateClearance(float_location);
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const AbstractAirspace &airspace = i.GetAirspace();
-    visitor.Visit(airspace);
+    if (c.IsClear(float_location) && c.IsClear(float_predicted))
+      /* the vector cannot cross the boundary */
+      continue;
+
+    if (visitor.SetIntersections(c.airspace.Intersects(state.location,
+                                                       location_predicted,
+                                                       projection)))
+      visitor.Visit(airspace);
   }
 
+  visitor.SetMode(true);
+
+  for (const auto &c : candidates)
+    if (c.inside)
+      visitor.Visit(c.airspace.GetAirspace());
+
   return visitor.Found();
 }
 
@@ -394,8 +577,11 @@ AirspaceWarningManager::UpdateInside(const AircraftState& state,
 
   bool found = false;
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const AbstractAirspace &airspace = i.GetAirspace();
+  for (const auto &c : candidates) {
+    if (!c.inside)
+      continue;
+
+    const AbstractAirspace &airspace = c.airspace.GetAirspace();
 
     const AltitudeState &altitude = state;
     if (// ignore inactive airspaces
@@ -24,10 +24,15 @@
 
 #include "AirspaceWarning.hpp"
 #include "AirspaceWarningConfig.hpp"
+#include "Airspace.hpp"
 #include "Util/AircraftStateFilter.hpp"
+#include "Util/Serial.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Geo/Flat/FlatPoint.hpp"
 #include "Compiler.h"
 
 #include <list>
+#include <vector>
 
 class TaskStats;
 class GlidePolar;
@@ -66,6 +71,79 @@ class AirspaceWarningManager {
    */
   unsigned serial;
 
+  struct Candidate {
+    Airspace airspace;
+
+    /**
+     * Is the aircraft (laterally) inside this airspace?  Updated by
+     * each Update() call.
+     */
+    bool inside;
+
+    /**
+     * The location where #clear_distance was calculated.
+     */
+    FlatPoint clear_location;
+
+    /**
+     * No part of the boundary is within this distance of
+     * #clear_location.  While the aircraft and its predicted
+     * positions stay within it, #inside cannot change and
+     * Intersects() cannot find anything, so large polygons do not
+     * need to be scanned on every fix.  Zero if unknown, and always
+     * zero for circles, which are cheap to test anyway.
+     */
+    double clear_distance;
+
+    Candidate(const Airspace &_airspace)
+      :airspace(_airspace), clear_location(0, 0), clear_distance(0) {}
+
+    gcc_pure
+    bool IsClear(const FlatPoint &p) const {
+      const FlatPoint delta = p - clear_location;
+      return delta.DotProduct(delta) < clear_distance * clear_distance;
+    }
+
+    /**
+     * Recalculate #clear_distance for the given location.
+     */
+    void UpdateClearance(const FlatPoint &location);
+  };
+
+  /**
+   * All airspaces which overlap #candidate_box.  This is a cache
+   * which is reused by all checks of all Update() calls, as long as
+   * the aircraft and its predicted positions stay within
+   * #candidate_box, instead of querying the #Airspaces tree several
+   * times per fix.
+   */
+  std::vector<Candidate> candidates;
+
+  /**
+   * The area covered by #candidates.  Only valid if
+   * #candidates_valid is set.
+   */
+  FlatBoundingBox candidate_box;
+
+  /**
+   * The Airspaces::GetSerial() value #candidates was obtained from.
+   */
+  Serial candidate_serial;
+
+  bool candidates_valid;
+
+  /**
+   * The union of all vectors checked by the current Update() call.
+   * When #candidates gets refilled, it covers this box plus
+   * a margin.
+   */
+  FlatBoundingBox update_box;
+
+  /**
+   * Use Candidate::clear_distance to skip tests?
+   */
+  bool clearance_cache_enabled;
+
 public:
   typedef AirspaceWarningList::const_iterator const_iterator;
 
@@ -135,6 +213,13 @@ public:
    */
   void SetPredictionTimeFilter(double time);
 
+  /**
+   * Enable or disable skipping tests of airspaces whose boundary is
+   * far away (see Candidate::clear_distance).  The warnings do not
+   * depend on this setting, only the speed.
+   */
+  void SetClearanceCache(bool enabled);
+
   /**
    * Find corresponding airspace warning item in store for an airspace
    *
@@ -261,6 +346,17 @@ public:
   bool IsActive(const AbstractAirspace &airspace) const;
 
 private:
+  /**
+   * Make sure that #candidates covers the given vector.
+   *
+   * @param location the current aircraft location; used to update
+   * Candidate::inside if the list gets refilled
+   * @return true if the list was refilled
+   */
+  bool UpdateCandidates(const GeoPoint &location, const GeoPoint &end);
+
+  void UpdateCandidatesInside(const GeoPoint &location);
+
   bool UpdateTask(const AircraftState &state, const GlidePolar &glide_polar,
                   const TaskStats &task_stats);
   bool UpdateFilter(const AircraftState& state, const bool circling);
@@ -28,6 +28,8 @@
 
 #include <boost/geometry/geometries/linestring.hpp>
 
+#include <vector>
+
 namespace bgi = boost::geometry::index;
 
 Airspaces::const_iterator_range
@@ -41,6 +43,16 @@ Airspaces::QueryWithinRange(const GeoPoint &location, double range) const
   return {airspace_tree.qbegin(bgi::intersects(box)), airspace_tree.qend()};
 }
 
+Airspaces::const_iterator_range
+Airspaces::QueryIntersecting(const FlatBoundingBox &box) const
+{
+  if (IsEmpty())
+    // nothing to do
+    return {airspace_tree.qend(), airspace_tree.qend()};
+
+  return {airspace_tree.qbegin(bgi::intersects(box)), airspace_tree.qend()};
+}
+
 Airspaces::const_iterator_range
 Airspaces::QueryIntersecting(const GeoPoint &a, const GeoPoint &b) const
 {
@@ -100,9 +112,20 @@ Airspaces::Optimise()
     airspace_tree.clear();
   }
 
-  for (AbstractAirspace *i : tmp_as) {
-    Airspace as(*i, task_projection);
-    airspace_tree.insert(as);
+  if (airspace_tree.empty()) {
+    /* bulk-load with the packing algorithm, which is much faster
+       than inserting one by one and results in a better tree */
+    std::vector<Airspace> v;
+    v.reserve(tmp_as.size());
+    for (AbstractAirspace *i : tmp_as)
+      v.emplace_back(*i, task_projection);
+
+    airspace_tree = AirspaceTree(v.begin(), v.end());
+  } else {
+    for (AbstractAirspace *i : tmp_as) {
+      Airspace as(*i, task_projection);
+      airspace_tree.insert(as);
+    }
   }
 
   tmp_as.clear();
@@ -157,6 +180,8 @@ Airspaces::Clear()
 
   // then delete the tree
   airspace_tree.clear();
+
+  ++serial;
 }
 
 unsigned
@@ -93,6 +93,14 @@ public:
    */
   void Add(AbstractAirspace *asp);
 
+  /**
+   * Returns the airspaces which were added since the last
+   * Optimise() call.
+   */
+  const std::deque<AbstractAirspace *> &GetPending() const {
+    return tmp_as;
+  }
+
   /**
    * Re-organise the internal airspace tree after inserting/deleting.
    * Should be called after inserting/deleting airspaces prior to performing
@@ -162,6 +170,14 @@ public:
   const_iterator_range QueryWithinRange(const GeoPoint &location,
                                         double range) const;
 
+  /**
+   * Query airspaces whose bounding box overlaps the given box (in
+   * the projection returned by GetProjection()).  The result is in no
+   * specific order.
+   */
+  gcc_pure
+  const_iterator_range QueryIntersecting(const FlatBoundingBox &box) const;
+
   /**
    * Query airspaces intersecting the vector (bounding box check
    * only).  The result is in no specific order.
@@ -59,6 +59,15 @@ ContestManager::SetIncremental(bool incremental)
   net_coupe.SetIncremental(incremental);
 }
 
+void
+ContestManager::SetParallel(const ParallelRunFunction &parallel_run,
+                            unsigned n_workers)
+{
+  olc_fai.SetParallel(parallel_run, n_workers);
+  xcontest_triangle.SetParallel(parallel_run, n_workers);
+  dhv_xc_triangle.SetParallel(parallel_run, n_workers);
+}
+
 void
 ContestManager::SetPredicted(const TracePoint &predicted)
 {
@@ -219,6 +228,38 @@ ContestManager::Reset()
   net_coupe.Reset();
 }
 
+unsigned long
+ContestManager::GetIterations() const
+{
+  return olc_sprint.GetIterations() +
+    olc_fai.GetIterations() +
+    olc_classic.GetIterations() +
+    olc_league.GetIterations() +
+    olc_plus.GetIterations() +
+    dmst_quad.GetIterations() +
+    xcontest_free.GetIterations() +
+    xcontest_triangle.GetIterations() +
+    dhv_xc_free.GetIterations() +
+    dhv_xc_triangle.GetIterations() +
+    sis_at.GetIterations() +
+    net_coupe.GetIterations();
+}
+
+size_t
+ContestManager::GetPeakTraceMemory() const
+{
+  return olc_sprint.GetPeakMemory() +
+    olc_fai.GetPeakMemory() +
+    olc_classic.GetPeakMemory() +
+    dmst_quad.GetPeakMemory() +
+    xcontest_free.GetPeakMemory() +
+    xcontest_triangle.GetPeakMemory() +
+    dhv_xc_free.GetPeakMemory() +
+    dhv_xc_triangle.GetPeakMemory() +
+    sis_at.GetPeakMemory() +
+    net_coupe.GetPeakMemory();
+}
+
 /*
 
 - SearchPointVector find self intersections (for OLC-FAI)
@@ -85,6 +85,15 @@ public:
 
   void SetIncremental(bool incremental);
 
+  /**
+   * Let the triangle solvers distribute their work over several
+   * threads.
+   *
+   * @see OLCTriangle::SetParallel()
+   */
+  void SetParallel(const ParallelRunFunction &parallel_run,
+                   unsigned n_workers);
+
   /**
    * @see ContestDijkstra::SetPredicted()
    */
@@ -130,6 +139,20 @@ public:
   const ContestStatistics &GetStats() const {
     return stats;
   }
+
+  /**
+   * Returns the total number of search iterations of all solvers.
+   * This is only used for benchmarking.
+   */
+  gcc_pure
+  unsigned long GetIterations() const;
+
+  /**
+   * Returns the sum of the peak memory usage (in bytes) of all
+   * solvers' working traces.  This is only used for benchmarking.
+   */
+  gcc_pure
+  size_t GetPeakTraceMemory() const;
 };
 
 #endif
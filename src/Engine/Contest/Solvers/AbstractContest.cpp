@@ -25,7 +25,8 @@ Copyright_License {
 
 AbstractContest::AbstractContest(const unsigned _finish_alt_diff)
   :handicap(100),
-   finish_alt_diff(_finish_alt_diff)
+   finish_alt_diff(_finish_alt_diff),
+   iterations(0)
 {
 }
 
@@ -42,6 +42,12 @@ class AbstractContest {
   ContestResult best_result;
   ContestTraceVector best_solution;
 
+  /**
+   * The number of search iterations since construction.  This is
+   * only used for benchmarking.
+   */
+  unsigned long iterations;
+
 public:
   /**
    * Constructor
@@ -72,6 +78,15 @@ public:
     return best_solution;
   }
 
+  unsigned long GetIterations() const {
+    return iterations;
+  }
+
+protected:
+  void AddIterations(unsigned n) {
+    iterations += n;
+  }
+
 protected:
   /**
    * Calculate the result.
@@ -32,6 +32,9 @@ Copyright_License {
 // set size of reserved queue elements (may differ from Dijkstra default)
 static constexpr unsigned CONTEST_QUEUE_SIZE = 5000;
 
+// number of edge distances calculated at a time by AddEdges()
+static constexpr unsigned EDGE_BATCH_SIZE = 64;
+
 ContestDijkstra::ContestDijkstra(const Trace &_trace,
                                  bool _continuous,
                                  const unsigned n_legs,
@@ -215,7 +218,7 @@ ContestDijkstra::AddStartEdges()
        destination != end; destination.IncrementPointIndex()) {
     // only add points that are valid for the finish
     if (!incremental ||
-        GetPoint(destination).GetIntegerAltitude() <= max_altitude)
+        GetIntegerAltitude(destination.GetPointIndex()) <= max_altitude)
       LinkStart(destination);
   }
 }
@@ -224,6 +227,8 @@ void
 ContestDijkstra::AddEdges(const ScanTaskPoint origin,
                           const unsigned first_point)
 {
+  AddIterations(1);
+
   ScanTaskPoint destination(origin.GetStageNumber() + 1,
                             std::max(origin.GetPointIndex(), first_point));
 
@@ -239,27 +244,41 @@ ContestDijkstra::AddEdges(const ScanTaskPoint origin,
 
   const unsigned weight = GetStageWeight(origin.GetStageNumber());
 
+  const FlatGeoPoint origin_location =
+    GetFlatLocation(origin.GetPointIndex());
+
+  /* calculate the edge distances in small batches, to let the
+     compiler vectorise the loop over the flat locations */
+  unsigned distances[EDGE_BATCH_SIZE];
+
   bool previous_above = false;
-  for (const ScanTaskPoint end(destination.GetStageNumber(), n_points);
-       destination != end; destination.IncrementPointIndex()) {
-    bool above = GetPoint(destination).GetIntegerAltitude() >= min_altitude;
-
-    if (above) {
-      const unsigned d = weight * CalcEdgeDistance(origin, destination);
-      Link(destination, origin, d);
-    } else if (previous_above) {
-      /* After excessive thinning, the exact TracePoint that matches
-         the required altitude difference may be gone, and the
-         calculated result becomes overly pessimistic.  This code path
-         makes it optimistic, by checking if the previous point
-         matches. */
-
-      /* TODO: interpolate the distance */
-      const unsigned d = weight * CalcEdgeDistance(origin, destination);
-      Link(destination, origin, d);
-    }
+  while (destination.GetPointIndex() < n_points) {
+    const unsigned first = destination.GetPointIndex();
+    const unsigned last = std::min(first + EDGE_BATCH_SIZE, n_points);
+    trace_arrays.CalcFlatDistances(origin_location, first, last, distances);
+
+    for (; destination.GetPointIndex() < last;
+         destination.IncrementPointIndex()) {
+      const unsigned i = destination.GetPointIndex();
+      bool above = GetIntegerAltitude(i) >= min_altitude;
+
+      if (above) {
+        const unsigned d = weight * distances[i - first];
+        Link(destination, origin, d);
+      } else if (previous_above) {
+        /* After excessive thinning, the exact TracePoint that matches
+           the required altitude difference may be gone, and the
+           calculated result becomes overly pessimistic.  This code
+           path makes it optimistic, by checking if the previous point
+           matches. */
+
+        /* TODO: interpolate the distance */
+        const unsigned d = weight * distances[i - first];
+        Link(destination, origin, d);
+      }
 
-    previous_above = above;
+      previous_above = above;
+    }
   }
 
   if (IsFinal(destination) && predicted.IsDefined()) {
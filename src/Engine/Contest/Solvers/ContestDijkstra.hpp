@@ -137,7 +137,7 @@ protected:
   gcc_pure
   unsigned CalcEdgeDistance(const ScanTaskPoint s1,
                             const ScanTaskPoint s2) const {
-    return GetPoint(s1).FlatDistanceTo(GetPoint(s2));
+    return trace_arrays.FlatDistance(s1.GetPointIndex(), s2.GetPointIndex());
   }
 
   bool Link(const ScanTaskPoint node, const ScanTaskPoint parent,
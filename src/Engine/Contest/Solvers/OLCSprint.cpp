@@ -62,12 +62,12 @@ OLCSprint::FindStart() const
   assert(n_points >= 2);
 
   unsigned start_index = 0;
-  const auto end_time = TraceManager::GetPoint(n_points - 1).GetTime();
+  const auto end_time = GetTime(n_points - 1);
   if (end_time > 9000) {
     // fast forward to 2.5 hours before finish
     const unsigned start_time = end_time-9000;
     assert(start_index < n_points);
-    while (TraceManager::GetPoint(start_index).GetTime() < start_time) {
+    while (GetTime(start_index) < start_time) {
       ++start_index;
       assert(start_index < n_points);
     }
@@ -87,7 +87,7 @@ OLCSprint::AddStartEdges()
 
   const ScanTaskPoint start(0, FindStart());
 
-  if (GetPoint(start).GetIntegerAltitude() <= max_altitude)
+  if (GetIntegerAltitude(start.GetPointIndex()) <= max_altitude)
     LinkStart(start);
 }
 
@@ -24,6 +24,11 @@
 #include "Cast.hpp"
 #include "Trace/Trace.hpp"
 #include "Util/QuadTree.hpp"
+#include "Thread/Mutex.hpp"
+#include "Thread/Cond.hxx"
+
+#include <atomic>
+#include <vector>
 
 /*
  @todo potential to use 3d convex hull to speed search
@@ -55,6 +60,12 @@
  */
 static constexpr double max_distance(1000);
 
+/**
+ * Minimum number of trace points in a closing pair for the branch and
+ * bound run to be distributed over several threads.
+ */
+static constexpr unsigned PARALLEL_MIN_POINTS = 64;
+
 OLCTriangle::OLCTriangle(const Trace &_trace,
                          const bool _is_fai, bool _predict,
                          const unsigned _finish_alt_diff)
@@ -352,6 +363,10 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
   if (!exhaustive && predict)
     max_iterations = tick_iterations;
 
+  // small ranges are not worth the overhead of starting threads
+  if (parallel_workers > 1 && to - from >= PARALLEL_MIN_POINTS)
+    return RunParallelBranchAndBound(worst_d, large_triangle_check);
+
   while (!branch_and_bound.empty()) {
     /* now loop over the tree, branching each found candidate set, adding the branch if it's feasible.
      * remove all candidate sets with d_max smaller than d_min of the largest integral candidate set
@@ -376,7 +391,7 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
      * this is a mixed depht-first/breadth-first approach, the latter
      * beeing faster, but the first a lot more memory efficient.
      */
-    std::multimap<unsigned, CandidateSet>::iterator node;
+    CandidateTree::iterator node;
 
     if (branch_and_bound.size() > n_points * 4 && iterations % 16 != 0) {
       node = branch_and_bound.upper_bound(branch_and_bound.rbegin()->first / 2);
@@ -400,60 +415,8 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
 
     } else {
       // split largest bounding box of node and create child nodes
-
-      const unsigned tp1_diag = node->second.tp1.GetDiagnoal();
-      const unsigned tp2_diag = node->second.tp2.GetDiagnoal();
-      const unsigned tp3_diag = node->second.tp3.GetDiagnoal();
-
-      const unsigned max_diag = std::max({tp1_diag, tp2_diag, tp3_diag});
-
       CandidateSet left, right;
-      bool add = false;
-
-      if (tp1_diag == max_diag && node->second.tp1.GetSize() != 1) {
-        // split tp1 range
-        const unsigned split = (node->second.tp1.index_min + node->second.tp1.index_max) / 2;
-
-        if (split <= node->second.tp2.index_max) {
-          add = true;
-
-          left = CandidateSet(TurnPointRange(*this, node->second.tp1.index_min, split),
-                              node->second.tp2, node->second.tp3);
-
-          right = CandidateSet(TurnPointRange(*this, split, node->second.tp1.index_max),
-                               node->second.tp2, node->second.tp3);
-        }
-      } else if (tp2_diag == max_diag && node->second.tp2.GetSize() != 1) {
-        // split tp2 range
-        const unsigned split = (node->second.tp2.index_min + node->second.tp2.index_max) / 2;
-
-        if (split <= node->second.tp3.index_max && split >= node->second.tp1.index_min) {
-          add = true;
-
-          left = CandidateSet(node->second.tp1,
-                              TurnPointRange(*this, node->second.tp2.index_min, split),
-                              node->second.tp3);
-
-          right = CandidateSet(node->second.tp1,
-                               TurnPointRange(*this, split, node->second.tp2.index_max),
-                               node->second.tp3);
-        }
-      } else if (node->second.tp3.GetSize() != 1) {
-        // split tp3 range
-        const unsigned split = (node->second.tp3.index_min + node->second.tp3.index_max) / 2;
-
-        if (split >= node->second.tp2.index_min) {
-          add = true;
-
-          left = CandidateSet(node->second.tp1, node->second.tp2,
-                              TurnPointRange(*this, node->second.tp3.index_min, split));
-
-          right = CandidateSet(node->second.tp1, node->second.tp2,
-                               TurnPointRange(*this, split, node->second.tp3.index_max));
-        }
-      }
-
-      if (add) {
+      if (SplitCandidateSet(node->second, left, right)) {
         // add the new candidate set only if it it's feasible and has d_min >= worst_d
         if (left.df_max >= worst_d &&
             left.IsFeasible(is_fai, large_triangle_check)) {
@@ -472,6 +435,8 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
   }
 
 
+  AddIterations(iterations);
+
   if (branch_and_bound.empty())
     running = false;
 
@@ -486,6 +451,293 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
   }
 }
 
+bool
+OLCTriangle::SplitCandidateSet(const CandidateSet &node,
+                               CandidateSet &left, CandidateSet &right) const
+{
+  const unsigned tp1_diag = node.tp1.GetDiagnoal();
+  const unsigned tp2_diag = node.tp2.GetDiagnoal();
+  const unsigned tp3_diag = node.tp3.GetDiagnoal();
+
+  const unsigned max_diag = std::max({tp1_diag, tp2_diag, tp3_diag});
+
+  if (tp1_diag == max_diag && node.tp1.GetSize() != 1) {
+    // split tp1 range
+    const unsigned split = (node.tp1.index_min + node.tp1.index_max) / 2;
+
+    if (split > node.tp2.index_max)
+      return false;
+
+    left = CandidateSet(TurnPointRange(*this, node.tp1.index_min, split),
+                        node.tp2, node.tp3);
+
+    right = CandidateSet(TurnPointRange(*this, split, node.tp1.index_max),
+                         node.tp2, node.tp3);
+    return true;
+  } else if (tp2_diag == max_diag && node.tp2.GetSize() != 1) {
+    // split tp2 range
+    const unsigned split = (node.tp2.index_min + node.tp2.index_max) / 2;
+
+    if (split > node.tp3.index_max || split < node.tp1.index_min)
+      return false;
+
+    left = CandidateSet(node.tp1,
+                        TurnPointRange(*this, node.tp2.index_min, split),
+                        node.tp3);
+
+    right = CandidateSet(node.tp1,
+                         TurnPointRange(*this, split, node.tp2.index_max),
+                         node.tp3);
+    return true;
+  } else if (node.tp3.GetSize() != 1) {
+    // split tp3 range
+    const unsigned split = (node.tp3.index_min + node.tp3.index_max) / 2;
+
+    if (split < node.tp2.index_min)
+      return false;
+
+    left = CandidateSet(node.tp1, node.tp2,
+                        TurnPointRange(*this, node.tp3.index_min, split));
+
+    right = CandidateSet(node.tp1, node.tp2,
+                         TurnPointRange(*this, split, node.tp3.index_max));
+    return true;
+  } else
+    return false;
+}
+
+/**
+ * The state of one thread of the parallel branch and bound solver.
+ * The tree is protected by a spin lock, because it is held only for
+ * a few map operations at a time.
+ */
+struct OLCTriangle::BranchAndBoundWorker {
+  std::atomic_flag lock = ATOMIC_FLAG_INIT;
+
+  CandidateTree tree;
+
+  /**
+   * The best integral candidate set found by this worker.
+   */
+  bool integral_feasible = false;
+  unsigned df_min = 0, df_max = 0;
+  unsigned tp1 = 0, tp2 = 0, tp3 = 0;
+
+  void Lock() {
+    while (lock.test_and_set(std::memory_order_acquire)) {}
+  }
+
+  void Unlock() {
+    lock.clear(std::memory_order_release);
+  }
+};
+
+std::tuple<unsigned, unsigned, unsigned, unsigned>
+OLCTriangle::RunParallelBranchAndBound(unsigned _worst_d,
+                                       const unsigned large_triangle_check)
+{
+  typedef BranchAndBoundWorker Worker;
+
+  const unsigned n_workers = parallel_workers;
+  std::vector<Worker> workers(n_workers);
+
+  /* distribute the nodes of an unfinished run round-robin, so all
+     workers have something to start with */
+  unsigned n = 0;
+  for (const auto &i : branch_and_bound)
+    workers[n++ % n_workers].tree.insert(i);
+  branch_and_bound.clear();
+
+  /* the incumbent bound, shared by all workers */
+  std::atomic<unsigned> worst_d(_worst_d);
+
+  /* the number of nodes in all trees plus the nodes being worked
+     on; when this drops to zero, the search is complete */
+  std::atomic<unsigned> pending(n);
+
+  std::atomic<unsigned> iterations(0);
+  std::atomic<bool> abort(false);
+
+  /* idle workers sleep on #idle_cond until #generation changes
+     (i.e. new nodes were pushed), the search is complete or it was
+     aborted; #n_idle allows busy workers to skip the mutex when
+     nobody is sleeping */
+  Mutex idle_mutex;
+  Cond idle_cond;
+  std::atomic<unsigned> generation(0), n_idle(0);
+
+  const auto wake_idle = [&idle_mutex, &idle_cond, &n_idle]() {
+    if (n_idle.load() > 0) {
+      ScopeLock protect(idle_mutex);
+      idle_cond.broadcast();
+    }
+  };
+
+  /* retire nodes; wake up the idle workers when the search is
+     complete */
+  const auto retire = [&pending, &wake_idle](unsigned n) {
+    if ((pending -= n) == 0)
+      wake_idle();
+  };
+
+  const auto raise_worst_d = [&worst_d](unsigned value) {
+    unsigned old = worst_d.load();
+    while (value > old && !worst_d.compare_exchange_weak(old, value)) {}
+  };
+
+  /* remove all nodes with d_max < worst_d and pick the next node to
+     work on; the caller must hold the lock */
+  const auto pop = [this, &worst_d, &retire, &iterations]
+    (Worker &w, CandidateSet &node, bool steal) {
+    auto &tree = w.tree;
+    const auto pruned = tree.lower_bound(worst_d.load());
+    const unsigned n_pruned = std::distance(tree.begin(), pruned);
+    if (n_pruned > 0) {
+      tree.erase(tree.begin(), pruned);
+      retire(n_pruned);
+    }
+
+    if (tree.empty())
+      return false;
+
+    /* same mixed depth-first/breadth-first strategy as the serial
+       loop; thieves always take the best node */
+    CandidateTree::iterator i;
+    if (!steal && tree.size() > n_points * 4 && iterations.load() % 16 != 0) {
+      i = tree.upper_bound(tree.rbegin()->first / 2);
+      if (i == tree.end()) --i;
+    } else {
+      i = std::prev(tree.end());
+    }
+
+    node = i->second;
+    tree.erase(i);
+    return true;
+  };
+
+  const auto work = [&, this](unsigned index) {
+    Worker &self = workers[index];
+    CandidateSet node, left, right;
+
+    while (!abort.load(std::memory_order_relaxed)) {
+      const unsigned old_generation = generation.load();
+
+      self.Lock();
+      bool found = pop(self, node, false);
+      self.Unlock();
+
+      for (unsigned j = 1; !found && j < n_workers; ++j) {
+        Worker &victim = workers[(index + j) % n_workers];
+        victim.Lock();
+        found = pop(victim, node, true);
+        victim.Unlock();
+      }
+
+      if (!found) {
+        /* other workers may still be busy and produce new nodes;
+           wait for them.  #n_idle is incremented before #generation
+           is checked, so a push either sees this worker sleeping or
+           this worker sees the push. */
+        ++n_idle;
+
+        {
+          ScopeLock protect(idle_mutex);
+          while (generation.load() == old_generation &&
+                 pending.load() > 0 && !abort.load())
+            idle_cond.wait(idle_mutex);
+        }
+
+        --n_idle;
+
+        if (pending.load() == 0)
+          break;
+
+        continue;
+      }
+
+      // break loop if max_iterations or max_tree_size exceeded
+      if (++iterations > max_iterations || pending.load() > max_tree_size) {
+        self.Lock();
+        self.tree.emplace(node.df_max, node);
+        self.Unlock();
+        abort = true;
+        wake_idle();
+        break;
+      }
+
+      const unsigned current_worst_d = worst_d.load();
+
+      if (node.df_max < current_worst_d) {
+        // has become obsolete while we were looking for it
+      } else if (node.df_min >= current_worst_d &&
+                 node.IsIntegral(*this, is_fai, large_triangle_check)) {
+        // node is integral feasible -> a possible solution
+        raise_worst_d(node.df_min);
+
+        if (!self.integral_feasible || node.df_min >= self.df_min) {
+          self.integral_feasible = true;
+          self.df_min = node.df_min;
+          self.df_max = node.df_max;
+          self.tp1 = node.tp1.index_min;
+          self.tp2 = node.tp2.index_min;
+          self.tp3 = node.tp3.index_min;
+        }
+      } else if (SplitCandidateSet(node, left, right)) {
+        // add the new candidate set only if it it's feasible and has d_min >= worst_d
+        const bool add_left = left.df_max >= current_worst_d &&
+          left.IsFeasible(is_fai, large_triangle_check);
+        const bool add_right = right.df_max >= current_worst_d &&
+          right.IsFeasible(is_fai, large_triangle_check);
+
+        if (add_left || add_right) {
+          /* account for the children before this node is retired,
+             or another worker might see zero and quit early */
+          pending += unsigned(add_left) + unsigned(add_right);
+
+          self.Lock();
+          if (add_left)
+            self.tree.emplace(left.df_max, left);
+          if (add_right)
+            self.tree.emplace(right.df_max, right);
+          self.Unlock();
+
+          ++generation;
+          wake_idle();
+        }
+      }
+
+      // current node is done
+      retire(1);
+    }
+  };
+
+  parallel_run(n_workers, work);
+
+  AddIterations(std::min(iterations.load(), max_iterations));
+
+  /* keep the nodes of an aborted run for the next call */
+  for (auto &w : workers)
+    branch_and_bound.insert(w.tree.begin(), w.tree.end());
+
+  running = !branch_and_bound.empty();
+
+  const Worker *best = nullptr;
+  for (const auto &w : workers)
+    if (w.integral_feasible && (best == nullptr || w.df_min > best->df_min))
+      best = &w;
+
+  if (best == nullptr)
+    return std::tuple<unsigned, unsigned, unsigned, unsigned>(0, 0, 0, 0);
+
+  unsigned tp1 = best->tp1, tp2 = best->tp2, tp3 = best->tp3;
+  if (tp1 > tp2) std::swap(tp1, tp2);
+  if (tp2 > tp3) std::swap(tp2, tp3);
+  if (tp1 > tp2) std::swap(tp1, tp2);
+
+  return std::tuple<unsigned, unsigned, unsigned, unsigned>(tp1, tp2, tp3,
+                                                            best->df_max);
+}
+
 ContestResult
 OLCTriangle::CalculateResult() const
 {
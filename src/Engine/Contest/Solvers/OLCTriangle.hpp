@@ -27,6 +27,7 @@
 #include "TraceManager.hpp"
 #include "Trace/Point.hpp"
 #include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Util/ParallelRunFunction.hpp"
 
 #include <map>
 
@@ -91,6 +92,13 @@ private:
   unsigned max_iterations,
            max_tree_size;
 
+  /**
+   * If set, then large branch and bound runs are distributed over
+   * #parallel_workers threads.
+   */
+  ParallelRunFunction parallel_run;
+  unsigned parallel_workers = 1;
+
   typedef std::pair<unsigned, unsigned> ClosingPair;
 
   struct ClosingPairs {
@@ -173,10 +181,7 @@ private:
 
     // updates the bounding box by a given point range
     void Update(const OLCTriangle &parent, unsigned _min, unsigned _max) {
-      bounding_box = FlatBoundingBox(parent.GetPoint(_min).GetFlatLocation());
-
-      for (unsigned i = _min + 1; i < _max; ++i)
-        bounding_box.Expand(parent.GetPoint(i).GetFlatLocation());
+      bounding_box = parent.trace_arrays.GetBoundingBox(_min, _max);
 
       index_min = _min;
       index_max = _max;
@@ -274,7 +279,7 @@ private:
      * distances for certain checks, otherwise real distances for marginal fai triangles.
      */
     gcc_pure
-    bool IsIntegral(OLCTriangle &parent, const bool fai,
+    bool IsIntegral(const OLCTriangle &parent, const bool fai,
                     const unsigned large_triangle_check) const {
       if (!(tp1.GetSize() == 1 && tp2.GetSize() == 1 && tp3.GetSize() == 1))
         return false;
@@ -329,7 +334,11 @@ private:
     }
   };
 
-  std::multimap<unsigned, CandidateSet> branch_and_bound;
+  typedef std::multimap<unsigned, CandidateSet> CandidateTree;
+
+  CandidateTree branch_and_bound;
+
+  struct BranchAndBoundWorker;
 
 public:
   OLCTriangle(const Trace &_trace,
@@ -348,6 +357,28 @@ protected:
   std::tuple<unsigned, unsigned, unsigned, unsigned>
   RunBranchAndBound(unsigned from, unsigned to, unsigned best_d, bool exhaustive);
 
+private:
+  /**
+   * Split the largest bounding box of the given node in two halves.
+   *
+   * @return false if the node cannot be split
+   */
+  bool SplitCandidateSet(const CandidateSet &node,
+                         CandidateSet &left, CandidateSet &right) const;
+
+  /**
+   * Work on #branch_and_bound with #parallel_workers threads.  They
+   * share the incumbent bound, each one keeps its own tree and steals
+   * from the others when it runs out of work.
+   *
+   * @return the same as RunBranchAndBound()
+   */
+  std::tuple<unsigned, unsigned, unsigned, unsigned>
+  RunParallelBranchAndBound(unsigned worst_d,
+                            unsigned large_triangle_check);
+
+protected:
+
   void UpdateTrace(bool force) override;
   void ResetBranchAndBound();
 
@@ -360,6 +391,15 @@ public:
     max_tree_size = _max_tree_size;
   };
 
+  /**
+   * Enable the parallel branch and bound solver.  Pass n_workers=1
+   * to disable it.
+   */
+  void SetParallel(ParallelRunFunction _parallel_run, unsigned n_workers) {
+    parallel_run = std::move(_parallel_run);
+    parallel_workers = parallel_run ? std::max(n_workers, 1u) : 1u;
+  }
+
   /* virtual methods from AbstractContest */
   void Reset() override;
   SolverResult Solve(bool exhaustive) override;
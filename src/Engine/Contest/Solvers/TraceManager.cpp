@@ -83,7 +83,7 @@ TraceManager::IsMasterUpdated(bool continuous) const
   const unsigned threshold_distance_trace = trace_master.GetAverageDeltaDistance();
 
   const TracePoint &last_master = trace_master.back();
-  const TracePoint &last_point = *trace.back();
+  const TracePoint &last_point = trace.back();
 
   // update trace if time and distance are greater than significance thresholds
 
@@ -97,6 +97,7 @@ TraceManager::ClearTrace()
   append_serial = modify_serial = Serial();
   trace_dirty = true;
   trace.clear();
+  trace_arrays.clear();
   n_points = 0;
   predicted = TracePoint::Invalid();
 }
@@ -108,6 +109,11 @@ TraceManager::UpdateTraceFull()
   trace_master.GetPoints(trace);
   n_points = trace.size();
 
+  trace_arrays.clear();
+  trace_arrays.reserve(trace.capacity());
+  trace_arrays.Append(trace.begin(), trace.end());
+  UpdatePeakMemory();
+
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
 
@@ -128,7 +134,9 @@ TraceManager::UpdateTraceTail()
     /* no new points */
     return false;
 
+  trace_arrays.Append(trace.begin() + trace_arrays.size(), trace.end());
   n_points = trace.size();
+  UpdatePeakMemory();
 
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
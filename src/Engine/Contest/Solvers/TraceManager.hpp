@@ -27,6 +27,7 @@ Copyright_License {
 #include "Util/Serial.hpp"
 #include "Trace/Trace.hpp"
 #include "Trace/Vector.hpp"
+#include "Trace/PointArrays.hpp"
 #include "Trace/Point.hpp"
 
 class TraceManager {
@@ -50,11 +51,17 @@ private:
 
 protected:
   /**
-   * Working trace for solver.  This contains pointers to trace_master
-   * records, which get Invalidated when the trace gets thinned.  Be
-   * careful!
+   * Working trace for solver.  This is a copy of the trace_master
+   * records, because the master recycles its records when it gets
+   * thinned, which may happen while a solver run is in progress.
    */
-  TracePointerVector trace;
+  TracePointVector trace;
+
+  /**
+   * Flat locations, times and altitudes of #trace, for the solvers'
+   * inner loops.  Kept in sync with #trace.
+   */
+  TracePointArrays trace_arrays;
 
   /** Number of points in current trace set */
   unsigned n_points;
@@ -65,6 +72,13 @@ protected:
 
   bool trace_dirty;
 
+private:
+  /**
+   * The largest size of #trace in bytes so far.  This is only used
+   * for benchmarking.
+   */
+  size_t peak_memory = 0;
+
 public:
   /**
    * Constructor
@@ -83,9 +97,22 @@ public:
    */
   bool SetPredicted(const TracePoint &_predicted);
 
+  size_t GetPeakMemory() const {
+    return peak_memory;
+  }
+
 protected:
   void ClearTrace();
 
+private:
+  void UpdatePeakMemory() {
+    const size_t memory = trace.capacity() * sizeof(trace.front()) +
+      trace_arrays.GetMemory();
+    if (memory > peak_memory)
+      peak_memory = memory;
+  }
+
+protected:
   /**
    * Obtain a new #Trace copy.
    */
@@ -102,7 +129,28 @@ protected:
   const TracePoint &GetPoint(unsigned i) const {
     assert(i < n_points);
 
-    return *trace[i];
+    return trace[i];
+  }
+
+  gcc_pure
+  FlatGeoPoint GetFlatLocation(unsigned i) const {
+    assert(i < n_points);
+
+    return trace_arrays.GetFlatLocation(i);
+  }
+
+  gcc_pure
+  unsigned GetTime(unsigned i) const {
+    assert(i < n_points);
+
+    return trace_arrays.GetTime(i);
+  }
+
+  gcc_pure
+  int GetIntegerAltitude(unsigned i) const {
+    assert(i < n_points);
+
+    return trace_arrays.GetIntegerAltitude(i);
   }
 
   gcc_pure
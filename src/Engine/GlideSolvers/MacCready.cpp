@@ -26,6 +26,11 @@
 #include "GlideResult.hpp"
 #include "Math/ZeroFinder.hpp"
 #include "Util/Tolerances.hpp"
+#include "Util/Clamp.hpp"
+
+#include <algorithm>
+
+#include <math.h>
 
 #include <assert.h>
 
@@ -380,11 +385,76 @@ public:
   }
 };
 
+double
+MacCready::CalcBestGlideSpeed(const GlideState &task) const
+{
+  /* minimise sink(v) / ground_speed(v) by finding the zero of its
+     derivative's numerator with Newton's method; with a parabolic
+     polar, this is a cheap closed-form expression, and its derivative
+     is positive in the whole valid speed range, so it converges in a
+     few steps from the pure head wind solution */
+
+  const PolarCoefficients p = glide_polar.GetRealCoefficients();
+  const double ce = cruise_efficiency;
+  const double ce_squared = ce * ce;
+  const double head_wind = task.head_wind;
+  const double cross_wind_squared = task.wind.IsZero()
+    ? 0.
+    : std::max(task.wind.norm * task.wind.norm - head_wind * head_wind, 0.);
+
+  double v = glide_polar.GetBestGlideRatioSpeed(head_wind / ce);
+
+  for (unsigned i = 0; i < 16; ++i) {
+    const double d_squared = ce_squared * v * v - cross_wind_squared;
+    if (d_squared <= 0)
+      return -1;
+
+    const double d = sqrt(d_squared);
+
+    /* ground speed and its derivative */
+    const double g = d - head_wind;
+    if (g <= 0)
+      return -1;
+
+    const double dg = ce_squared * v / d;
+    const double ddg = -ce_squared * cross_wind_squared / (d_squared * d);
+
+    /* sink rate and its derivative */
+    const double s = (p.a * v + p.b) * v + p.c;
+    const double ds = 2 * p.a * v + p.b;
+
+    const double phi = ds * g - s * dg;
+    const double dphi = 2 * p.a * g - s * ddg;
+    if (dphi <= 0)
+      return -1;
+
+    const double step = phi / dphi;
+    v -= step;
+
+    if (fabs(step) < 1e-6)
+      /* the ratio is unimodal, so clamping to the polar's speed
+         range is correct */
+      return Clamp(v, glide_polar.GetVMin(), glide_polar.GetVMax());
+  }
+
+  return -1;
+}
+
 GlideResult
 MacCready::OptimiseGlide(const GlideState &task, const bool allow_partial) const
 {
   assert(glide_polar.GetMC() <= 0);
 
+  if (!allow_partial || task.altitude_difference > 0) {
+    /* fast path: calculate the optimum directly */
+    const double v_opt = CalcBestGlideSpeed(task);
+    if (v_opt > 0) {
+      const GlideResult result = SolveGlide(task, v_opt, allow_partial);
+      if (result.IsOk())
+        return result;
+    }
+  }
+
   MacCreadyVopt mc_vopt(task, *this,
                        glide_polar.GetVMin(), glide_polar.GetVMax(),
                        allow_partial);
@@ -143,6 +143,16 @@ private:
              const double sink_rate,
              const bool allow_partial = false) const;
 
+  /**
+   * Calculate the speed with the best glide ratio over ground for
+   * the given task (ignoring the MacCready setting).
+   *
+   * @return the speed (m/s) or a negative value if it could not be
+   * calculated
+   */
+  gcc_pure
+  double CalcBestGlideSpeed(const GlideState &task) const;
+
   /**
    * Solve a task which is known to be pure glide,
    * seeking optimal speed to fly.
@@ -26,6 +26,7 @@ Copyright_License {
 
 #include "Dijkstra.hpp"
 #include "ScanTaskPoint.hpp"
+#include "ScanTaskPointMap.hpp"
 #include "SolverResult.hpp"
 #include "Compiler.h"
 
@@ -44,7 +45,12 @@ class NavDijkstra {
 protected:
   static constexpr unsigned MAX_STAGES = 32;
 
-  struct DijkstraMap {
+  /**
+   * A hash table based "MapTemplate" for the #Dijkstra class.  It is
+   * slower than #ScanTaskPointMap, but its memory usage does not
+   * depend on the magnitude of the point indices.
+   */
+  struct HashDijkstraMap {
     struct Hash {
       std::size_t operator()(ScanTaskPoint p) const {
         return p.Key();
@@ -63,6 +69,8 @@ protected:
     };
   };
 
+  typedef ScanTaskPointMap<MAX_STAGES> DijkstraMap;
+
   typedef ::Dijkstra<ScanTaskPoint, DijkstraMap> Dijkstra;
 
   Dijkstra dijkstra;
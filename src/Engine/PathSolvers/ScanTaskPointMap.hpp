@@ -0,0 +1,260 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef SCAN_TASK_POINT_MAP_HPP
+#define SCAN_TASK_POINT_MAP_HPP
+
+#include "ScanTaskPoint.hpp"
+#include "Compiler.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <assert.h>
+
+/**
+ * A "MapTemplate" for the #Dijkstra class which stores one value per
+ * #ScanTaskPoint in a dense array (one row per stage, indexed by the
+ * point index) instead of a hash table.  Lookups are a plain array
+ * access, and the entries are allocated from a pool of fixed-size
+ * chunks which is retained by Clear(), so a #Dijkstra object that is
+ * reused for many searches stops allocating memory after the first
+ * few.
+ *
+ * Entries are iterated in insertion order.
+ *
+ * @param max_stages the upper bound for ScanTaskPoint::GetStageNumber()
+ */
+template<unsigned max_stages>
+struct ScanTaskPointMap {
+  template<typename Value>
+  class Bind {
+    /* entries are recycled by clear() without calling their
+       destructor */
+    static_assert(std::is_trivially_destructible<Value>::value,
+                  "Value must be trivially destructible");
+
+    struct Entry {
+      const ScanTaskPoint first;
+      Value second;
+
+      /**
+       * The next entry in insertion order.
+       */
+      Entry *next;
+
+      Entry(ScanTaskPoint _first, const Value &_second)
+        :first(_first), second(_second), next(nullptr) {}
+    };
+
+    static constexpr unsigned CHUNK_SIZE = 1024;
+
+    typedef typename std::aligned_storage<sizeof(Entry),
+                                          alignof(Entry)>::type Storage;
+
+    /**
+     * The entry pool.  Chunks are never freed before the destructor
+     * runs, which keeps Entry pointers stable.
+     */
+    std::vector<std::unique_ptr<Storage[]>> chunks;
+
+    /**
+     * One row per stage, mapping the point index to its entry (or
+     * nullptr).  Each row grows on demand.
+     */
+    std::vector<Entry *> index[max_stages];
+
+    Entry *head = nullptr, **tail = &head;
+
+    unsigned n_entries = 0;
+
+  public:
+    template<typename E>
+    class Iterator {
+      friend class Bind;
+      template<typename> friend class Iterator;
+
+      E *entry;
+
+      constexpr Iterator(E *_entry):entry(_entry) {}
+
+    public:
+      constexpr Iterator():entry(nullptr) {}
+
+      /**
+       * Allow converting #iterator to #const_iterator.
+       */
+      template<typename O>
+      constexpr Iterator(const Iterator<O> &other)
+        :entry(other.entry) {}
+
+      E &operator*() const {
+        return *entry;
+      }
+
+      E *operator->() const {
+        return entry;
+      }
+
+      Iterator &operator++() {
+        entry = entry->next;
+        return *this;
+      }
+
+      constexpr bool operator==(const Iterator &other) const {
+        return entry == other.entry;
+      }
+
+      constexpr bool operator!=(const Iterator &other) const {
+        return entry != other.entry;
+      }
+    };
+
+    typedef Iterator<Entry> iterator;
+    typedef Iterator<const Entry> const_iterator;
+
+    Bind() = default;
+
+    Bind(const Bind &other) {
+      for (const auto &i : other)
+        Emplace(i.first, i.second);
+    }
+
+    Bind &operator=(const Bind &other) {
+      if (this != &other) {
+        clear();
+        for (const auto &i : other)
+          Emplace(i.first, i.second);
+      }
+
+      return *this;
+    }
+
+    gcc_pure
+    bool empty() const {
+      return n_entries == 0;
+    }
+
+    gcc_pure
+    unsigned size() const {
+      return n_entries;
+    }
+
+    iterator begin() {
+      return head;
+    }
+
+    iterator end() {
+      return iterator();
+    }
+
+    const_iterator begin() const {
+      return const_iterator(head);
+    }
+
+    const_iterator end() const {
+      return const_iterator();
+    }
+
+    gcc_pure
+    iterator find(ScanTaskPoint p) {
+      return Lookup(p);
+    }
+
+    gcc_pure
+    const_iterator find(ScanTaskPoint p) const {
+      return const_iterator(Lookup(p));
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<ScanTaskPoint,
+                                                     Value> &value) {
+      Entry *&slot = MakeSlot(value.first);
+      if (slot != nullptr)
+        return std::make_pair(iterator(slot), false);
+
+      slot = Allocate(value.first, value.second);
+      return std::make_pair(iterator(slot), true);
+    }
+
+    /**
+     * Remove all entries.  The memory is kept for the next search.
+     */
+    void clear() {
+      for (Entry *i = head; i != nullptr; i = i->next)
+        index[i->first.GetStageNumber()][i->first.GetPointIndex()] = nullptr;
+
+      head = nullptr;
+      tail = &head;
+      n_entries = 0;
+    }
+
+  private:
+    gcc_pure
+    Entry *Lookup(ScanTaskPoint p) const {
+      const unsigned stage = p.GetStageNumber();
+      assert(stage < max_stages);
+
+      const auto &row = index[stage];
+      const unsigned i = p.GetPointIndex();
+      return i < row.size() ? row[i] : nullptr;
+    }
+
+    Entry *&MakeSlot(ScanTaskPoint p) {
+      const unsigned stage = p.GetStageNumber();
+      assert(stage < max_stages);
+
+      auto &row = index[stage];
+      const unsigned i = p.GetPointIndex();
+      if (i >= row.size())
+        row.resize(std::max<std::size_t>(i + 1, row.size() * 2), nullptr);
+
+      return row[i];
+    }
+
+    Entry *Allocate(ScanTaskPoint key, const Value &value) {
+      const unsigned chunk = n_entries / CHUNK_SIZE;
+      if (chunk == chunks.size())
+        chunks.emplace_back(new Storage[CHUNK_SIZE]);
+
+      Entry *entry = new(&chunks[chunk][n_entries % CHUNK_SIZE])
+        Entry(key, value);
+      ++n_entries;
+
+      *tail = entry;
+      tail = &entry->next;
+      return entry;
+    }
+
+    void Emplace(ScanTaskPoint key, const Value &value) {
+      Entry *&slot = MakeSlot(key);
+      assert(slot == nullptr);
+      slot = Allocate(key, value);
+    }
+  };
+};
+
+#endif
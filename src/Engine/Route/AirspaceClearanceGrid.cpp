@@ -0,0 +1,295 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+
+#include "AirspaceClearanceGrid.hpp"
+#include "Airspace/Airspaces.hpp"
+#include "Airspace/AbstractAirspace.hpp"
+#include "Airspace/AirspaceCircle.hpp"
+#include "Geo/Flat/FlatPoint.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+
+#include <algorithm>
+
+#include <math.h>
+
+/**
+ * Convert a (relative) cell coordinate to a cell index, clipping
+ * it to the grid.
+ */
+gcc_const
+static unsigned
+ClipCell(double v, unsigned n)
+{
+  if (v < 0)
+    return 0;
+
+  const double f = floor(v);
+  return f >= n ? n - 1 : unsigned(f);
+}
+
+/**
+ * Clip the segment to the (closed) rectangle with the Liang-Barsky
+ * algorithm.
+ *
+ * @return false if the segment does not touch the rectangle
+ */
+static bool
+ClipSegment(FlatPoint &a, FlatPoint &b,
+            double left, double bottom, double right, double top)
+{
+  const double dx = b.x - a.x, dy = b.y - a.y;
+  const double p[4] = { -dx, dx, -dy, dy };
+  const double q[4] = { a.x - left, right - a.x, a.y - bottom, top - a.y };
+
+  double t0 = 0, t1 = 1;
+  for (unsigned i = 0; i < 4; ++i) {
+    if (p[i] == 0) {
+      if (q[i] < 0)
+        return false;
+    } else {
+      const double t = q[i] / p[i];
+      if (p[i] < 0) {
+        if (t > t1)
+          return false;
+        t0 = std::max(t0, t);
+      } else {
+        if (t < t0)
+          return false;
+        t1 = std::min(t1, t);
+      }
+    }
+  }
+
+  const FlatPoint start = a;
+  a = FlatPoint(start.x + t0 * dx, start.y + t0 * dy);
+  b = FlatPoint(start.x + t1 * dx, start.y + t1 * dy);
+  return true;
+}
+
+/**
+ * Invoke the function for each cell touched by the segment widened by
+ * #margin (a superset of the cells within #margin of the segment),
+ * column by column.  Stops when the function returns false.
+ *
+ * @return false if the function has returned false
+ */
+template<typename F>
+static bool
+ForEachCell(FlatPoint a, FlatPoint b, double margin,
+            double x0, double y0, double cell_size,
+            unsigned width, unsigned height, F &&f)
+{
+  if (a.x > b.x)
+    std::swap(a, b);
+
+  const double dx = b.x - a.x, dy = b.y - a.y;
+  const double inv_cell_size = 1. / cell_size;
+
+  const unsigned col_lo = ClipCell((a.x - margin - x0) * inv_cell_size, width);
+  const unsigned col_hi = ClipCell((b.x + margin - x0) * inv_cell_size, width);
+
+  for (unsigned col = col_lo; col <= col_hi; ++col) {
+    /* the portion of the segment inside this column (widened by the
+       margin) */
+    const double column_left = x0 + col * cell_size - margin;
+    const double column_right = column_left + cell_size + 2 * margin;
+    const double xa = std::max(a.x, column_left);
+    const double xb = std::min(b.x, column_right);
+
+    double ya = a.y, yb = b.y;
+    if (dx > 0) {
+      ya = a.y + (xa - a.x) * dy / dx;
+      yb = a.y + (xb - a.x) * dy / dx;
+    }
+
+    if (ya > yb)
+      std::swap(ya, yb);
+
+    const unsigned row_lo = ClipCell((ya - margin - y0) * inv_cell_size,
+                                     height);
+    const unsigned row_hi = ClipCell((yb + margin - y0) * inv_cell_size,
+                                     height);
+
+    for (unsigned row = row_lo; row <= row_hi; ++row)
+      if (!f(col, row))
+        return false;
+  }
+
+  return true;
+}
+
+void
+AirspaceClearanceGrid::Clear()
+{
+  center = GeoPoint::Invalid();
+  width = height = 0;
+  cells.clear();
+}
+
+void
+AirspaceClearanceGrid::MarkSegment(const FlatPoint &a, const FlatPoint &b)
+{
+  ForEachCell(a, b, MARGIN, x0, y0, cell_size, width, height,
+              [this](unsigned x, unsigned y){
+                At(x, y) = 1;
+                return true;
+              });
+}
+
+void
+AirspaceClearanceGrid::MarkCircle(const FlatPoint &c, double radius)
+{
+  const double inv_cell_size = 1. / cell_size;
+  const unsigned col_lo = ClipCell((c.x - radius - MARGIN - x0) * inv_cell_size,
+                                   width);
+  const unsigned col_hi = ClipCell((c.x + radius + MARGIN - x0) * inv_cell_size,
+                                   width);
+  const unsigned row_lo = ClipCell((c.y - radius - MARGIN - y0) * inv_cell_size,
+                                   height);
+  const unsigned row_hi = ClipCell((c.y + radius + MARGIN - y0) * inv_cell_size,
+                                   height);
+
+  for (unsigned row = row_lo; row <= row_hi; ++row) {
+    const double bottom = y0 + row * cell_size - MARGIN;
+    const double top = bottom + cell_size + 2 * MARGIN;
+
+    for (unsigned col = col_lo; col <= col_hi; ++col) {
+      const double left = x0 + col * cell_size - MARGIN;
+      const double right = left + cell_size + 2 * MARGIN;
+
+      /* mark the whole disc, not just the circumference: unlike
+         AirspacePolygon, AirspaceCircle::Intersects() reports a link
+         which lies completely inside the circle */
+      const double near_x = std::max(left, std::min(c.x, right)) - c.x;
+      const double near_y = std::max(bottom, std::min(c.y, top)) - c.y;
+
+      if (near_x * near_x + near_y * near_y <= radius * radius)
+        At(col, row) = 1;
+    }
+  }
+}
+
+void
+AirspaceClearanceGrid::Build(const Airspaces &airspaces)
+{
+  Clear();
+
+  const FlatProjection &projection = airspaces.GetProjection();
+  if (!projection.IsValid())
+    return;
+
+  /* pass 1: determine the bounds */
+
+  bool empty = true;
+  double left = 0, bottom = 0, right = 0, top = 0;
+
+  const auto expand = [&](double x_min, double y_min,
+                          double x_max, double y_max){
+    if (empty) {
+      left = x_min;
+      bottom = y_min;
+      right = x_max;
+      top = y_max;
+      empty = false;
+    } else {
+      left = std::min(left, x_min);
+      bottom = std::min(bottom, y_min);
+      right = std::max(right, x_max);
+      top = std::max(top, y_max);
+    }
+  };
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &as = i.GetAirspace();
+    if (as.GetShape() == AbstractAirspace::Shape::CIRCLE) {
+      const AirspaceCircle &circle = (const AirspaceCircle &)as;
+      const FlatPoint c = projection.ProjectFloat(circle.GetCenter());
+      const double r = projection.ProjectRangeFloat(circle.GetCenter(),
+                                                    circle.GetRadius());
+      expand(c.x - r, c.y - r, c.x + r, c.y + r);
+    } else {
+      for (const auto &p : as.GetPoints()) {
+        const FlatGeoPoint &f = p.GetFlatLocation();
+        expand(f.x, f.y, f.x, f.y);
+      }
+    }
+  }
+
+  if (empty)
+    return;
+
+  x0 = left - 2 * MARGIN;
+  y0 = bottom - 2 * MARGIN;
+  x1 = right + 2 * MARGIN;
+  y1 = top + 2 * MARGIN;
+
+  cell_size = std::max(std::max(x1 - x0, y1 - y0) / MAX_CELLS, 1.);
+  width = std::max(unsigned(ceil((x1 - x0) / cell_size)), 1u);
+  height = std::max(unsigned(ceil((y1 - y0) / cell_size)), 1u);
+  cells.assign(width * height, 0);
+
+  /* pass 2: rasterise the borders */
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &as = i.GetAirspace();
+    if (as.GetShape() == AbstractAirspace::Shape::CIRCLE) {
+      const AirspaceCircle &circle = (const AirspaceCircle &)as;
+      MarkCircle(projection.ProjectFloat(circle.GetCenter()),
+                 projection.ProjectRangeFloat(circle.GetCenter(),
+                                              circle.GetRadius()));
+    } else {
+      const auto &border = as.GetPoints();
+      if (border.empty())
+        continue;
+
+      FlatPoint last(border.back().GetFlatLocation().x,
+                     border.back().GetFlatLocation().y);
+      for (const auto &p : border) {
+        const FlatPoint current(p.GetFlatLocation().x,
+                                p.GetFlatLocation().y);
+        MarkSegment(last, current);
+        last = current;
+      }
+    }
+  }
+
+  center = projection.GetCenter();
+}
+
+bool
+AirspaceClearanceGrid::IsClear(FlatGeoPoint _a, FlatGeoPoint _b) const
+{
+  if (!IsDefined())
+    return false;
+
+  FlatPoint a(_a.x, _a.y), b(_b.x, _b.y);
+  if (!ClipSegment(a, b, x0, y0, x1, y1))
+    /* outside of all airspaces */
+    return true;
+
+  /* the margin has already been applied to the marked cells */
+  return ForEachCell(a, b, 0, x0, y0, cell_size, width, height,
+                     [this](unsigned x, unsigned y){
+                       return At(x, y) == 0;
+                     });
+}
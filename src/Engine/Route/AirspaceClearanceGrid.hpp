@@ -0,0 +1,125 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+
+#ifndef XCSOAR_AIRSPACE_CLEARANCE_GRID_HPP
+#define XCSOAR_AIRSPACE_CLEARANCE_GRID_HPP
+
+#include "Geo/Flat/FlatGeoPoint.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <stdint.h>
+
+class Airspaces;
+struct FlatPoint;
+
+/**
+ * A coarse raster (on the airspace projection) of the cells touched
+ * by the outline of at least one airspace, and of the cells inside
+ * circular airspaces.  It is used by AirspaceRoute to prove quickly
+ * that the exact intersection test would not find anything for a
+ * link; only links passing through a marked cell need that test.
+ *
+ * Since AirspaceRoute::Synchronise() only keeps airspaces within the
+ * altitude band of the current search, the grid is implicitly built
+ * for that band.
+ */
+class AirspaceClearanceGrid {
+  /**
+   * The maximum number of cells in each direction.
+   */
+  static constexpr unsigned MAX_CELLS = 256;
+
+  /**
+   * Margin (in flat units) around airspace borders, which covers
+   * rounding errors of the exact intersection test.
+   */
+  static constexpr double MARGIN = 4;
+
+  /** The projection center this grid was built for */
+  GeoPoint center = GeoPoint::Invalid();
+
+  /** Flat coordinates of the lower left corner of cell 0 */
+  double x0, y0;
+
+  /**
+   * Flat coordinates of the upper right corner of the area covered
+   * by airspaces (plus margin).  Links are clipped to this.
+   */
+  double x1, y1;
+
+  /** Size of one (square) cell in flat units */
+  double cell_size;
+
+  unsigned width = 0, height = 0;
+
+  /**
+   * One byte per cell; non-zero if an airspace border touches it or
+   * if it is inside a circle
+   */
+  std::vector<uint8_t> cells;
+
+public:
+  void Clear();
+
+  bool IsDefined() const {
+    return center.IsValid();
+  }
+
+  /**
+   * Returns the projection center this grid was built for, or an
+   * invalid location.
+   */
+  const GeoPoint &GetCenter() const {
+    return center;
+  }
+
+  /**
+   * Rasterise the borders of all airspaces in the given database.
+   */
+  void Build(const Airspaces &airspaces);
+
+  /**
+   * Is the link certainly neither crossing any airspace border nor
+   * inside a circle?  A false return value means that the exact test
+   * is required.
+   */
+  gcc_pure
+  bool IsClear(FlatGeoPoint a, FlatGeoPoint b) const;
+
+private:
+  void MarkSegment(const FlatPoint &a, const FlatPoint &b);
+  void MarkCircle(const FlatPoint &c, double radius);
+
+  uint8_t &At(unsigned x, unsigned y) {
+    return cells[y * width + x];
+  }
+
+  uint8_t At(unsigned x, unsigned y) const {
+    return cells[y * width + x];
+  }
+};
+
+#endif
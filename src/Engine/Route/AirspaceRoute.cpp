@@ -83,6 +83,12 @@ public:
 AirspaceRoute::RouteAirspaceIntersection
 AirspaceRoute::FirstIntersecting(const RouteLink &e) const
 {
+  if (use_grid && grid.IsClear(e.first, e.second)) {
+    /* not near any airspace border */
+    ++count_grid;
+    return RouteAirspaceIntersection(nullptr, e.first);
+  }
+
   const GeoPoint origin(projection.Unproject(e.first));
   const GeoPoint dest(projection.Unproject(e.second));
   AIV visitor(e, projection, rpolars_route);
@@ -180,7 +186,7 @@ AirspaceRoute::AirspaceSize() const
   return m_airspaces.GetSize();
 }
 
-AirspaceRoute::AirspaceRoute():m_airspaces(false)
+AirspaceRoute::AirspaceRoute():m_airspaces(false), count_grid(0)
 {
   Reset();
 }
@@ -197,6 +203,17 @@ AirspaceRoute::Reset()
   RoutePlanner::Reset();
   m_airspaces.ClearClearances();
   m_airspaces.Clear();
+  grid.Clear();
+}
+
+void
+AirspaceRoute::SetClearanceGrid(bool enabled)
+{
+  use_grid = enabled;
+  if (use_grid)
+    grid.Build(m_airspaces);
+  else
+    grid.Clear();
 }
 
 void
@@ -217,12 +234,17 @@ AirspaceRoute::Synchronise(const Airspaces &master,
                                               AirspacePredicateRef(_condition));
   const auto predicate = WrapAirspacePredicate(and_condition);
 
-  if (m_airspaces.SynchroniseInRange(master, origin.Middle(destination),
-                                     0.5 * origin.Distance(destination),
-                                     predicate)) {
-    if (!m_airspaces.IsEmpty())
-      dirty = true;
-  }
+  const bool changed =
+    m_airspaces.SynchroniseInRange(master, origin.Middle(destination),
+                                   0.5 * origin.Distance(destination),
+                                   predicate);
+  if (changed && !m_airspaces.IsEmpty())
+    dirty = true;
+
+  if (use_grid &&
+      (changed ||
+       !(grid.GetCenter() == m_airspaces.GetProjection().GetCenter())))
+    grid.Build(m_airspaces);
 }
 
 void
@@ -296,6 +318,8 @@ AirspaceRoute::CheckClearance(const RouteLink &e, RoutePoint &inp) const
 void
 AirspaceRoute::OnSolve(const AGeoPoint &origin, const AGeoPoint &destination)
 {
+  count_grid = 0;
+
   if (m_airspaces.IsEmpty()) {
     projection.SetCenter(origin);
   } else {
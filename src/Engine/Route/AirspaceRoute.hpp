@@ -24,6 +24,7 @@
 #define XCSOAR_AIRSPACE_ROUTE_HPP
 
 #include "RoutePlanner.hpp"
+#include "AirspaceClearanceGrid.hpp"
 #include "Airspace/Airspaces.hpp"
 
 class AirspaceRoute : public RoutePlanner {
@@ -44,6 +45,17 @@ class AirspaceRoute : public RoutePlanner {
 
   mutable RouteAirspaceIntersection m_inx;
 
+  /**
+   * Rasterised airspace borders, rebuilt by Synchronise() when the
+   * set of airspaces changes.  Used by FirstIntersecting() to skip the
+   * exact intersection test for links far away from any border.
+   */
+  AirspaceClearanceGrid grid;
+  bool use_grid = true;
+
+  /** Number of airspace queries answered by #grid */
+  mutable unsigned long count_grid;
+
 public:
   friend class PrintHelper;
 
@@ -58,6 +70,12 @@ public:
 
   unsigned AirspaceSize() const;
 
+  /**
+   * Enable or disable the airspace clearance grid.  The solution does
+   * not depend on this setting, only the speed.
+   */
+  void SetClearanceGrid(bool enabled);
+
 protected:
 
   void OnSolve(const AGeoPoint &origin, const AGeoPoint &destination) override;
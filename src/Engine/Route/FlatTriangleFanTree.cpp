@@ -27,6 +27,10 @@
 #include "Util/GlobalSliceAllocator.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 
+#include <algorithm>
+
+#include <assert.h>
+
 #define REACH_BUFFER 1
 #define REACH_SWEEP (ROUTEPOLAR_Q1-REACH_BUFFER)
 
@@ -113,6 +117,28 @@ FlatTriangleFanTree::FillDepth(const AFlatGeoPoint &origin,
   return true;
 }
 
+/**
+ * Calculate the intercepts of the rays index_low..index_high-1 on
+ * several threads.  The rays are interleaved among the workers,
+ * because their cost depends on the direction (i.e. on the terrain
+ * and the wind).
+ */
+static void
+ParallelReachIntercepts(const AFlatGeoPoint &origin,
+                        const GeoPoint &geo_origin,
+                        const int index_low, const int index_high,
+                        const ReachFanParms &parms,
+                        FlatGeoPoint *dest)
+{
+  const unsigned n = index_high - index_low;
+  const unsigned n_workers = std::min(parms.parallel_workers, n);
+
+  (*parms.parallel_run)(n_workers, [&](unsigned index){
+      for (unsigned i = index; i < n; i += n_workers)
+        dest[i] = parms.ReachIntercept(index_low + i, origin, geo_origin);
+    });
+}
+
 bool
 FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
                                const int index_high,
@@ -131,8 +157,23 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
   }
 
   AddOrigin(origin, index_high - index_low);
+
+  /* only the root fan is worth distributing: it has the most rays
+     and the longest ones, while the child fans are small, and
+     starting threads for each of them would cost more than it
+     saves */
+  FlatGeoPoint intercepts[ROUTEPOLAR_POINTS];
+  const bool parallel = IsRoot() && parms.IsParallel();
+  if (parallel) {
+    assert(index_low >= 0 && index_high <= ROUTEPOLAR_POINTS);
+    ParallelReachIntercepts(origin, geo_origin, index_low, index_high,
+                            parms, intercepts);
+  }
+
   for (int index = index_low; index < index_high; ++index) {
-    FlatGeoPoint x = parms.ReachIntercept(index, origin, geo_origin);
+    FlatGeoPoint x = parallel
+      ? intercepts[index - index_low]
+      : parms.ReachIntercept(index, origin, geo_origin);
     /* if ReachIntercept() did not find anything reasonable it returns
        a FlatGeoPoint that is almost the same as origin, but differs
        +/- 1 due to conversion errors. The resulting polygon can have
@@ -49,6 +49,10 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
   const int h2 = h.GetValueOr0();
 
   ReachFanParms parms(rpolars, projection, terrain_base, terrain);
+  if (parallel_workers > 1) {
+    parms.parallel_run = &parallel_run;
+    parms.parallel_workers = parallel_workers;
+  }
   const AFlatGeoPoint ao(projection.ProjectInteger(origin), origin.altitude);
 
   // immediate exit if starting below terrain, or starting below floor
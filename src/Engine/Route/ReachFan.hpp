@@ -25,6 +25,9 @@
 
 #include "Geo/Flat/FlatProjection.hpp"
 #include "FlatTriangleFanTree.hpp"
+#include "Util/ParallelRunFunction.hpp"
+
+#include <algorithm>
 
 class RoutePolars;
 class RasterMap;
@@ -37,6 +40,13 @@ class ReachFan
   FlatTriangleFanTree root;
   int terrain_base;
 
+  /**
+   * If set, then the rays of the root fan are distributed over
+   * #parallel_workers threads.
+   */
+  ParallelRunFunction parallel_run;
+  unsigned parallel_workers = 1;
+
 public:
   ReachFan():terrain_base(0) {}
 
@@ -50,6 +60,15 @@ public:
     return projection;
   }
 
+  /**
+   * Enable the parallel solver.  Pass n_workers=1 to disable it.
+   * The result does not depend on the number of workers.
+   */
+  void SetParallel(ParallelRunFunction _parallel_run, unsigned n_workers) {
+    parallel_run = std::move(_parallel_run);
+    parallel_workers = parallel_run ? std::max(n_workers, 1u) : 1u;
+  }
+
   void Reset();
 
   bool Solve(const AGeoPoint origin, const RoutePolars &rpolars,
@@ -24,6 +24,7 @@
 #define REACHFAN_PARMS_HPP
 
 #include "Route/RoutePolars.hpp"
+#include "ReachFan.hpp"
 
 class FlatProjection;
 class RasterMap;
@@ -38,6 +39,13 @@ struct ReachFanParms {
   unsigned vertex_counter = 0;
   unsigned char set_depth = 0;
 
+  /**
+   * If set, then FlatTriangleFanTree distributes the rays of the
+   * root fan over #parallel_workers threads.
+   */
+  const ParallelRunFunction *parallel_run = nullptr;
+  unsigned parallel_workers = 1;
+
   ReachFanParms(const RoutePolars& _rpolars,
                 const FlatProjection &_projection,
                 const short _terrain_base,
@@ -45,6 +53,10 @@ struct ReachFanParms {
     :rpolars(_rpolars), projection(_projection), terrain(_terrain),
      terrain_base(_terrain_base) {}
 
+  bool IsParallel() const {
+    return parallel_workers > 1;
+  }
+
   gcc_pure
   FlatGeoPoint ReachIntercept(int index, const AFlatGeoPoint &flat_origin,
                               const GeoPoint &origin) const {
@@ -24,11 +24,37 @@
 #include "Terrain/RasterMap.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 
+/**
+ * The climb ceiling is rounded up to a multiple of this many metres.
+ * It is part of the terrain clearance cache's state (see
+ * RoutePolars::IsClearanceEquivalent()), and RouteComputer derives it
+ * from the aircraft's altitude, which changes on every fix.
+ */
+static constexpr int CEILING_STEP = 250;
+
+gcc_const
+static int
+RoundCeiling(int h_ceiling)
+{
+  if (h_ceiling > INT_MAX - CEILING_STEP)
+    /* no ceiling */
+    return h_ceiling;
+
+  int remainder = h_ceiling % CEILING_STEP;
+  if (remainder < 0)
+    remainder += CEILING_STEP;
+
+  return remainder > 0
+    ? h_ceiling - remainder + CEILING_STEP
+    : h_ceiling;
+}
+
 RoutePlanner::RoutePlanner()
   :terrain(NULL), planner(0),
    unique_links(50000),
    reach_polar_mode(RoutePlannerConfig::Polar::TASK)
 {
+  clearance_statistics.Reset();
   Reset();
 }
 
@@ -51,9 +77,43 @@ RoutePlanner::Reset()
   h_min = -1;
   h_max = 0;
   search_hull.clear();
+  ClearClearanceCache();
   ClearReach();
 }
 
+void
+RoutePlanner::ClearClearanceCache()
+{
+  clearance_cache.clear();
+  clearance_center = GeoPoint::Invalid();
+  clearance_terrain = nullptr;
+}
+
+void
+RoutePlanner::UpdateClearanceCache()
+{
+  const GeoPoint &center = projection.GetCenter();
+  const Serial terrain_serial = terrain != nullptr
+    ? terrain->GetSerial()
+    : Serial();
+
+  if (clearance_center.IsValid() &&
+      center == clearance_center &&
+      terrain == clearance_terrain &&
+      terrain_serial == clearance_terrain_serial &&
+      rpolars_route.IsClearanceEquivalent(clearance_polars))
+    return;
+
+  if (!clearance_cache.empty())
+    ++clearance_statistics.flushes;
+
+  clearance_cache.clear();
+  clearance_center = center;
+  clearance_terrain = terrain;
+  clearance_terrain_serial = terrain_serial;
+  clearance_polars = rpolars_route;
+}
+
 bool
 RoutePlanner::SolveReachTerrain(const AGeoPoint &origin,
                                 const RoutePlannerConfig &config,
@@ -82,7 +142,7 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
 {
   OnSolve(origin, destination);
   rpolars_route.SetConfig(config, std::max(destination.altitude, origin.altitude),
-                          h_ceiling);
+                          RoundCeiling(h_ceiling));
 
   {
     const AFlatGeoPoint s_origin(projection.ProjectInteger(origin),
@@ -129,6 +189,8 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
   count_terrain = 0;
   count_supressed = 0;
 
+  UpdateClearanceCache();
+
   bool retval = false;
   planner.Restart(start);
 
@@ -408,8 +470,30 @@ RoutePlanner::CheckClearanceTerrain(const RouteLink &e, RoutePoint& inp) const
   if (!terrain || !terrain->IsDefined())
     return true;
 
+  const auto i = clearance_cache.find(e);
+  if (i != clearance_cache.end()) {
+    ++clearance_statistics.hits;
+    if (!i->second.clear)
+      inp = i->second.intersection;
+    return i->second.clear;
+  }
+
+  ++clearance_statistics.misses;
   count_terrain++;
-  return rpolars_route.CheckClearance(e, terrain, projection, inp);
+
+  ClearanceResult result;
+  result.clear = rpolars_route.CheckClearance(e, terrain, projection,
+                                              result.intersection);
+  if (!result.clear)
+    inp = result.intersection;
+
+  if (clearance_cache.size() >= CLEARANCE_CACHE_MAX) {
+    ++clearance_statistics.flushes;
+    clearance_cache.clear();
+  }
+
+  clearance_cache.emplace(e, result);
+  return result.clear;
 }
 
 void
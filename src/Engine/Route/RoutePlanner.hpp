@@ -30,9 +30,11 @@
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Geo/SearchPointVector.hpp"
 #include "ReachFan.hpp"
+#include "Util/Serial.hpp"
 
 #include <utility>
 #include <unordered_set>
+#include <unordered_map>
 
 #include <limits.h>
 
@@ -97,6 +99,33 @@ class RoutePlanner {
     }
   };
 
+public:
+  /**
+   * Counters for tuning the terrain clearance cache.  They are
+   * cumulative; call ResetClearanceCacheStatistics() to start over.
+   */
+  struct ClearanceCacheStatistics {
+    /** Number of clearance tests answered by the cache */
+    unsigned long hits;
+
+    /** Number of clearance tests which had to query the terrain */
+    unsigned long misses;
+
+    /** Number of times the cache was discarded */
+    unsigned long flushes;
+
+    void Reset() {
+      hits = misses = flushes = 0;
+    }
+
+    gcc_pure
+    double GetHitRate() const {
+      return hits + misses > 0
+        ? double(hits) / double(hits + misses)
+        : 0;
+    }
+  };
+
 protected:
   typedef std::pair<AFlatGeoPoint, AFlatGeoPoint> ClearingPair;
 
@@ -148,6 +177,46 @@ private:
 
   RoutePlannerConfig::Polar reach_polar_mode;
 
+  /**
+   * Result of a terrain clearance test.
+   */
+  struct ClearanceResult {
+    bool clear;
+
+    /** The clearance point; only valid if #clear is false */
+    RoutePoint intersection;
+  };
+
+  typedef std::unordered_map<RouteLinkBase, ClearanceResult,
+                             RouteLinkBaseHasher> ClearanceMap;
+
+  /**
+   * Maximum number of entries in #clearance_cache; when it is
+   * exceeded, the cache is discarded.
+   */
+  static constexpr unsigned CLEARANCE_CACHE_MAX = 50000;
+
+  /**
+   * Results of CheckClearanceTerrain(), kept across Solve() calls.
+   * Links are keyed by their flat (integer) end points and
+   * altitudes, which remain meaningful while the projection center
+   * (the search origin, i.e. the target) does not move, so
+   * successive solves with a moving aircraft repeat many of the
+   * terrain queries of the previous solve.
+   */
+  mutable ClearanceMap clearance_cache;
+
+  /**
+   * The state #clearance_cache was built for.  If any of these
+   * change, the cache is discarded by UpdateClearanceCache().
+   */
+  GeoPoint clearance_center;
+  const RasterMap *clearance_terrain;
+  Serial clearance_terrain_serial;
+  RoutePolars clearance_polars;
+
+  mutable ClearanceCacheStatistics clearance_statistics;
+
   mutable unsigned long count_dij;
   mutable unsigned long count_unique;
   mutable unsigned long count_supressed;
@@ -175,10 +244,30 @@ public:
     terrain = _terrain;
   }
 
+  /**
+   * Let the reach solvers distribute their work over several
+   * threads.
+   *
+   * @see ReachFan::SetParallel()
+   */
+  void SetParallel(const ParallelRunFunction &parallel_run,
+                   unsigned n_workers) {
+    reach_terrain.SetParallel(parallel_run, n_workers);
+    reach_working.SetParallel(parallel_run, n_workers);
+  }
+
   bool IsTerrainReachEmpty() const {
     return reach_terrain.IsEmpty();
   }
 
+  const ClearanceCacheStatistics &GetClearanceCacheStatistics() const {
+    return clearance_statistics;
+  }
+
+  void ResetClearanceCacheStatistics() {
+    clearance_statistics.Reset();
+  }
+
   /**
    * Delete all reach fans.
    */
@@ -192,7 +281,7 @@ public:
    * @param origin The start of the search (finish location)
    * @param destination The end of the search (current aircraft location)
    * @param config Control parameters for performance model constraints
-   * @param h_ceiling Imposed absolute ceiling (m)
+   * @param h_ceiling Imposed absolute ceiling (m); rounded up to a multiple of 250 m
    *
    * @return True if new solution was found
    */
@@ -372,6 +461,14 @@ protected:
   bool CheckClearanceTerrain(const RouteLink &e, RoutePoint& inp) const;
 
 private:
+  /**
+   * Discard the terrain clearance cache if it was built for a
+   * different projection, terrain or performance model.
+   */
+  void UpdateClearanceCache();
+
+  void ClearClearanceCache();
+
   /**
    * Check a second category of obstacle clearance.  This allows compound
    * obstacle categories by subclasses.
@@ -129,6 +129,23 @@ RoutePolars::CheckClearance(const RouteLink &e, const RasterMap* map,
   return false;
 }
 
+bool
+RoutePolars::IsClearanceEquivalent(const RoutePolars &other) const
+{
+  if (config.IsTerrainEnabled() != other.config.IsTerrainEnabled() ||
+      GetSafetyHeight() != other.GetSafetyHeight() ||
+      climb_ceiling != other.climb_ceiling)
+    return false;
+
+  /* CalcVHeight() */
+  for (unsigned i = 0; i < ROUTEPOLAR_POINTS; ++i)
+    if (polar_glide.GetPoint(i).gradient !=
+        other.polar_glide.GetPoint(i).gradient)
+      return false;
+
+  return true;
+}
+
 RouteLink
 RoutePolars::GenerateIntermediate(const RoutePoint& _dest,
                                    const RoutePoint& _origin,
@@ -235,6 +235,14 @@ public:
                        const FlatGeoPoint& dest,
                        const FlatProjection &proj) const;
 
+  /**
+   * Does CheckClearance() give the same results with the other
+   * object?  This compares only the parameters affecting terrain
+   * clearance.
+   */
+  gcc_pure
+  bool IsClearanceEquivalent(const RoutePolars &other) const;
+
   int GetSafetyHeight() const {
     return config.safety_height_terrain;
   }
@@ -174,6 +174,13 @@ OrderedTask::UpdateGeometry()
   // projection can now be determined
   task_projection = TaskProjection(bounds);
 
+  /* task points may have been replaced; don't let the incremental
+     searches compare against deleted ones */
+  if (dijkstra_min != nullptr)
+    dijkstra_min->Invalidate();
+  if (dijkstra_max != nullptr)
+    dijkstra_max->Invalidate();
+
   // update OZ's for items that depend on next-point geometry
   UpdateObservationZones(task_points, task_projection);
   UpdateObservationZones(optional_start_points, task_projection);
@@ -228,15 +235,18 @@ OrderedTask::RunDijsktraMin(const GeoPoint &location)
   if (task_size < 2)
     return false;
 
-  if (dijkstra_min == nullptr)
+  if (dijkstra_min == nullptr) {
     dijkstra_min = new TaskDijkstraMin();
+    dijkstra_min->SetIncremental(true);
+  }
   TaskDijkstraMin &dijkstra = *dijkstra_min;
 
   const unsigned active_index = GetActiveIndex();
   dijkstra.SetTaskSize(task_size - active_index);
   for (unsigned i = active_index; i != task_size; ++i) {
-    const SearchPointVector &boundary = task_points[i]->GetSearchPoints();
-    dijkstra.SetBoundary(i - active_index, boundary);
+    const OrderedTaskPoint &tp = *task_points[i];
+    dijkstra.SetBoundary(i - active_index, tp.GetSearchPoints(),
+                         tp.GetSearchPointsSerial());
   }
 
   SearchPoint ac(location, task_projection);
@@ -287,19 +297,24 @@ OrderedTask::RunDijsktraMax()
   if (task_size < 2)
     return false;
 
-  if (dijkstra_max == nullptr)
+  if (dijkstra_max == nullptr) {
     dijkstra_max = new TaskDijkstraMax();
+    dijkstra_max->SetIncremental(true);
+  }
   TaskDijkstraMax &dijkstra = *dijkstra_max;
 
   const unsigned active_index = GetActiveIndex();
   dijkstra.SetTaskSize(task_size);
   for (unsigned i = 0; i != task_size; ++i) {
-    const SearchPointVector &boundary = i == active_index
+    const OrderedTaskPoint &tp = *task_points[i];
+    if (i == active_index)
       /* since one can still travel further in the current sector, use
          the full boundary here */
-      ? task_points[i]->GetBoundaryPoints()
-      : task_points[i]->GetSearchPoints();
-    dijkstra_max->SetBoundary(i, boundary);
+      dijkstra.SetBoundary(i, tp.GetBoundaryPoints(),
+                           tp.GetBoundaryPointsSerial());
+    else
+      dijkstra.SetBoundary(i, tp.GetSearchPoints(),
+                           tp.GetSearchPointsSerial());
   }
 
   double start_radius(-1), finish_radius(-1);
@@ -311,12 +326,14 @@ OrderedTask::RunDijsktraMax()
     const auto &start = *task_points.front();
     start_radius = GetCylinderRadiusOrMinusOne(start);
     if (start_radius > 0)
-      dijkstra.SetBoundary(0, start.GetNominalPoints());
+      dijkstra.SetBoundary(0, start.GetNominalPoints(),
+                           start.GetBoundaryPointsSerial());
 
     const auto &finish = *task_points.back();
     finish_radius = GetCylinderRadiusOrMinusOne(finish);
     if (finish_radius > 0)
-      dijkstra.SetBoundary(task_size - 1, finish.GetNominalPoints());
+      dijkstra.SetBoundary(task_size - 1, finish.GetNominalPoints(),
+                           finish.GetBoundaryPointsSerial());
   }
 
   if (!dijkstra_max->DistanceMax())
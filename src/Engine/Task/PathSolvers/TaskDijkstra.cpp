@@ -23,6 +23,8 @@
 #include "TaskDijkstra.hpp"
 #include "Geo/SearchPointVector.hpp"
 
+#include <algorithm>
+
 TaskDijkstra::TaskDijkstra(bool _is_min)
   :NavDijkstra(0),
    is_min(_is_min)
@@ -86,3 +88,153 @@ TaskDijkstra::Run()
   dijkstra.Clear();
   return retval;
 }
+
+void
+TaskDijkstra::CalculateForward(const unsigned stage,
+                               const SearchPoint &location)
+{
+  Stage &s = stages[stage];
+  const unsigned n = GetStageSize(stage);
+  s.forward_value.resize(n);
+  s.forward_link.resize(n);
+
+  if (stage == 0) {
+    for (unsigned i = 0; i < n; ++i) {
+      s.forward_value[i] = location.IsValid()
+        ? CalcDistance(ScanTaskPoint(stage, i), location)
+        : 0;
+      s.forward_link[i] = 0;
+    }
+
+    return;
+  }
+
+  const Stage &previous = stages[stage - 1];
+  const unsigned n_previous = GetStageSize(stage - 1);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const ScanTaskPoint destination(stage, i);
+
+    unsigned best_value = 0, best_link = 0;
+    for (unsigned j = 0; j < n_previous; ++j) {
+      const unsigned value = previous.forward_value[j] +
+        CalcDistance(ScanTaskPoint(stage - 1, j), destination);
+      if (j == 0 || IsBetter(value, best_value)) {
+        best_value = value;
+        best_link = j;
+      }
+    }
+
+    s.forward_value[i] = best_value;
+    s.forward_link[i] = best_link;
+  }
+}
+
+void
+TaskDijkstra::CalculateBackward(const unsigned stage)
+{
+  Stage &s = stages[stage];
+  const unsigned n = GetStageSize(stage);
+  s.backward_value.resize(n);
+  s.backward_link.resize(n);
+
+  if (IsFinal(stage)) {
+    std::fill(s.backward_value.begin(), s.backward_value.end(), 0u);
+    std::fill(s.backward_link.begin(), s.backward_link.end(), 0u);
+    return;
+  }
+
+  const Stage &next = stages[stage + 1];
+  const unsigned n_next = GetStageSize(stage + 1);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const ScanTaskPoint origin(stage, i);
+
+    unsigned best_value = 0, best_link = 0;
+    for (unsigned j = 0; j < n_next; ++j) {
+      const unsigned value = next.backward_value[j] +
+        CalcDistance(origin, ScanTaskPoint(stage + 1, j));
+      if (j == 0 || IsBetter(value, best_value)) {
+        best_value = value;
+        best_link = j;
+      }
+    }
+
+    s.backward_value[i] = best_value;
+    s.backward_link[i] = best_link;
+  }
+}
+
+bool
+TaskDijkstra::RunIncremental(const SearchPoint &location)
+{
+  assert(num_stages > 0);
+
+  for (unsigned stage = 0; stage < num_stages; ++stage) {
+    if (GetStageSize(stage) == 0) {
+      Invalidate();
+      return false;
+    }
+  }
+
+  if (cached_num_stages != num_stages) {
+    /* (re)build the whole cache */
+    for (unsigned stage = 0; stage < num_stages; ++stage)
+      stages[stage].boundary = nullptr;
+
+    cached_num_stages = num_stages;
+    forward_end = 0;
+    backward_begin = num_stages;
+  }
+
+  /* a modified stage invalidates the forward values of all stages
+     after it and the backward values of all stages before it */
+  for (unsigned stage = 0; stage < num_stages; ++stage) {
+    Stage &s = stages[stage];
+    if (s.boundary != boundaries[stage] || s.serial != serials[stage]) {
+      s.boundary = boundaries[stage];
+      s.serial = serials[stage];
+      forward_end = std::min(forward_end, stage);
+      backward_begin = std::max(backward_begin, stage + 1);
+    }
+  }
+
+  if (location.IsValid() || forward_from_location)
+    forward_end = 0;
+  forward_from_location = location.IsValid();
+
+  /* the stage where forward and backward values are joined; this is
+     the first stage without valid forward values, so only the
+     modified stages need to be calculated again */
+  const unsigned join = std::min(forward_end, num_stages - 1);
+
+  for (unsigned stage = forward_end; stage <= join; ++stage)
+    CalculateForward(stage, location);
+  forward_end = std::max(forward_end, join + 1);
+
+  for (unsigned stage = backward_begin; stage-- > join;)
+    CalculateBackward(stage);
+  backward_begin = std::min(backward_begin, join);
+
+  const Stage &j = stages[join];
+  const unsigned n = GetStageSize(join);
+  unsigned best = 0;
+  unsigned best_value = j.forward_value[0] + j.backward_value[0];
+  for (unsigned i = 1; i < n; ++i) {
+    const unsigned value = j.forward_value[i] + j.backward_value[i];
+    if (IsBetter(value, best_value)) {
+      best_value = value;
+      best = i;
+    }
+  }
+
+  solution[join] = best;
+
+  for (unsigned stage = join; stage + 1 < num_stages; ++stage)
+    solution[stage + 1] = stages[stage].backward_link[solution[stage]];
+
+  for (unsigned stage = join; stage > 0; --stage)
+    solution[stage - 1] = stages[stage].forward_link[solution[stage]];
+
+  return true;
+}
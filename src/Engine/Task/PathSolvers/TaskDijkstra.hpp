@@ -25,6 +25,9 @@
 
 #include "PathSolvers/NavDijkstra.hpp"
 #include "Geo/SearchPoint.hpp"
+#include "Util/Serial.hpp"
+
+#include <vector>
 
 #include <assert.h>
 
@@ -50,13 +53,69 @@ class SearchPointVector;
  * call SetBoundary() for each task point.
  *
  * This uses a Dijkstra search and so is O(N log(N)).
+ *
+ * In incremental mode (see SetIncremental()), the search keeps the
+ * best partial results of each stage, and only stages whose
+ * #SearchPointVector (identified by its address and #Serial) has
+ * changed since the last call are calculated again.
  */
 class TaskDijkstra : protected NavDijkstra
 {
   const SearchPointVector *boundaries[MAX_STAGES];
+  Serial serials[MAX_STAGES];
 
   const bool is_min;
 
+  bool incremental = false;
+
+  /**
+   * Cached per-stage state of the incremental search.
+   */
+  struct Stage {
+    /**
+     * The boundary the values below were calculated for.
+     */
+    const SearchPointVector *boundary;
+    Serial serial;
+
+    /**
+     * The best value from the first stage to each point of this
+     * stage, and the index of the predecessor in the previous stage.
+     */
+    std::vector<unsigned> forward_value, forward_link;
+
+    /**
+     * The best value from each point of this stage to the final
+     * stage, and the index of the successor in the next stage.
+     */
+    std::vector<unsigned> backward_value, backward_link;
+  };
+
+  Stage stages[MAX_STAGES];
+
+  /**
+   * The number of stages the #stages cache was built for; 0 if it is
+   * empty.
+   */
+  unsigned cached_num_stages = 0;
+
+  /**
+   * The "forward" values of stages [0, forward_end) are valid.
+   */
+  unsigned forward_end = 0;
+
+  /**
+   * The "backward" values of stages [backward_begin,
+   * cached_num_stages) are valid.
+   */
+  unsigned backward_begin = 0;
+
+  /**
+   * Were the "forward" values of the first stage calculated from a
+   * start location?
+   */
+  bool forward_from_location = false;
+
 public:
   /**
    * Constructor
@@ -69,10 +128,38 @@ public:
     SetStageCount(size);
   }
 
-  void SetBoundary(unsigned idx, const SearchPointVector &boundary) {
+  /**
+   * @param serial identifies the contents of the #SearchPointVector;
+   * it must change whenever the vector is modified (only used in
+   * incremental mode)
+   */
+  void SetBoundary(unsigned idx, const SearchPointVector &boundary,
+                   Serial serial) {
     assert(idx < num_stages);
 
     boundaries[idx] = &boundary;
+    serials[idx] = serial;
+  }
+
+  /**
+   * Enable or disable the incremental mode.
+   */
+  void SetIncremental(bool _incremental) {
+    incremental = _incremental;
+    Invalidate();
+  }
+
+  bool IsIncremental() const {
+    return incremental;
+  }
+
+  /**
+   * Discard the cached results of the incremental mode.  This must be
+   * called when a #SearchPointVector previously passed to
+   * SetBoundary() is deleted.
+   */
+  void Invalidate() {
+    cached_num_stages = 0;
   }
 
   /**
@@ -91,6 +178,14 @@ protected:
 
   bool Run();
 
+  /**
+   * Perform the search in incremental mode.
+   *
+   * @param location the start location; if invalid, the search
+   * starts with zero-length edges to each point of the first stage
+   */
+  bool RunIncremental(const SearchPoint &location);
+
   bool Link(const ScanTaskPoint node, const ScanTaskPoint parent,
             unsigned value) {
     if (!is_min)
@@ -147,6 +242,14 @@ private:
   gcc_pure
   unsigned GetStageSize(const unsigned stage) const;
 
+  gcc_pure
+  bool IsBetter(unsigned a, unsigned b) const {
+    return is_min ? a < b : a > b;
+  }
+
+  void CalculateForward(unsigned stage, const SearchPoint &location);
+  void CalculateBackward(unsigned stage);
+
 protected:
   /* methods from NavDijkstra */
   virtual void AddEdges(ScanTaskPoint curNode) final;
@@ -25,6 +25,9 @@
 bool
 TaskDijkstraMax::DistanceMax()
 {
+  if (IsIncremental())
+    return RunIncremental(SearchPoint::Invalid());
+
   dijkstra.Clear();
   dijkstra.Reserve(256);
   AddZeroStartEdges();
@@ -25,6 +25,9 @@
 bool
 TaskDijkstraMin::DistanceMin(const SearchPoint &currentLocation)
 {
+  if (IsIncremental())
+    return RunIncremental(currentLocation);
+
   dijkstra.Clear();
   dijkstra.Reserve(256);
 
@@ -51,6 +51,7 @@ SampledTaskPoint::AddInsideSample(const AircraftState& state,
   // add sample to polygon
   SearchPoint sp(state.location, projection);
   sampled_points.push_back(sp);
+  ++search_serial;
 
   // re-compute convex hull
   bool retval = sampled_points.PruneInterior();
@@ -71,6 +72,7 @@ SampledTaskPoint::ClearSampleAllButLast(const AircraftState& ref_last,
     sampled_points.clear();
     SearchPoint sp(ref_last.location, projection);
     sampled_points.push_back(sp);
+    ++search_serial;
   }
 }
 
@@ -87,6 +89,8 @@ SampledTaskPoint::UpdateOZ(const FlatProjection &projection,
     boundary_points.push_back(sp);
 
   UpdateProjection(projection);
+  ++search_serial;
+  ++boundary_serial;
 }
 
 // SAMPLES + BOUNDARY
@@ -105,6 +109,7 @@ void
 SampledTaskPoint::Reset()
 {
   sampled_points.clear();
+  ++search_serial;
 }
 
 const SearchPointVector &
@@ -24,6 +24,7 @@
 #define SAMPLEDTASKPOINT_H
 
 #include "Geo/SearchPointVector.hpp"
+#include "Util/Serial.hpp"
 #include "Compiler.h"
 
 class FlatProjection;
@@ -61,6 +62,17 @@ class SampledTaskPoint {
   SearchPoint search_max;
   SearchPoint search_min;
 
+  /**
+   * Incremented each time the result of GetSearchPoints() changes.
+   */
+  Serial search_serial;
+
+  /**
+   * Incremented each time #boundary_points and #nominal_points
+   * change.
+   */
+  Serial boundary_serial;
+
 public:
   /**
    * Constructor.  Clears boundary and interior samples on
@@ -172,7 +184,10 @@ public:
 
 protected:
   void SetPast(bool _past) {
-    past = _past;
+    if (_past != past) {
+      past = _past;
+      ++search_serial;
+    }
   }
 
   /**
@@ -205,6 +220,22 @@ public:
   gcc_pure
   const SearchPointVector &GetSearchPoints() const;
 
+  /**
+   * Returns a #Serial which changes each time the result of
+   * GetSearchPoints() changes.
+   */
+  Serial GetSearchPointsSerial() const {
+    return search_serial;
+  }
+
+  /**
+   * Returns a #Serial which changes each time the result of
+   * GetBoundaryPoints() or GetNominalPoints() changes.
+   */
+  Serial GetBoundaryPointsSerial() const {
+    return boundary_serial;
+  }
+
   /**
    * Set the location of the sample/boundary polygon node
    * that produces the maximum task distance.
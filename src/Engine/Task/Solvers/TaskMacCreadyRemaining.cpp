@@ -25,23 +25,79 @@
 #include "GlideSolvers/MacCready.hpp"
 #include "Task/Points/TaskPoint.hpp"
 #include "Task/Ordered/Points/AATPoint.hpp"
+#include "Navigation/Aircraft.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
 
 GlideResult
-TaskMacCreadyRemaining::SolvePoint(const TaskPoint &tp,
-                                   const AircraftState &aircraft,
-                                   double minH) const
+TaskMacCreadyRemaining::SolveVector(const TaskPoint &tp, GeoVector vector,
+                                    const AircraftState &aircraft,
+                                    double minH) const
 {
-  GlideState gs = GlideState::Remaining(tp, aircraft, minH);
-
   if (!include_travel_to_start && active_index == 0 &&
       tp.GetType() == TaskPointType::START &&
       !((const OrderedTaskPoint &)tp).HasEntered())
     /* ignore the travel to the start point */
-    gs.vector.distance = 0;
+    vector.distance = 0;
 
+  const GlideState gs(vector, std::max(minH, tp.GetElevation()),
+                      aircraft.altitude, aircraft.wind);
   return MacCready::Solve(settings, glide_polar, gs);
 }
 
+GlideResult
+TaskMacCreadyRemaining::SolvePoint(const TaskPoint &tp,
+                                   const AircraftState &aircraft,
+                                   double minH) const
+{
+  assert(aircraft.location.IsValid());
+
+  return SolveVector(tp, tp.GetVectorRemaining(aircraft.location),
+                     aircraft, minH);
+}
+
+void
+TaskMacCreadyRemaining::get_vectors(LegVectors &vectors,
+                                    const GeoPoint &location) const
+{
+  auto vector = vectors.begin();
+  for (const TaskPoint *point : points)
+    *vector++ = point->GetVectorRemaining(location);
+}
+
+GlideResult
+TaskMacCreadyRemaining::glide_solution(const AircraftState &aircraft,
+                                       const LegVectors &vectors) const
+{
+  /* this is TaskMacCready::glide_solution() without the side
+     effects */
+  const auto aircraft_min_height = get_min_height(aircraft);
+  GlideResult acc_gr;
+  auto aircraft_predict = get_aircraft_start(aircraft);
+
+  for (unsigned i = 0, size = points.size(); i < size; ++i) {
+    const auto tp_min_height = std::max(aircraft_min_height,
+                                        points[i]->GetElevation());
+
+    const auto gr = SolveVector(*points[i], vectors[i],
+                                aircraft_predict, tp_min_height);
+
+    if (i == 0)
+      acc_gr = gr;
+    else
+      acc_gr.Add(gr);
+
+    aircraft_predict.altitude = tp_min_height;
+    if (gr.altitude_difference > 0)
+      aircraft_predict.altitude += gr.altitude_difference;
+  }
+
+  acc_gr.CalcDeferred();
+  return acc_gr;
+}
+
 
 AircraftState
 TaskMacCreadyRemaining::get_aircraft_start(const AircraftState &aircraft) const
@@ -24,6 +24,7 @@
 
 #include "TaskMacCready.hpp"
 #include "Geo/GeoPoint.hpp"
+#include "Geo/GeoVector.hpp"
 
 /**
  * Specialisation of TaskMacCready for task remaining
@@ -40,6 +41,11 @@ class TaskMacCreadyRemaining final : public TaskMacCready {
   std::array<GeoPoint, MAX_SIZE> saved_targets;
 
 public:
+  /**
+   * One remaining leg vector per task point, see glide_solution().
+   */
+  typedef std::array<GeoVector, MAX_SIZE> LegVectors;
+
   /**
    * Constructor for ordered task points
    *
@@ -82,6 +88,31 @@ public:
   gcc_pure
   bool has_targets() const;
 
+  /**
+   * Copy the remaining leg vectors which were calculated by the last
+   * ScanDistanceRemaining() call.
+   */
+  void get_vectors(LegVectors &vectors,
+                   const GeoPoint &location) const;
+
+  using TaskMacCready::glide_solution;
+
+  /**
+   * Calculate the glide solution along the given remaining leg
+   * vectors instead of the ones stored in the task points.  Unlike
+   * glide_solution(const AircraftState &), this method does not
+   * modify anything and may be called by several threads
+   * concurrently.
+   *
+   * @param aircraft Aircraft state
+   * @param vectors One vector per task point, see get_vectors()
+   *
+   * @return Glide result for entire task
+   */
+  gcc_pure
+  GlideResult glide_solution(const AircraftState &aircraft,
+                             const LegVectors &vectors) const;
+
   /**
    * Save targets in case optimisation fails
    */
@@ -92,6 +123,11 @@ public:
   void target_restore();
 
 private:
+  gcc_pure
+  GlideResult SolveVector(const TaskPoint &tp, GeoVector vector,
+                          const AircraftState &aircraft,
+                          double minH) const;
+
   /* virtual methods from class TaskMacCready */
   double get_min_height(gcc_unused const AircraftState &aircraft) const override {
     return 0;
@@ -26,6 +26,25 @@
 #include "Util/Tolerances.hpp"
 #include "Util/Clamp.hpp"
 
+#include <array>
+#include <algorithm>
+
+/**
+ * Minimum search for TaskOptTarget::Evaluate() within a section of
+ * the isoline.
+ */
+class TaskOptTarget::Refine final : public ZeroFinder {
+  const TaskOptTarget &parent;
+
+public:
+  Refine(const TaskOptTarget &_parent, double _xmin, double _xmax)
+    :ZeroFinder(_xmin, _xmax, TOLERANCE_OPT_TARGET), parent(_parent) {}
+
+  double f(double p) override {
+    return parent.Evaluate(p).time_elapsed;
+  }
+};
+
 TaskOptTarget::TaskOptTarget(const std::vector<OrderedTaskPoint*>& tps,
                              const unsigned activeTaskPoint,
                              const AircraftState &_aircraft,
@@ -72,7 +91,9 @@ TaskOptTarget::search(const double tp)
   }
   if (iso.IsValid()) {
     tm.target_save();
-    const auto t = find_min(tp);
+    auto t = SearchBatch();
+    if (t < 0)
+      t = find_min(tp);
     if (!valid(t)) {
       // invalid, so restore old value
       tm.target_restore();
@@ -92,3 +113,49 @@ TaskOptTarget::SetTarget(const double p)
   tp_current.SetTarget(loc);
   tp_start->ScanDistanceRemaining(aircraft.location);
 }
+
+GlideResult
+TaskOptTarget::Evaluate(const double p) const
+{
+  const GeoPoint target = iso.Parametric(Clamp(p, xmin, xmax));
+
+  /* only the legs to and from the active target are affected */
+  auto v = vectors;
+  v[0] = GeoVector(aircraft.location, target);
+
+  const OrderedTaskPoint *next = tp_current.GetNext();
+  if (next != nullptr)
+    v[1] = GeoVector(target, next->GetLocationRemaining());
+
+  return tm.glide_solution(aircraft, v);
+}
+
+double
+TaskOptTarget::SearchBatch()
+{
+  if (!aircraft.location.IsValid())
+    return -1;
+
+  tp_start->ScanDistanceRemaining(aircraft.location);
+  tm.get_vectors(vectors, aircraft.location);
+
+  const double step = (xmax - xmin) / (N_CANDIDATES - 1);
+
+  std::array<double, N_CANDIDATES> times;
+  for (unsigned i = 0; i < N_CANDIDATES; ++i) {
+    const GlideResult result = Evaluate(xmin + i * step);
+    times[i] = result.IsOk() ? result.time_elapsed : -1;
+  }
+
+  int best = -1;
+  for (unsigned i = 0; i < N_CANDIDATES; ++i)
+    if (times[i] >= 0 && (best < 0 || times[i] < times[best]))
+      best = i;
+
+  if (best < 0)
+    return -1;
+
+  const double p = xmin + best * step;
+  Refine refine(*this, std::max(p - step, xmin), std::min(p + step, xmax));
+  return refine.find_min(p);
+}
@@ -41,6 +41,14 @@ class StartPoint;
  */
 class TaskOptTarget final : public ZeroFinder
 {
+  /**
+   * The number of evenly spaced isoline parameters which are
+   * evaluated in one batch before the search is refined.
+   */
+  static constexpr unsigned N_CANDIDATES = 9;
+
+  class Refine;
+
   /** Object to calculate remaining task statistics */
   TaskMacCreadyRemaining tm;
   /** Glide solution used in search */
@@ -54,6 +62,12 @@ class TaskOptTarget final : public ZeroFinder
   /** Isoline for active AATPoint target */
   AATIsolineSegment iso;
 
+  /**
+   * The remaining leg vectors with the current targets; the first
+   * two are replaced for each candidate by Evaluate().
+   */
+  TaskMacCreadyRemaining::LegVectors vectors;
+
 public:
   /**
    * Constructor for ordered task points
@@ -99,6 +113,23 @@ public:
 private:
   /** Sets target location along isoline */
   void SetTarget(double p);
+
+  /**
+   * Calculate the remaining task with the target at the given
+   * isoline parameter, without moving the target.
+   */
+  gcc_pure
+  GlideResult Evaluate(double p) const;
+
+  /**
+   * Evaluate #N_CANDIDATES evenly spaced parameters as one batch and
+   * refine the best one with a minimum search between its
+   * neighbours.
+   *
+   * @return Isoline value for solution, or a negative value if no
+   * candidate is valid
+   */
+  double SearchBatch();
 };
 
 
@@ -0,0 +1,176 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TRACE_POINT_ARRAYS_HPP
+#define XCSOAR_TRACE_POINT_ARRAYS_HPP
+
+#include "Vector.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <algorithm>
+
+#include <assert.h>
+#include <math.h>
+
+/**
+ * A copy of the fields of a #TracePointVector which are scanned by
+ * the contest solvers in their inner loops, stored as separate
+ * ("struct of arrays") vectors.  Walking over a range of flat
+ * locations this way touches only the bytes that are actually used,
+ * instead of loading a whole #TracePoint per index.
+ */
+class TracePointArrays {
+  std::vector<int> x, y;
+  std::vector<unsigned> time;
+  std::vector<int> altitude;
+
+public:
+  unsigned size() const {
+    return x.size();
+  }
+
+  void clear() {
+    x.clear();
+    y.clear();
+    time.clear();
+    altitude.clear();
+  }
+
+  void reserve(unsigned n) {
+    x.reserve(n);
+    y.reserve(n);
+    time.reserve(n);
+    altitude.reserve(n);
+  }
+
+  /**
+   * Returns the number of bytes allocated by this object.
+   */
+  gcc_pure
+  size_t GetMemory() const {
+    return (x.capacity() + y.capacity() + altitude.capacity()) * sizeof(int) +
+      time.capacity() * sizeof(unsigned);
+  }
+
+  /**
+   * Append copies of the given points.
+   */
+  void Append(TracePointVector::const_iterator begin,
+              TracePointVector::const_iterator end) {
+    for (auto i = begin; i != end; ++i) {
+      const TracePoint &point = *i;
+      x.push_back(point.GetFlatLocation().x);
+      y.push_back(point.GetFlatLocation().y);
+      time.push_back(point.GetTime());
+      altitude.push_back(point.GetIntegerAltitude());
+    }
+  }
+
+  gcc_pure
+  FlatGeoPoint GetFlatLocation(unsigned i) const {
+    assert(i < size());
+
+    return FlatGeoPoint(x[i], y[i]);
+  }
+
+  gcc_pure
+  unsigned GetTime(unsigned i) const {
+    assert(i < size());
+
+    return time[i];
+  }
+
+  gcc_pure
+  int GetIntegerAltitude(unsigned i) const {
+    assert(i < size());
+
+    return altitude[i];
+  }
+
+  /**
+   * Calculate the flat distance between two points.  The result is
+   * the same as FlatGeoPoint::Distance(), but this version can be
+   * inlined.
+   */
+  gcc_pure
+  unsigned FlatDistance(unsigned a, unsigned b) const {
+    assert(a < size());
+    assert(b < size());
+
+    return Hypot(x[a] - x[b], y[a] - y[b]);
+  }
+
+  /**
+   * Calculate the flat distances from #origin to all points in the
+   * range [first, last), and store them in #dest.
+   */
+  void CalcFlatDistances(FlatGeoPoint origin, unsigned first, unsigned last,
+                         unsigned *gcc_restrict dest) const {
+    assert(first <= last);
+    assert(last <= size());
+
+    const int *gcc_restrict px = x.data() + first;
+    const int *gcc_restrict py = y.data() + first;
+    const unsigned n = last - first;
+    for (unsigned i = 0; i < n; ++i)
+      dest[i] = Hypot(px[i] - origin.x, py[i] - origin.y);
+  }
+
+  /**
+   * Calculate the bounding box of all points in the (non-empty)
+   * range [first, last).
+   */
+  gcc_pure
+  FlatBoundingBox GetBoundingBox(unsigned first, unsigned last) const {
+    assert(first < last);
+    assert(last <= size());
+
+    int min_x = x[first], max_x = min_x;
+    int min_y = y[first], max_y = min_y;
+    for (unsigned i = first + 1; i < last; ++i) {
+      min_x = std::min(min_x, x[i]);
+      max_x = std::max(max_x, x[i]);
+      min_y = std::min(min_y, y[i]);
+      max_y = std::max(max_y, y[i]);
+    }
+
+    return FlatBoundingBox(FlatGeoPoint(min_x, min_y),
+                           FlatGeoPoint(max_x, max_y));
+  }
+
+private:
+  /**
+   * Equivalent to ihypot(), which rounds down just like this
+   * conversion does.
+   */
+  gcc_const
+  static unsigned Hypot(int dx, int dy) {
+    const unsigned sq = unsigned(dx) * unsigned(dx) + unsigned(dy) * unsigned(dy);
+    return (unsigned)sqrt((double)sq);
+  }
+};
+
+#endif
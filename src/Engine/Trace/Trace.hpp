@@ -390,6 +390,15 @@ public:
    */
   bool SyncPoints(TracePointerVector &v) const;
 
+  /**
+   * Update the given #TracePointVector after points were appended to
+   * this object.  This must not be called after thinning has
+   * occurred, see GetModifySerial().
+   *
+   * @return true if new points were added
+   */
+  bool SyncPoints(TracePointVector &v) const;
+
   /**
    * Fill the vector with trace points, not before #min_time, minimum
    * resolution #min_distance.
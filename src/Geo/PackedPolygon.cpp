@@ -0,0 +1,135 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "PackedPolygon.hpp"
+#include "GeoPoint.hpp"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void
+PackedPolygon::Import(const SearchPointVector &src)
+{
+  longitudes.clear();
+  latitudes.clear();
+  longitudes.reserve(src.size());
+  latitudes.reserve(src.size());
+
+  min_latitude = max_latitude = 0;
+
+  for (const auto &i : src) {
+    const GeoPoint &location = i.GetLocation();
+    longitudes.push_back(location.longitude.Native());
+    latitudes.push_back(location.latitude.Native());
+  }
+
+  if (!latitudes.empty()) {
+    const auto minmax = std::minmax_element(latitudes.begin(),
+                                            latitudes.end());
+    min_latitude = *minmax.first;
+    max_latitude = *minmax.second;
+  }
+}
+
+/**
+ * The contribution of the edge (x0,y0)-(x1,y1) to the winding
+ * number.  This is the same arithmetic as in PolygonInterior(), only
+ * without branches.
+ */
+static inline int
+EdgeWinding(double x0, double y0, double x1, double y1,
+            double px, double py)
+{
+  const double cross = (x1 - x0) * (py - y0) - (px - x0) * (y1 - y0);
+  const bool start_below = y0 <= py, end_below = y1 <= py;
+
+  return int(start_below && !end_below && cross > 0)
+    - int(!start_below && end_below && cross < 0);
+}
+
+bool
+PackedPolygon::IsInside(const GeoPoint &p) const
+{
+  const unsigned n = size();
+  if (n < 3)
+    return false;
+
+  const double px = p.longitude.Native(), py = p.latitude.Native();
+
+  /* no edge can cross the horizontal through a point which is below
+     all vertices or at/above the highest one */
+  if (py < min_latitude || py >= max_latitude)
+    return false;
+
+  const double *const x = longitudes.data(), *const y = latitudes.data();
+
+  /* edge i goes from vertex i to vertex i+1 */
+  const unsigned n_edges = n - 1;
+  unsigned i = 0;
+  int wn = 0;
+
+#ifdef __SSE2__
+  /* two edges per iteration */
+
+  const __m128d px2 = _mm_set1_pd(px), py2 = _mm_set1_pd(py);
+  const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1);
+  __m128d wn2 = zero;
+
+  for (; i + 2 <= n_edges; i += 2) {
+    const __m128d x0 = _mm_loadu_pd(x + i), x1 = _mm_loadu_pd(x + i + 1);
+    const __m128d y0 = _mm_loadu_pd(y + i), y1 = _mm_loadu_pd(y + i + 1);
+
+    const __m128d cross =
+      _mm_sub_pd(_mm_mul_pd(_mm_sub_pd(x1, x0), _mm_sub_pd(py2, y0)),
+                 _mm_mul_pd(_mm_sub_pd(px2, x0), _mm_sub_pd(y1, y0)));
+
+    const __m128d start_below = _mm_cmple_pd(y0, py2);
+    const __m128d end_below = _mm_cmple_pd(y1, py2);
+
+    /* upward crossing with the point left of the edge */
+    const __m128d up =
+      _mm_andnot_pd(end_below,
+                    _mm_and_pd(start_below, _mm_cmpgt_pd(cross, zero)));
+
+    /* downward crossing with the point right of the edge */
+    const __m128d down =
+      _mm_andnot_pd(start_below,
+                    _mm_and_pd(end_below, _mm_cmplt_pd(cross, zero)));
+
+    wn2 = _mm_add_pd(wn2, _mm_sub_pd(_mm_and_pd(up, one),
+                                     _mm_and_pd(down, one)));
+  }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, wn2);
+  wn = int(lanes[0] + lanes[1]);
+#endif
+
+  for (; i < n_edges; ++i)
+    wn += EdgeWinding(x[i], y[i], x[i + 1], y[i + 1], px, py);
+
+  return wn != 0;
+}
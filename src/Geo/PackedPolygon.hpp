@@ -0,0 +1,74 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_PACKED_POLYGON_HPP
+#define XCSOAR_GEO_PACKED_POLYGON_HPP
+
+#include "Geo/SearchPointVector.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+struct GeoPoint;
+
+/**
+ * A copy of the vertices of a closed polygon in "structure of
+ * arrays" layout: all longitudes and all latitudes are stored in two
+ * contiguous arrays (in radians).  This makes IsInside() touch only
+ * 16 bytes per vertex instead of a whole #SearchPoint, and allows
+ * testing several edges per instruction.
+ *
+ * The result is the same as PolygonInterior() on the source
+ * #SearchPointVector.
+ */
+class PackedPolygon {
+  std::vector<double> longitudes, latitudes;
+
+  double min_latitude, max_latitude;
+
+public:
+  PackedPolygon() = default;
+
+  explicit PackedPolygon(const SearchPointVector &src) {
+    Import(src);
+  }
+
+  /**
+   * Copy the vertices of the given polygon, which must be closed
+   * (i.e. the last point equals the first one).
+   */
+  void Import(const SearchPointVector &src);
+
+  unsigned size() const {
+    return longitudes.size();
+  }
+
+  /**
+   * Winding number test; equivalent to
+   * SearchPointVector::IsInside(const GeoPoint &).
+   */
+  gcc_pure
+  bool IsInside(const GeoPoint &p) const;
+};
+
+#endif
@@ -35,13 +35,15 @@ class FileCache {
 public:
   FileCache(AllocatedPath &&_cache_path);
 
-protected:
+  /**
+   * Returns the path of the specified cache file.  This may be used
+   * to memory-map a file after it has been validated with Load().
+   */
   gcc_pure
   AllocatedPath MakeCachePath(const TCHAR *name) const {
     return AllocatedPath::Build(cache_path, name);
   }
 
-public:
   void Flush(const TCHAR *name);
   FILE *Load(const TCHAR *name, Path original_path);
 
@@ -221,6 +221,11 @@ public:
   }
 
   void SetTopography(TopographyStore *_topography);
+
+  const CachedTopographyRenderer *GetTopographyRenderer() const {
+    return topography_renderer;
+  }
+
   void SetTerrain(RasterTerrain *_terrain);
 
   const std::shared_ptr<RaspStore> &GetRasp() const {
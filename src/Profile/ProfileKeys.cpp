@@ -196,6 +196,7 @@ const char DisableAutoLogger[] = "DisableAutoLogger";
 const char EnableFlightLogger[] = "EnableFlightLogger";
 const char EnableNMEALogger[] = "EnableNMEALogger";
 const char MapFile[] = "MapFile"; // pL
+const char TerrainTileStore[] = "TerrainTileStore";
 const char BallastSecsToEmpty[] = "BallastSecsToEmpty";
 const char DialogFont[] = "DialogFont";
 const char FontInfoWindowFont[] = "InfoWindowFont";
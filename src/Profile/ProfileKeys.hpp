@@ -192,6 +192,7 @@ extern const char DisableAutoLogger[];
 extern const char EnableFlightLogger[];
 extern const char EnableNMEALogger[];
 extern const char MapFile[];
+extern const char TerrainTileStore[];
 extern const char BallastSecsToEmpty[];
 extern const char AccelerometerZero[];
 extern const char DialogFont[];
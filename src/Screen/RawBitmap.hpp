@@ -161,6 +161,17 @@ public:
 #endif
   }
 
+  /**
+   * Returns a pointer to the specified row.
+   */
+  RawColor *GetRow(unsigned y) {
+#ifndef USE_GDI
+    return GetBuffer() + y * corrected_width;
+#else
+    return GetTopRow() - y * corrected_width;
+#endif
+  }
+
   /**
    * Returns a pointer to the row below the current one.
    */
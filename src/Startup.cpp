@@ -356,7 +356,8 @@ Startup()
   rasp->ScanAll();
 
   // Reads the airspace files
-  ReadAirspace(airspace_database, terrain, computer_settings.pressure,
+  ReadAirspace(airspace_database, file_cache,
+               terrain, computer_settings.pressure,
                operation);
 
   {
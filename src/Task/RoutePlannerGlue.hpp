@@ -53,6 +53,11 @@ public:
                    const AGeoPoint &origin,
                    const AGeoPoint &destination);
 
+  void SetParallel(const ParallelRunFunction &parallel_run,
+                   unsigned n_workers) {
+    planner.SetParallel(parallel_run, n_workers);
+  }
+
   bool IsTerrainReachEmpty() const {
     return planner.IsTerrainReachEmpty();
   }
@@ -0,0 +1,232 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_BILINEAR_HPP
+#define XCSOAR_TERRAIN_BILINEAR_HPP
+
+#include "Height.hpp"
+#include "Compiler.h"
+
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+/**
+ * The input of a batch of bilinear height interpolations: the four
+ * corner heights of each sample (top left, top right, bottom left,
+ * bottom right) and the sub-pixel position (0..255) within the
+ * square.  This is a structure of arrays, to allow loading each
+ * column into a SIMD register.
+ */
+template<unsigned N>
+struct BilinearBatch {
+  static constexpr unsigned SIZE = N;
+
+  int32_t a[N], b[N], c[N], d[N];
+  uint32_t ix[N], iy[N];
+};
+
+/**
+ * Portable implementation of the bilinear interpolation.  It
+ * produces exactly the same results as
+ * RasterBuffer::GetInterpolated().
+ */
+struct PortableBilinear {
+  static constexpr int32_t SPECIAL_THRESHOLD = -30000;
+
+  gcc_always_inline
+  static TerrainHeight Interpolate(int32_t a, int32_t b,
+                                   int32_t c, int32_t d,
+                                   unsigned ix, unsigned iy) {
+    if (a <= SPECIAL_THRESHOLD || b <= SPECIAL_THRESHOLD ||
+        c <= SPECIAL_THRESHOLD || d <= SPECIAL_THRESHOLD)
+      return TerrainHeight(a);
+
+    const unsigned kx = 0x100 - ix;
+    const unsigned ky = 0x100 - iy;
+
+    return TerrainHeight((a * kx * ky + b * ix * ky
+                          + c * kx * iy + d * ix * iy) >> 16);
+  }
+
+  static void Interpolate(const int32_t *a, const int32_t *b,
+                          const int32_t *c, const int32_t *d,
+                          const uint32_t *ix, const uint32_t *iy,
+                          TerrainHeight *gcc_restrict dest, unsigned n) {
+    for (unsigned i = 0; i < n; ++i)
+      dest[i] = Interpolate(a[i], b[i], c[i], d[i], ix[i], iy[i]);
+  }
+};
+
+#ifdef __SSE2__
+
+/**
+ * SSE2 implementation of the bilinear interpolation, 4 samples per
+ * iteration.
+ */
+struct SSE2Bilinear {
+  static constexpr unsigned STEP = 4;
+
+  /**
+   * SSE2 lacks a 32 bit multiplication which keeps the lower 32
+   * bits (pmulld is SSE4.1); emulate it with two pmuludq.
+   */
+  gcc_always_inline
+  static __m128i MulLo32(__m128i x, __m128i y) {
+    __m128i even = _mm_mul_epu32(x, y);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(x, 4), _mm_srli_si128(y, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+  }
+
+  static void Interpolate(const int32_t *a, const int32_t *b,
+                          const int32_t *c, const int32_t *d,
+                          const uint32_t *ix, const uint32_t *iy,
+                          TerrainHeight *gcc_restrict dest, unsigned n) {
+    const __m128i one = _mm_set1_epi32(0x100);
+    const __m128i special =
+      _mm_set1_epi32(PortableBilinear::SPECIAL_THRESHOLD + 1);
+
+    for (unsigned i = 0; i < n; i += STEP) {
+      const __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+      const __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+      const __m128i vc = _mm_loadu_si128((const __m128i *)(c + i));
+      const __m128i vd = _mm_loadu_si128((const __m128i *)(d + i));
+      const __m128i vix = _mm_loadu_si128((const __m128i *)(ix + i));
+      const __m128i viy = _mm_loadu_si128((const __m128i *)(iy + i));
+
+      const __m128i vkx = _mm_sub_epi32(one, vix);
+      const __m128i vky = _mm_sub_epi32(one, viy);
+
+      /* the weights fit in 16 bits each, so their product can be
+         calculated with a 16x16 bit multiplication */
+      const __m128i w_a = _mm_madd_epi16(vkx, vky);
+      const __m128i w_b = _mm_madd_epi16(vix, vky);
+      const __m128i w_c = _mm_madd_epi16(vkx, viy);
+      const __m128i w_d = _mm_madd_epi16(vix, viy);
+
+      __m128i sum = MulLo32(va, w_a);
+      sum = _mm_add_epi32(sum, MulLo32(vb, w_b));
+      sum = _mm_add_epi32(sum, MulLo32(vc, w_c));
+      sum = _mm_add_epi32(sum, MulLo32(vd, w_d));
+      sum = _mm_srai_epi32(sum, 16);
+
+      /* fall back to the top left corner if one of the corners is
+         "special" (invalid or water) */
+      __m128i mask = _mm_cmplt_epi32(va, special);
+      mask = _mm_or_si128(mask, _mm_cmplt_epi32(vb, special));
+      mask = _mm_or_si128(mask, _mm_cmplt_epi32(vc, special));
+      mask = _mm_or_si128(mask, _mm_cmplt_epi32(vd, special));
+
+      const __m128i result = _mm_or_si128(_mm_and_si128(mask, va),
+                                          _mm_andnot_si128(mask, sum));
+
+      const __m128i packed = _mm_packs_epi32(result, result);
+      _mm_storel_epi64((__m128i *)(dest + i), packed);
+    }
+  }
+};
+
+typedef SSE2Bilinear OptimisedBilinear;
+
+#elif defined(__ARM_NEON__)
+
+/**
+ * ARM NEON implementation of the bilinear interpolation, 4 samples
+ * per iteration.
+ */
+struct NEONBilinear {
+  static constexpr unsigned STEP = 4;
+
+  static void Interpolate(const int32_t *a, const int32_t *b,
+                          const int32_t *c, const int32_t *d,
+                          const uint32_t *ix, const uint32_t *iy,
+                          TerrainHeight *gcc_restrict dest, unsigned n) {
+    const uint32x4_t one = vdupq_n_u32(0x100);
+    const int32x4_t special =
+      vdupq_n_s32(PortableBilinear::SPECIAL_THRESHOLD + 1);
+
+    for (unsigned i = 0; i < n; i += STEP) {
+      const int32x4_t va = vld1q_s32(a + i);
+      const int32x4_t vb = vld1q_s32(b + i);
+      const int32x4_t vc = vld1q_s32(c + i);
+      const int32x4_t vd = vld1q_s32(d + i);
+      const uint32x4_t vix = vld1q_u32(ix + i);
+      const uint32x4_t viy = vld1q_u32(iy + i);
+
+      const uint32x4_t vkx = vsubq_u32(one, vix);
+      const uint32x4_t vky = vsubq_u32(one, viy);
+
+      uint32x4_t sum = vmulq_u32(vreinterpretq_u32_s32(va),
+                                 vmulq_u32(vkx, vky));
+      sum = vmlaq_u32(sum, vreinterpretq_u32_s32(vb), vmulq_u32(vix, vky));
+      sum = vmlaq_u32(sum, vreinterpretq_u32_s32(vc), vmulq_u32(vkx, viy));
+      sum = vmlaq_u32(sum, vreinterpretq_u32_s32(vd), vmulq_u32(vix, viy));
+      const int32x4_t interpolated =
+        vshrq_n_s32(vreinterpretq_s32_u32(sum), 16);
+
+      uint32x4_t mask = vcltq_s32(va, special);
+      mask = vorrq_u32(mask, vcltq_s32(vb, special));
+      mask = vorrq_u32(mask, vcltq_s32(vc, special));
+      mask = vorrq_u32(mask, vcltq_s32(vd, special));
+
+      const int32x4_t result = vbslq_s32(mask, va, interpolated);
+      vst1_s16((int16_t *)(dest + i), vmovn_s32(result));
+    }
+  }
+};
+
+typedef NEONBilinear OptimisedBilinear;
+
+#endif
+
+/**
+ * Interpolate a batch of heights, using the optimised implementation
+ * as much as possible, and the portable one for the remainder.
+ */
+template<unsigned N>
+static inline void
+InterpolateHeights(const BilinearBatch<N> &batch,
+                   TerrainHeight *gcc_restrict dest, unsigned n)
+{
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+  const unsigned no = n & ~(OptimisedBilinear::STEP - 1);
+  OptimisedBilinear::Interpolate(batch.a, batch.b, batch.c, batch.d,
+                                 batch.ix, batch.iy, dest, no);
+#else
+  const unsigned no = 0;
+#endif
+
+  PortableBilinear::Interpolate(batch.a + no, batch.b + no,
+                                batch.c + no, batch.d + no,
+                                batch.ix + no, batch.iy + no,
+                                dest + no, n - no);
+}
+
+#endif
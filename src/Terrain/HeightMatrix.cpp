@@ -26,11 +26,14 @@ Copyright_License {
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
+#include "Screen/Point.hpp"
 #else
 #include "Projection/WindowProjection.hpp"
 #endif
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 void
 HeightMatrix::SetSize(size_t _size)
@@ -75,6 +78,29 @@ HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
   }
 }
 
+void
+HeightMatrix::FillRectangle(const RasterMap &map, const GeoBounds &bounds,
+                            const PixelRect &rc, bool interpolate)
+{
+  assert(rc.left >= 0 && rc.right <= (int)width);
+  assert(rc.top >= 0 && rc.bottom <= (int)height);
+  assert(rc.right - rc.left >= 2);
+
+  /* RasterMap::ScanLine() includes both end points, therefore the
+     distance between two columns is the width divided by (width-1) */
+  const Angle delta_x = bounds.GetWidth() / (width - 1);
+  const Angle delta_y = bounds.GetHeight() / height;
+  const Angle west = bounds.GetWest() + delta_x * rc.left;
+  const Angle east = bounds.GetWest() + delta_x * (rc.right - 1);
+
+  for (int y = rc.top; y < rc.bottom; ++y) {
+    const Angle latitude = bounds.GetNorth() - delta_y * y;
+    map.ScanLine(GeoPoint(west, latitude), GeoPoint(east, latitude),
+                 data.begin() + y * width + rc.left, rc.right - rc.left,
+                 interpolate);
+  }
+}
+
 #else
 
 void
@@ -97,3 +123,27 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
 }
 
 #endif
+
+void
+HeightMatrix::Shift(int dx, int dy)
+{
+  assert((unsigned)abs(dx) < width);
+  assert((unsigned)abs(dy) < height);
+
+  const unsigned n = width - abs(dx);
+  const unsigned src_x = dx > 0 ? dx : 0;
+  const unsigned dest_x = dx > 0 ? 0 : -dx;
+  const unsigned n_rows = height - abs(dy);
+
+  if (dy >= 0) {
+    for (unsigned y = 0; y < n_rows; ++y)
+      memmove(data.begin() + y * width + dest_x,
+              data.begin() + (y + dy) * width + src_x,
+              n * sizeof(data[0]));
+  } else {
+    for (unsigned y = n_rows; y-- > 0;)
+      memmove(data.begin() + (y - dy) * width + dest_x,
+              data.begin() + y * width + src_x,
+              n * sizeof(data[0]));
+  }
+}
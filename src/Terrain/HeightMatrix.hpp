@@ -31,6 +31,7 @@ class RasterMap;
 
 #ifdef ENABLE_OPENGL
 class GeoBounds;
+struct PixelRect;
 #else
 class WindowProjection;
 #endif
@@ -57,6 +58,15 @@ public:
    */
   void Fill(const RasterMap &map, const GeoBounds &bounds,
             unsigned _width, unsigned _height, bool interpolate);
+
+  /**
+   * Copy values from the #RasterMap to a rectangle of the buffer.
+   * Each pixel gets the same location as in a Fill() call with the
+   * given bounds and the current size.  The rectangle must be at
+   * least two pixels wide.
+   */
+  void FillRectangle(const RasterMap &map, const GeoBounds &bounds,
+                     const PixelRect &rc, bool interpolate);
 #else
   /**
    * @param interpolate true enables interpolation of sub-pixel values
@@ -65,6 +75,13 @@ public:
             unsigned quantisation_pixels, bool interpolate);
 #endif
 
+  /**
+   * Move the contents of the buffer: the new value at (x, y) is the
+   * old value at (x + dx, y + dy).  Values which have no source are
+   * left undefined; the caller is responsible for filling them.
+   */
+  void Shift(int dx, int dy);
+
   unsigned GetWidth() const {
     return width;
   }
@@ -28,6 +28,9 @@ Copyright_License {
 #include "WorldFile.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/ConvertPathName.hpp"
+#include "Thread/Parallel.hpp"
+
+#include <atomic>
 
 extern "C" {
 #include "jasper/jp2/jp2_cod.h"
@@ -35,6 +38,13 @@ extern "C" {
 #include "jasper/jpc/jpc_t1cod.h"
 }
 
+inline bool
+TerrainLoader::IsWantedTile(unsigned index) const
+{
+  return raster_tile_cache.tiles.GetLinear(index).IsRequested() &&
+    index % n_workers == worker_index;
+}
+
 long
 TerrainLoader::SkipMarkerSegment(long file_offset) const
 {
@@ -54,8 +64,7 @@ TerrainLoader::SkipMarkerSegment(long file_offset) const
     return 0;
 
   long skip_to = segment->file_offset;
-  while (segment->IsTileSegment() &&
-         !raster_tile_cache.tiles.GetLinear(segment->tile).IsRequested()) {
+  while (segment->IsTileSegment() && !IsWantedTile(segment->tile)) {
     ++segment;
     if (segment >= raster_tile_cache.segments.end())
       /* last segment is hidden; shouldn't happen either, because we
@@ -176,7 +185,10 @@ TerrainLoader::PutTileData(unsigned index,
     raster_tile_cache.PutOverviewTile(index, start_x, start_y,
                                       end_x, end_y, m);
 
-  if (scan_tiles) {
+  if (store_writer != nullptr) {
+    if (IsWantedTile(index))
+      store_writer->PutTile(index, end_x - start_x, end_y - start_y, m);
+  } else if (scan_tiles && (scan_overview || IsWantedTile(index))) {
     const ScopeExclusiveLock lock(mutex);
     raster_tile_cache.PutTileData(index, m);
   }
@@ -224,7 +236,10 @@ LoadJPG2000(jas_stream_t *in, void *loader)
   opts.maxlyrs = JPC_MAXLYRS;
   opts.maxpkts = -1;
 
-  jpc_initluts();
+  /* the lookup tables are global; initialise them only once, because
+     other decoders may be reading them concurrently */
+  static const bool luts_initialised = (jpc_initluts(), true);
+  (void)luts_initialised;
 
   const auto dec = jpc_dec_create(&opts, in);
   if (dec == nullptr)
@@ -314,11 +329,39 @@ TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
     /* nothing to do */
     return true;
 
-  bool success = LoadJPG2000(dir, path);
+  bool success = DecodeRequestedTiles(dir, path);
   raster_tile_cache.FinishTileUpdate();
   return success;
 }
 
+bool
+TerrainLoader::DecodeRequestedTiles(struct zzip_dir *dir, const char *path)
+{
+  assert(!scan_overview);
+
+  return LoadJPG2000(dir, path);
+}
+
+inline bool
+TerrainLoader::DecodeAllTiles(struct zzip_dir *dir, const char *path)
+{
+  assert(!scan_overview);
+  assert(store_writer != nullptr);
+
+  /* request all tiles; they are passed to the #store_writer instead
+     of being kept in memory */
+  auto &tiles = raster_tile_cache.tiles;
+  for (auto &tile : tiles)
+    tile.SetRequest();
+
+  bool success = LoadJPG2000(dir, path);
+
+  for (auto &tile : tiles)
+    tile.ClearRequest();
+
+  return success;
+}
+
 bool
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
@@ -332,6 +375,72 @@ UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
   return loader.UpdateTiles(dir, path, x, y, radius);
 }
 
+bool
+BuildTerrainTileStore(struct zzip_dir *dir, const char *path,
+                      RasterTileCache &raster_tile_cache, FILE *file,
+                      OperationEnvironment &env)
+{
+  if (!raster_tile_cache.IsValid() || raster_tile_cache.HasStore())
+    return false;
+
+  RasterTileStore::Writer writer(file);
+  if (!writer.WriteHeader(raster_tile_cache))
+    return false;
+
+  SharedMutex mutex;
+  TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
+  loader.SetStoreWriter(writer);
+  bool success = loader.DecodeAllTiles(dir, path);
+  return writer.Finish() && success;
+}
+
+bool
+UpdateTerrainTiles(struct zzip_dir *const*dirs, unsigned n_dirs,
+                   const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   int x, int y, unsigned radius)
+{
+  assert(n_dirs > 0);
+
+  if (n_dirs == 1)
+    return UpdateTerrainTiles(dirs[0], path, raster_tile_cache, mutex,
+                              x, y, radius);
+
+  if (!raster_tile_cache.IsValid())
+    return false;
+
+  if (!raster_tile_cache.PollTiles(x, y, radius))
+    /* nothing to do */
+    return true;
+
+  std::atomic<bool> success(true);
+
+  ParallelRun(n_dirs, [&](unsigned i){
+      NullOperationEnvironment env;
+      TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
+      loader.SetWorker(i, n_dirs);
+      if (!loader.DecodeRequestedTiles(dirs[i], path))
+        success = false;
+    });
+
+  raster_tile_cache.FinishTileUpdate();
+  return success;
+}
+
+bool
+UpdateTerrainTiles(struct zzip_dir *const*dirs, unsigned n_dirs,
+                   const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius)
+{
+  const auto raster_location = projection.ProjectCoarse(location);
+
+  return UpdateTerrainTiles(dirs, n_dirs, path, raster_tile_cache, mutex,
+                            raster_location.x, raster_location.y,
+                            projection.DistancePixelsCoarse(radius));
+}
+
 bool
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
@@ -25,6 +25,10 @@ Copyright_License {
 #define XCSOAR_TERRAIN_LOADER_HPP
 
 #include "Thread/SharedMutex.hpp"
+#include "RasterTileStore.hpp"
+#include "Compiler.h"
+
+#include <stdio.h>
 
 struct zzip_dir;
 struct GeoPoint;
@@ -46,6 +50,19 @@ class TerrainLoader {
    */
   mutable unsigned remaining_segments = 0;
 
+  /**
+   * When tiles are decoded by several loaders concurrently, each
+   * one handles only the requested tiles whose index modulo
+   * #n_workers equals #worker_index.
+   */
+  unsigned worker_index = 0, n_workers = 1;
+
+  /**
+   * If set, then decoded tiles are written to this store instead of
+   * being copied into the #RasterTileCache.
+   */
+  RasterTileStore::Writer *store_writer = nullptr;
+
 public:
   TerrainLoader(SharedMutex &_mutex, RasterTileCache &_rtc,
                 bool _scan_overview, bool _scan_all,
@@ -55,11 +72,35 @@ public:
      scan_tiles(!_scan_overview || _scan_all),
      env(_env) {}
 
+  /**
+   * Restrict this loader to a subset of the requested tiles.  See
+   * #worker_index.
+   */
+  void SetWorker(unsigned _index, unsigned _n) {
+    worker_index = _index;
+    n_workers = _n;
+  }
+
+  void SetStoreWriter(RasterTileStore::Writer &_writer) {
+    store_writer = &_writer;
+  }
+
   bool LoadOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file);
   bool UpdateTiles(struct zzip_dir *dir, const char *path,
                    int x, int y, unsigned radius);
 
+  /**
+   * Decode the tiles which have been requested by
+   * RasterTileCache::PollTiles() (and which belong to this worker).
+   */
+  bool DecodeRequestedTiles(struct zzip_dir *dir, const char *path);
+
+  /**
+   * Decode all tiles and pass them to the #store_writer.
+   */
+  bool DecodeAllTiles(struct zzip_dir *dir, const char *path);
+
   /* callback methods for libjasper (via jas_rtc.cpp) */
 
   long SkipMarkerSegment(long file_offset) const;
@@ -79,6 +120,9 @@ public:
                    const struct jas_matrix &m);
 
 private:
+  gcc_pure
+  bool IsWantedTile(unsigned index) const;
+
   bool LoadJPG2000(struct zzip_dir *dir, const char *path);
   void ParseBounds(const char *data);
 };
@@ -118,6 +162,50 @@ UpdateTerrainTiles(struct zzip_dir *dir,
                             x, y, radius);
 }
 
+/**
+ * Decode all fine tiles of the map file and write them to a new
+ * #RasterTileStore.  The #RasterTileCache must have been loaded
+ * already (overview and tile layout).  This is a very expensive
+ * operation, which needs to be done only once per map file.
+ *
+ * @param file a file opened for writing, e.g. with FileCache::Save()
+ */
+bool
+BuildTerrainTileStore(struct zzip_dir *dir, const char *path,
+                      RasterTileCache &raster_tile_cache, FILE *file,
+                      OperationEnvironment &env);
+
+/**
+ * Like UpdateTerrainTiles(), but decode the requested tiles on
+ * several threads concurrently.  Independent marker segments are
+ * distributed over the workers, each of which runs its own JPEG2000
+ * decoder and publishes decoded tiles under the #mutex.
+ *
+ * zzip_dir is not thread-safe, therefore each worker needs its own
+ * handle on the same file; the number of workers equals #n_dirs.
+ */
+bool
+UpdateTerrainTiles(struct zzip_dir *const*dirs, unsigned n_dirs,
+                   const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   int x, int y, unsigned radius);
+
+static inline bool
+UpdateTerrainTiles(struct zzip_dir *const*dirs, unsigned n_dirs,
+                   RasterTileCache &tile_cache, SharedMutex &mutex,
+                   int x, int y, unsigned radius)
+{
+  return UpdateTerrainTiles(dirs, n_dirs, "terrain.jp2", tile_cache, mutex,
+                            x, y, radius);
+}
+
+bool
+UpdateTerrainTiles(struct zzip_dir *const*dirs, unsigned n_dirs,
+                   const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius);
+
 bool
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
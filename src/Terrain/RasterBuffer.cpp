@@ -22,6 +22,7 @@ Copyright_License {
 */
 
 #include "Terrain/RasterBuffer.hpp"
+#include "Terrain/Bilinear.hpp"
 #include "Math/FastMath.hpp"
 
 #include <algorithm>
@@ -34,6 +35,9 @@ RasterBuffer::Resize(unsigned _width, unsigned _height)
   assert(_width > 0 && _height > 0);
 
   data.GrowDiscard(_width, _height);
+  begin = data.begin();
+  width = _width;
+  height = _height;
 }
 
 TerrainHeight
@@ -80,6 +84,62 @@ RasterBuffer::GetInterpolated(unsigned lx, unsigned ly) const
   return GetInterpolated(lx, ly, ix, iy);
 }
 
+static constexpr unsigned BATCH_SIZE = 64;
+typedef BilinearBatch<BATCH_SIZE> RasterBufferBatch;
+
+/**
+ * Gather the corner heights for a batch of interpolations.
+ */
+static void
+FillBatch(RasterBufferBatch &batch,
+          const TerrainHeight *gcc_restrict data,
+          unsigned width, unsigned height,
+          const RasterLocation *gcc_restrict locations, unsigned n,
+          unsigned offset_x, unsigned offset_y)
+{
+  assert(n <= BATCH_SIZE);
+
+  for (unsigned i = 0; i < n; ++i) {
+    unsigned lx = locations[i].x - offset_x;
+    unsigned ly = locations[i].y - offset_y;
+    batch.ix[i] = CombinedDivAndMod(lx);
+    batch.iy[i] = CombinedDivAndMod(ly);
+
+    assert(lx < width);
+    assert(ly < height);
+
+    const unsigned dx = (lx == width - 1) ? 0 : 1;
+    const unsigned dy = (ly == height - 1) ? 0 : width;
+    const TerrainHeight *tm = data + ly * width + lx;
+
+    batch.a[i] = tm->GetValue();
+    batch.b[i] = tm[dx].GetValue();
+    batch.c[i] = tm[dy].GetValue();
+    batch.d[i] = tm[dx + dy].GetValue();
+  }
+}
+
+void
+RasterBuffer::GetInterpolated(const RasterLocation *gcc_restrict locations,
+                              TerrainHeight *gcc_restrict dest, unsigned n,
+                              unsigned offset_x, unsigned offset_y) const
+{
+  assert(IsDefined());
+
+  RasterBufferBatch batch;
+
+  while (n > 0) {
+    const unsigned chunk = std::min(n, BATCH_SIZE);
+    FillBatch(batch, begin, width, height, locations, chunk,
+              offset_x, offset_y);
+    InterpolateHeights(batch, dest, chunk);
+
+    locations += chunk;
+    dest += chunk;
+    n -= chunk;
+  }
+}
+
 /**
  * This class implements an algorithm to traverse pixels quickly with
  * only integer addition, no multiplication and division.
@@ -143,15 +203,16 @@ RasterBuffer::ScanHorizontalLine(unsigned ax, unsigned bx, unsigned y,
       (unsigned)abs(dx) < (2 * size << RasterTraits::SUBPIXEL_BITS)) {
     /* interpolate */
 
-    unsigned cy = y;
-    const unsigned int iy = CombinedDivAndMod(cy);
+    RasterLocation locations[BATCH_SIZE];
 
     --size;
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
-      const unsigned int ix = CombinedDivAndMod(cx);
+    for (unsigned i = 0; i <= size;) {
+      const unsigned chunk = std::min(size + 1 - i, BATCH_SIZE);
+      for (unsigned j = 0; j < chunk; ++j, ++i)
+        locations[j] = RasterLocation(ax + ((int)i * dx) / (int)size, y);
 
-      *buffer++ = GetInterpolated(cx, cy, ix, iy);
+      GetInterpolated(locations, buffer, chunk);
+      buffer += chunk;
     }
   } else if (gcc_likely(dx > 0)) {
     /* no interpolation needed, forward scan */
@@ -216,14 +277,16 @@ RasterBuffer::ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
       (unsigned)(abs(dx) + abs(dy)) < (2 * size << RasterTraits::SUBPIXEL_BITS)) {
     /* interpolate */
 
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
-      unsigned cy = ay + (i * dy) / (int)size;
+    RasterLocation locations[BATCH_SIZE];
 
-      const unsigned int ix = CombinedDivAndMod(cx);
-      const unsigned int iy = CombinedDivAndMod(cy);
+    for (unsigned i = 0; i <= size;) {
+      const unsigned chunk = std::min(size + 1 - i, BATCH_SIZE);
+      for (unsigned j = 0; j < chunk; ++j, ++i)
+        locations[j] = RasterLocation(ax + ((int)i * dx) / (int)size,
+                                      ay + ((int)i * dy) / (int)size);
 
-      *buffer++ = GetInterpolated(cx, cy, ix, iy);
+      GetInterpolated(locations, buffer, chunk);
+      buffer += chunk;
     }
   } else {
     /* no interpolation needed */
@@ -263,7 +326,7 @@ TerrainHeight
 RasterBuffer::GetMaximum() const
 {
   return IsDefined()
-    ? *std::max_element(data.begin(), data.end(),
+    ? *std::max_element(begin, begin + width * height,
                         [](TerrainHeight a, TerrainHeight b) {
                           return a.GetValue() < b.GetValue();
                         })
@@ -26,32 +26,51 @@ Copyright_License {
 
 #include "RasterTraits.hpp"
 #include "Height.hpp"
+#include "RasterLocation.hpp"
 #include "Util/AllocatedGrid.hxx"
 #include "Compiler.h"
 
+#include <assert.h>
 #include <stdint.h>
 
 class RasterBuffer {
   AllocatedGrid<TerrainHeight> data;
 
+  /**
+   * The first element of the buffer.  This points either into #data
+   * or (after SetExternal()) into read-only memory owned by somebody
+   * else, e.g. a memory-mapped #RasterTileStore.
+   */
+  const TerrainHeight *begin = nullptr;
+
+  unsigned width = 0, height = 0;
+
 public:
   RasterBuffer() = default;
   RasterBuffer(unsigned _width, unsigned _height)
-    :data(_width, _height) {}
+    :data(_width, _height), begin(data.begin()),
+     width(_width), height(_height) {}
 
   RasterBuffer(const RasterBuffer &) = delete;
   RasterBuffer &operator=(const RasterBuffer &) = delete;
 
   bool IsDefined() const {
-    return data.IsDefined();
+    return begin != nullptr;
+  }
+
+  /**
+   * Does this buffer refer to external memory?  See SetExternal().
+   */
+  bool IsExternal() const {
+    return begin != nullptr && !data.IsDefined();
   }
 
   unsigned GetWidth() const {
-    return data.GetWidth();
+    return width;
   }
 
   unsigned GetHeight() const {
-    return data.GetHeight();
+    return height;
   }
 
   unsigned GetFineWidth() const {
@@ -63,19 +82,42 @@ public:
   }
 
   TerrainHeight *GetData() {
+    assert(!IsExternal());
+
     return data.begin();
   }
 
   const TerrainHeight *GetData() const {
-    return data.begin();
+    return begin;
   }
 
   const TerrainHeight *GetDataAt(unsigned x, unsigned y) const {
-    return data.GetPointerAt(x, y);
+    assert(x < width);
+    assert(y < height);
+
+    return begin + y * width + x;
   }
 
   void Reset() {
     data.Reset();
+    begin = nullptr;
+    width = height = 0;
+  }
+
+  /**
+   * Refer to an existing (read-only) buffer instead of allocating
+   * one.  The caller is responsible for keeping the memory valid
+   * until Reset() is called.
+   */
+  void SetExternal(const TerrainHeight *_begin,
+                   unsigned _width, unsigned _height) {
+    assert(_begin != nullptr);
+    assert(_width > 0 && _height > 0);
+
+    data.Reset();
+    begin = _begin;
+    width = _width;
+    height = _height;
   }
 
   void Resize(unsigned _width, unsigned _height);
@@ -87,6 +129,19 @@ public:
   gcc_pure
   TerrainHeight GetInterpolated(unsigned lx, unsigned ly) const;
 
+  /**
+   * Batch version of GetInterpolated(): determine the interpolated
+   * heights at many sub-pixel locations, using SIMD where available.
+   *
+   * @param locations sub-pixel locations; after subtracting the
+   * offset, they must be within this buffer
+   * @param offset_x the sub-pixel column of this buffer's origin
+   * @param offset_y the sub-pixel row of this buffer's origin
+   */
+  void GetInterpolated(const RasterLocation *gcc_restrict locations,
+                       TerrainHeight *gcc_restrict dest, unsigned n,
+                       unsigned offset_x=0, unsigned offset_y=0) const;
+
   gcc_pure
   TerrainHeight Get(unsigned x, unsigned y) const {
     return *GetDataAt(x, y);
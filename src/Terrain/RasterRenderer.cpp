@@ -23,12 +23,14 @@ Copyright_License {
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/SlopeShading.hpp"
 #include "Math/FastMath.hpp"
 #include "Util/Clamp.hpp"
 #include "Screen/Ramp.hpp"
 #include "Screen/Layout.hpp"
 #include "Screen/Color.hpp"
 #include "Screen/RawBitmap.hpp"
+#include "Screen/Point.hpp"
 #include "Renderer/GeoBitmapRenderer.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "Asset.hpp"
@@ -36,6 +38,8 @@ Copyright_License {
 
 #include <assert.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 /**
  * Interpolate between x and y with i/128, i.e. i/(1 << 7).
@@ -113,6 +117,7 @@ RasterRenderer::~RasterRenderer()
   delete[] color_table;
   delete image;
   delete[] contour_column_base;
+  delete[] shade_row;
 }
 
 #ifdef ENABLE_OPENGL
@@ -148,6 +153,81 @@ RasterRenderer::BindAndGetTexture() const
 
 #endif
 
+#ifdef ENABLE_OPENGL
+
+bool
+RasterRenderer::ScrollMap(const RasterMap &map,
+                          const WindowProjection &projection,
+                          const GeoBounds &new_bounds,
+                          unsigned width, unsigned height)
+{
+  /* only a pure pan can be done incrementally; a different zoom
+     level or resolution requires scanning everything */
+  if (!bounds.IsValid() || projection.GetScale() != last_scale ||
+      width != height_matrix.GetWidth() ||
+      height != height_matrix.GetHeight() ||
+      width < 4 || height < 4)
+    return false;
+
+  /* move the old bounds by a whole number of pixels, so the pixels
+     which are kept remain at their geographic location */
+  const Angle delta_x = bounds.GetWidth() / (width - 1);
+  const Angle delta_y = bounds.GetHeight() / height;
+
+  const GeoPoint old_center = bounds.GetCenter();
+  const GeoPoint new_center = new_bounds.GetCenter();
+  const int dx = iround((new_center.longitude - old_center.longitude)
+                        / delta_x);
+  const int dy = iround((old_center.latitude - new_center.latitude)
+                        / delta_y);
+  if ((unsigned)abs(dx) >= width / 2 || (unsigned)abs(dy) >= height / 2)
+    /* most of the area is new: not worth it */
+    return false;
+
+  const GeoBounds moved(GeoPoint(bounds.GetWest() + delta_x * dx,
+                                 bounds.GetNorth() - delta_y * dy),
+                        GeoPoint(bounds.GetEast() + delta_x * dx,
+                                 bounds.GetSouth() - delta_y * dy));
+
+  /* the moved area must still cover the screen, and it must not
+     stick out of the map; in both cases, the full area needs to be
+     recalculated */
+  if (!moved.IsInside(projection.GetScreenBounds()) ||
+      !map.GetBounds().IsInside(moved))
+    return false;
+
+  bounds = moved;
+  scroll_x = dx;
+  scroll_y = dy;
+
+  if (dx == 0 && dy == 0)
+    return true;
+
+  height_matrix.Shift(dx, dy);
+
+  /* RasterMap::ScanLine() needs at least two pixels */
+  const int w = width, h = height;
+  if (dx > 0)
+    height_matrix.FillRectangle(map, bounds,
+                                PixelRect(std::min(w - dx, w - 2), 0, w, h),
+                                true);
+  else if (dx < 0)
+    height_matrix.FillRectangle(map, bounds,
+                                PixelRect(0, 0, std::max(-dx, 2), h),
+                                true);
+
+  if (dy > 0)
+    height_matrix.FillRectangle(map, bounds, PixelRect(0, h - dy, w, h),
+                                true);
+  else if (dy < 0)
+    height_matrix.FillRectangle(map, bounds, PixelRect(0, 0, w, -dy),
+                                true);
+
+  return true;
+}
+
+#endif
+
 void
 RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection)
 {
@@ -186,15 +266,20 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
     quantisation_effective = 0;
 
 #ifdef ENABLE_OPENGL
-  bounds = projection.GetScreenBounds().Scale(1.5);
-  bounds.IntersectWith(map.GetBounds());
+  GeoBounds new_bounds = projection.GetScreenBounds().Scale(1.5);
+  new_bounds.IntersectWith(map.GetBounds());
+
+  const unsigned width = projection.GetScreenWidth() / quantisation_pixels;
+  const unsigned height = projection.GetScreenHeight() / quantisation_pixels;
 
-  height_matrix.Fill(map, bounds,
-                     projection.GetScreenWidth() / quantisation_pixels,
-                     projection.GetScreenHeight() / quantisation_pixels,
-                     true);
+  scrolled = ScrollMap(map, projection, new_bounds, width, height);
+  if (!scrolled) {
+    bounds = new_bounds;
+    height_matrix.Fill(map, bounds, width, height, true);
+  }
 
   last_quantisation_pixels = quantisation_pixels;
+  last_scale = projection.GetScale();
 #else
   height_matrix.Fill(map, projection, quantisation_pixels, true);
 #endif
@@ -215,6 +300,11 @@ RasterRenderer::GenerateImage(bool do_shading,
 
     delete[] contour_column_base;
     contour_column_base = new unsigned char[height_matrix.GetWidth()];
+
+    delete[] shade_row;
+    shade_row = new int8_t[height_matrix.GetWidth()];
+
+    image_valid = false;
   }
 
   if (quantisation_effective == 0) {
@@ -224,33 +314,129 @@ RasterRenderer::GenerateImage(bool do_shading,
 
   const unsigned contour_height_scale = do_contour? height_scale * 2 : 16;
 
-  ContourStart(contour_height_scale);
+  const ImageParameters parameters{
+    do_shading, height_scale, contour_height_scale,
+    contrast, brightness, sunazimuth,
+    quantisation_effective, GetHeightSlopeFactor(),
+  };
 
-  if (do_shading)
-    GenerateSlopeImage(height_scale, contrast, brightness,
-                       sunazimuth, contour_height_scale);
-  else
-    GenerateUnshadedImage(height_scale, contour_height_scale);
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+
+#ifdef ENABLE_OPENGL
+  if (scrolled && image_valid && parameters == last_image_parameters) {
+    /* the height matrix was scrolled: scroll the image as well, and
+       generate only the new strips, the borders (where the slope is
+       calculated differently) and the pixels next to them */
+    ScrollImage(scroll_x, scroll_y);
+
+    const int margin = std::max(quantisation_effective, 1u);
+    const int w = width, h = height;
+
+    GenerateImage(parameters, PixelRect(0, 0, w, margin));
+    GenerateImage(parameters, PixelRect(0, h - margin, w, h));
+    GenerateImage(parameters, PixelRect(0, margin, margin, h - margin));
+    GenerateImage(parameters, PixelRect(w - margin, margin, w, h - margin));
+
+    if (scroll_x > 0)
+      GenerateImage(parameters,
+                    PixelRect(std::max(w - scroll_x - margin, 0), 0, w, h));
+    else if (scroll_x < 0)
+      GenerateImage(parameters,
+                    PixelRect(0, 0, std::min(margin - scroll_x, w), h));
+
+    if (scroll_y > 0)
+      GenerateImage(parameters,
+                    PixelRect(0, std::max(h - scroll_y - margin, 0), w, h));
+    else if (scroll_y < 0)
+      GenerateImage(parameters,
+                    PixelRect(0, 0, w, std::min(margin - scroll_y, h)));
+
+    image->SetDirty();
+    return;
+  }
+#endif
+
+  GenerateImage(parameters, PixelRect(0, 0, width, height));
+
+  last_image_parameters = parameters;
+  image_valid = true;
 
   image->SetDirty();
 }
 
 void
-RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
+RasterRenderer::GenerateImage(const ImageParameters &parameters,
+                              const PixelRect &rc)
+{
+  ContourStart(rc, parameters.contour_height_scale);
+
+  if (parameters.do_shading)
+    GenerateSlopeImage(rc, parameters.height_scale, parameters.contrast,
+                       parameters.brightness, parameters.sunazimuth,
+                       parameters.contour_height_scale);
+  else
+    GenerateUnshadedImage(rc, parameters.height_scale,
+                          parameters.contour_height_scale);
+}
+
+#ifdef ENABLE_OPENGL
+
+void
+RasterRenderer::ScrollImage(int dx, int dy)
+{
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+
+  assert((unsigned)abs(dx) < width);
+  assert((unsigned)abs(dy) < height);
+
+  const unsigned n = width - abs(dx);
+  const unsigned src_x = dx > 0 ? dx : 0;
+  const unsigned dest_x = dx > 0 ? 0 : -dx;
+  const unsigned n_rows = height - abs(dy);
+
+  if (dy >= 0) {
+    for (unsigned y = 0; y < n_rows; ++y)
+      memmove(image->GetRow(y) + dest_x, image->GetRow(y + dy) + src_x,
+              n * sizeof(RawColor));
+  } else {
+    for (unsigned y = n_rows; y-- > 0;)
+      memmove(image->GetRow(y - dy) + dest_x, image->GetRow(y) + src_x,
+              n * sizeof(RawColor));
+  }
+}
+
+#endif
+
+/**
+ * Returns the contour interval of the pixel left of the given one,
+ * which is the initial state for drawing contours in a row.
+ */
+gcc_pure
+static unsigned
+ContourRowBase(const TerrainHeight *src, unsigned x,
+               const unsigned contour_height_scale)
+{
+  return ContourInterval(x > 0 ? src[-1] : src[0], contour_height_scale);
+}
+
+void
+RasterRenderer::GenerateUnshadedImage(const PixelRect &rc,
+                                      unsigned height_scale,
                                       const unsigned contour_height_scale)
 {
-  const auto *src = height_matrix.GetData();
   const RawColor *oColorBuf = color_table + 64 * 256;
-  RawColor *dest = image->GetTopRow();
 
-  for (unsigned y = height_matrix.GetHeight(); y > 0; --y) {
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
+  for (int y = rc.top; y < rc.bottom; ++y) {
+    const auto *src = height_matrix.GetRow(y) + rc.left;
+    RawColor *p = image->GetRow(y) + rc.left;
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned contour_row_base =
+      ContourRowBase(src, rc.left, contour_height_scale);
+    unsigned char *contour_this_column_base = contour_column_base + rc.left;
 
-    for (unsigned x = height_matrix.GetWidth(); x > 0; --x) {
+    for (unsigned x = rc.right - rc.left; x > 0; --x) {
       const auto e = *src++;
       if (gcc_likely(!e.IsSpecial())) {
         unsigned h = std::max(0, (int)e.GetValue());
@@ -280,24 +466,17 @@ RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
   }
 }
 
-/**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
- */
-gcc_const
-static int
-ClipHeightDelta(int d)
+unsigned
+RasterRenderer::GetHeightSlopeFactor() const
 {
-  return Clamp(d, -512, 512);
-}
+  if (quantisation_effective == 0)
+    return 0;
 
-gcc_const
-static int
-ClipHeightDelta(TerrainHeight a, TerrainHeight b)
-{
-  return ClipHeightDelta(a.GetValue() - b.GetValue());
+  return Clamp((unsigned)pixel_size, 1u,
+               /* this upper limit avoids integer overflows in the "mag"
+                  formula; it effectively limits "dd2" so calculating its
+                  square will not overflow */
+               8192u / (quantisation_effective * quantisation_effective));
 }
 
 // JMW: if zoomed right in (e.g. one unit is larger than terrain
@@ -306,7 +485,8 @@ ClipHeightDelta(TerrainHeight a, TerrainHeight b)
 // (gridding of display) This is why quantisation_effective is used instead of 1
 // previously.  for large zoom levels, quantisation_effective=1
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+RasterRenderer::GenerateSlopeImage(const PixelRect &rc,
+                                   unsigned height_scale,
                                    int contrast,
                                    const int sx, const int sy, const int sz,
                                    const unsigned contour_height_scale)
@@ -319,19 +499,15 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   border.right = height_matrix.GetWidth() - quantisation_effective;
   border.bottom = height_matrix.GetHeight() - quantisation_effective;
 
-  const unsigned height_slope_factor =
-    Clamp((unsigned)pixel_size, 1u,
-          /* this upper limit avoids integer overflows in the "mag"
-             formula; it effectively limits "dd2" so calculating its
-             square will not overflow */
-          8192u / (quantisation_effective * quantisation_effective));
+  const unsigned height_slope_factor = GetHeightSlopeFactor();
 
-  const auto *src = height_matrix.GetData();
   const RawColor *oColorBuf = color_table + 64 * 256;
 
-  RawColor *dest = image->GetTopRow();
+  /* the columns which are not close to the left or right edge */
+  const int interior_left = std::max(border.left, rc.left);
+  const int interior_right = std::min(border.right, rc.right);
 
-  for (unsigned y = 0; y < height_matrix.GetHeight(); ++y) {
+  for (unsigned y = rc.top; y < (unsigned)rc.bottom; ++y) {
     const unsigned row_plus_index = y < (unsigned)border.bottom
       ? quantisation_effective
       : height_matrix.GetHeight() - 1 - y;
@@ -343,13 +519,33 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
+    const auto *row = height_matrix.GetRow(y);
+    RawColor *p = image->GetRow(y) + rc.left;
+
+    /* calculate the illumination of all pixels which are not close
+       to the left or right edge in one pass, which allows using SIMD
+       instructions; the results are only used if none of the
+       neighbours is "special" */
+    if (interior_right > interior_left) {
+      const auto *interior = row + interior_left;
+      const SlopeShadingParameters shading(2 * quantisation_effective, p31,
+                                           height_slope_factor,
+                                           sx, sy, sz, contrast);
+      ShadeSlopeRow(interior - row_minus_offset, interior + row_plus_offset,
+                    interior - quantisation_effective,
+                    interior + quantisation_effective,
+                    shade_row + interior_left,
+                    interior_right - interior_left,
+                    shading);
+    }
+
+    const auto *src = row + rc.left;
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned contour_row_base =
+      ContourRowBase(src, rc.left, contour_height_scale);
+    unsigned char *contour_this_column_base = contour_column_base + rc.left;
 
-    for (unsigned x = 0; x < height_matrix.GetWidth(); ++x, ++src) {
+    for (unsigned x = rc.left; x < (unsigned)rc.right; ++x, ++src) {
       const auto e = *src;
       if (gcc_likely(!e.IsSpecial())) {
         unsigned h = std::max(0, (int)e.GetValue());
@@ -404,25 +600,21 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
           continue;
         }
 
-        const int p32 = ClipHeightDelta(h_above, h_below);
-        const int p22 = ClipHeightDelta(h_right, h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * int(p31);
-        const int dd1 = int(p20) * p32;
-        const unsigned dd2 = p20 * p31 * height_slope_factor;
-        const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
-        const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
-        const unsigned mag = (unsigned)sqrt(square_mag);
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = num / int(mag|1);
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[int(h) + 256 * Clamp(sindex, -63, 63)];
+        int sindex;
+        if (gcc_likely((int)x >= interior_left &&
+                       (int)x < interior_right)) {
+          sindex = shade_row[x];
+        } else {
+          const SlopeShadingParameters shading(column_plus_index + column_minus_index,
+                                     p31, height_slope_factor,
+                                     sx, sy, sz, contrast);
+          sindex = PortableSlopeShading::ShadeIndex(
+            PortableSlopeShading::ClipHeightDelta(h_right, h_left),
+            PortableSlopeShading::ClipHeightDelta(h_above, h_below),
+            shading);
+        }
+
+        *p++ = oColorBuf[int(h) + 256 * sindex];
       } else if (e.IsWater()) {
         // we're in the water, so look up the color for water
         *p++ = oColorBuf[255];
@@ -437,7 +629,8 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
 }
 
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+RasterRenderer::GenerateSlopeImage(const PixelRect &rc,
+                                   unsigned height_scale,
                                    int contrast, int brightness,
                                    const Angle sunazimuth,
                                    const unsigned contour_height_scale)
@@ -449,7 +642,7 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   const int sy = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastcosine());
   const int sz = (int)(255 * fudgeelevation.fastsine());
 
-  GenerateSlopeImage(height_scale, contrast,
+  GenerateSlopeImage(rc, height_scale, contrast,
                      sx, sy, sz, contour_height_scale);
 }
 
@@ -460,6 +653,8 @@ RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
   if (color_table == nullptr)
     color_table = new RawColor[256 * 128];
 
+  image_valid = false;
+
   for (int i = 0; i < 256; i++) {
     for (int mag = -64; mag < 64; mag++) {
       RawColor color;
@@ -488,12 +683,14 @@ RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
 }
 
 void
-RasterRenderer::ContourStart(const unsigned contour_height_scale)
+RasterRenderer::ContourStart(const PixelRect &rc,
+                             const unsigned contour_height_scale)
 {
-  // initialise column to first row
-  const auto *src = height_matrix.GetData();
-  unsigned char *col_base = contour_column_base;
-  for (unsigned x = height_matrix.GetWidth(); x > 0; --x)
+  // initialise column to the row above the rectangle (or the first row)
+  const auto *src = height_matrix.GetRow(rc.top > 0 ? rc.top - 1 : 0)
+    + rc.left;
+  unsigned char *col_base = contour_column_base + rc.left;
+  for (unsigned x = rc.right - rc.left; x > 0; --x)
     *col_base++ = ContourInterval(*src++, contour_height_scale);
 }
 
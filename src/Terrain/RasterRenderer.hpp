@@ -25,6 +25,10 @@ Copyright_License {
 #define XCSOAR_RASTER_RENDERER_HPP
 
 #include "Terrain/HeightMatrix.hpp"
+#include "Math/Angle.hpp"
+#include "Compiler.h"
+
+#include <stdint.h>
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
@@ -32,13 +36,13 @@ Copyright_License {
 
 #define NUM_COLOR_RAMP_LEVELS 13
 
-class Angle;
 class Canvas;
 class RasterMap;
 class WindowProjection;
 class RawBitmap;
 struct RawColor;
 struct ColorRamp;
+struct PixelRect;
 
 #ifdef ENABLE_OPENGL
 class GLTexture;
@@ -69,13 +73,67 @@ class RasterRenderer {
    * texture has to be redrawn.
    */
   GeoBounds bounds = GeoBounds::Invalid();
+
+  /**
+   * The map scale used in the last ScanMap() call.  If it has not
+   * changed, the #HeightMatrix may be scrolled instead of being
+   * filled again.
+   */
+  double last_scale;
+
+  /**
+   * Was the #HeightMatrix scrolled by the last ScanMap() call
+   * instead of being filled completely?  The scroll offset is
+   * stored in #scroll_x and #scroll_y.
+   */
+  bool scrolled = false;
+
+  int scroll_x, scroll_y;
 #endif
 
+  /**
+   * The parameters of a GenerateImage() call.  If they are unchanged
+   * and the #HeightMatrix was only scrolled, the image can be
+   * scrolled as well.
+   */
+  struct ImageParameters {
+    bool do_shading;
+    unsigned height_scale, contour_height_scale;
+    int contrast, brightness;
+    Angle sunazimuth;
+    unsigned quantisation_effective, height_slope_factor;
+
+    bool operator==(const ImageParameters &other) const {
+      return do_shading == other.do_shading &&
+        height_scale == other.height_scale &&
+        contour_height_scale == other.contour_height_scale &&
+        contrast == other.contrast &&
+        brightness == other.brightness &&
+        sunazimuth == other.sunazimuth &&
+        quantisation_effective == other.quantisation_effective &&
+        height_slope_factor == other.height_slope_factor;
+    }
+  };
+
+  ImageParameters last_image_parameters;
+
+  /**
+   * Does the image contain the result of a GenerateImage() call with
+   * #last_image_parameters?
+   */
+  bool image_valid = false;
+
   HeightMatrix height_matrix;
   RawBitmap *image = nullptr;
 
   unsigned char *contour_column_base = nullptr;
 
+  /**
+   * Illumination index of each pixel in the current row, calculated
+   * by GenerateSlopeImage().
+   */
+  int8_t *shade_row = nullptr;
+
   double pixel_size;
 
   RawColor *color_table = nullptr;
@@ -148,30 +206,60 @@ public:
             bool transparent_white=false) const;
 
 protected:
+#ifdef ENABLE_OPENGL
+  /**
+   * Attempt to scroll the #HeightMatrix to the new bounds, and scan
+   * only the newly exposed strips.
+   *
+   * @return false if this is not possible (e.g. because the zoom
+   * level has changed) and the #HeightMatrix needs to be filled
+   * completely
+   */
+  bool ScrollMap(const RasterMap &map, const WindowProjection &projection,
+                 const GeoBounds &new_bounds,
+                 unsigned width, unsigned height);
+
+  /**
+   * Move the image contents the same way as HeightMatrix::Shift().
+   */
+  void ScrollImage(int dx, int dy);
+#endif
+
+  gcc_pure
+  unsigned GetHeightSlopeFactor() const;
+
+  /**
+   * Convert a rectangle of the height matrix into the image.
+   */
+  void GenerateImage(const ImageParameters &parameters,
+                     const PixelRect &rc);
+
   /**
    * Convert the height matrix into the image, without shading.
    */
-  void GenerateUnshadedImage(unsigned height_scale,
+  void GenerateUnshadedImage(const PixelRect &rc, unsigned height_scale,
                              const unsigned contour_height_scale);
 
   /**
    * Convert the height matrix into the image, with slope shading.
    */
-  void GenerateSlopeImage(unsigned height_scale, int contrast,
+  void GenerateSlopeImage(const PixelRect &rc,
+                          unsigned height_scale, int contrast,
                           const int sx, const int sy, const int sz,
                           const unsigned contour_height_scale);
 
   /**
    * Convert the height matrix into the image, with slope shading.
    */
-  void GenerateSlopeImage(unsigned height_scale,
+  void GenerateSlopeImage(const PixelRect &rc,
+                          unsigned height_scale,
                           int contrast, int brightness,
                           const Angle sunazimuth,
                           const unsigned contour_height_scale);
 
 private:
 
-  void ContourStart(const unsigned contour_height_scale);
+  void ContourStart(const PixelRect &rc, const unsigned contour_height_scale);
 };
 
 #endif
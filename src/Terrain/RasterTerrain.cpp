@@ -23,14 +23,30 @@ Copyright_License {
 
 #include "RasterTerrain.hpp"
 #include "Loader.hpp"
+#include "RasterTileStore.hpp"
 #include "Profile/Profile.hpp"
 #include "IO/ZipArchive.hpp"
 #include "IO/FileCache.hpp"
 #include "OS/ConvertPathName.hpp"
 #include "Operation/Operation.hpp"
 #include "Util/ConvertString.hpp"
+#include "Util/StaticArray.hxx"
+#include "Thread/Parallel.hpp"
+
+#include <algorithm>
+#include <stdexcept>
 
 static const TCHAR *const terrain_cache_name = _T("terrain");
+static const TCHAR *const tile_store_cache_name = _T("terrain-tiles");
+
+RasterTerrain::RasterTerrain(ZipArchive &&_archive)
+  :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+
+RasterTerrain::~RasterTerrain()
+{
+  /* detach the store before unmapping it */
+  map.GetTileCache().Reset();
+}
 
 inline bool
 RasterTerrain::LoadCache(FileCache &cache, Path path)
@@ -63,20 +79,69 @@ RasterTerrain::SaveCache(FileCache &cache, Path path) const
   return success;
 }
 
+inline bool
+RasterTerrain::OpenTileStore(FileCache &cache, Path path)
+{
+  FILE *file = cache.Load(tile_store_cache_name, path);
+  if (file == nullptr)
+    return false;
+
+  const long offset = ftell(file);
+  fclose(file);
+  if (offset <= 0)
+    return false;
+
+  tile_store.reset(new RasterTileStore(cache.MakeCachePath(tile_store_cache_name),
+                                       offset));
+  if (!tile_store->IsDefined() ||
+      !map.GetTileCache().AttachStore(*tile_store)) {
+    tile_store.reset();
+    cache.Flush(tile_store_cache_name);
+    return false;
+  }
+
+  return true;
+}
+
+inline void
+RasterTerrain::LoadTileStore(FileCache &cache, Path path,
+                             OperationEnvironment &operation)
+{
+  if (OpenTileStore(cache, path))
+    return;
+
+  FILE *file = cache.Save(tile_store_cache_name, path);
+  if (file == nullptr)
+    return;
+
+  if (!BuildTerrainTileStore(archive.get(), "terrain.jp2",
+                             map.GetTileCache(), file, operation)) {
+    cache.Cancel(tile_store_cache_name, file);
+    return;
+  }
+
+  if (cache.Commit(tile_store_cache_name, file))
+    OpenTileStore(cache, path);
+}
+
 inline bool
 RasterTerrain::Load(Path path, FileCache *cache,
                     OperationEnvironment &operation)
 {
-  if (LoadCache(cache, path))
-    return true;
+  if (!LoadCache(cache, path)) {
+    if (!LoadTerrainOverview(archive.get(), map.GetTileCache(), operation))
+      return false;
 
-  if (!LoadTerrainOverview(archive.get(), map.GetTileCache(), operation))
-    return false;
+    map.UpdateProjection();
 
-  map.UpdateProjection();
+    if (cache != nullptr)
+      SaveCache(*cache, path);
+  }
 
-  if (cache != nullptr)
-    SaveCache(*cache, path);
+  bool use_tile_store = false;
+  Profile::Get(ProfileKeys::TerrainTileStore, use_tile_store);
+  if (use_tile_store && cache != nullptr)
+    LoadTileStore(*cache, path, operation);
 
   return true;
 }
@@ -94,12 +159,27 @@ try {
     return nullptr;
   }
 
+  rt->OpenWorkerArchives(path);
   return rt;
 } catch (const std::runtime_error &e) {
   operation.SetErrorMessage(UTF8ToWideConverter(e.what()));
   return nullptr;
 }
 
+inline void
+RasterTerrain::OpenWorkerArchives(Path path)
+{
+  const unsigned n_threads = std::min(GetProcessorCount(),
+                                      MAX_DECODER_THREADS);
+
+  try {
+    for (unsigned i = 1; i < n_threads; ++i)
+      worker_archives.emplace_back(path);
+  } catch (const std::runtime_error &) {
+    /* not fatal: decode with fewer threads */
+  }
+}
+
 bool
 RasterTerrain::UpdateTiles(const GeoPoint &location, double radius)
 {
@@ -107,7 +187,13 @@ RasterTerrain::UpdateTiles(const GeoPoint &location, double radius)
   if (!tile_cache.IsValid())
     return false;
 
-  UpdateTerrainTiles(archive.get(), tile_cache, mutex,
+  StaticArray<struct zzip_dir *, MAX_DECODER_THREADS> dirs;
+  dirs.append(archive.get());
+  for (auto &i : worker_archives)
+    dirs.append(i.get());
+
+  UpdateTerrainTiles(dirs.begin(), dirs.size(), "terrain.jp2",
+                     tile_cache, mutex,
                      map.GetProjection(), location, radius);
   return map.IsDirty();
 }
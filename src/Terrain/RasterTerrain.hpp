@@ -31,8 +31,12 @@ Copyright_License {
 #include "IO/ZipArchive.hpp"
 #include "Compiler.h"
 
+#include <memory>
+#include <vector>
+
 class FileCache;
 class OperationEnvironment;
+class RasterTileStore;
 
 /**
  * Class to manage raster terrain database, potentially with caching
@@ -45,18 +49,37 @@ public:
   friend class WaypointVisitorMap; // for intersection rendering
 
 private:
+  /**
+   * The maximum number of threads decoding JPEG2000 tiles
+   * concurrently in UpdateTiles().
+   */
+  static constexpr unsigned MAX_DECODER_THREADS = 4;
+
   ZipArchive archive;
 
+  /**
+   * Additional handles on the map file, one for each extra tile
+   * decoder thread, because zzip_dir is not thread-safe.
+   */
+  std::vector<ZipArchive> worker_archives;
+
+  /**
+   * The optional memory-mapped copy of all decoded tiles.  If this
+   * is set, then tiles never need to be decoded.
+   */
+  std::unique_ptr<RasterTileStore> tile_store;
+
   RasterMap map;
 
 private:
   /**
    * Constructor.  Returns uninitialised object.
    */
-  explicit RasterTerrain(ZipArchive &&_archive)
-    :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+  explicit RasterTerrain(ZipArchive &&_archive);
 
 public:
+  ~RasterTerrain();
+
   const Serial &GetSerial() const {
     return map.GetSerial();
   }
@@ -91,8 +114,25 @@ private:
 
   bool SaveCache(FileCache &cache, Path path) const;
 
+  /**
+   * Attach the #tile_store from the cache, if one exists.
+   */
+  bool OpenTileStore(FileCache &cache, Path path);
+
+  /**
+   * Attach the #tile_store, building it first if necessary.
+   */
+  void LoadTileStore(FileCache &cache, Path path,
+                     OperationEnvironment &operation);
+
   bool Load(Path path, FileCache *cache,
             OperationEnvironment &operation);
+
+  /**
+   * Open the #worker_archives, depending on the number of CPU
+   * cores.
+   */
+  void OpenWorkerArchives(Path path);
 };
 
 #endif
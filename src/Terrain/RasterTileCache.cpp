@@ -22,6 +22,7 @@ Copyright_License {
 */
 
 #include "RasterTileCache.hpp"
+#include "RasterTileStore.hpp"
 #include "Math/Angle.hpp"
 #include "Math/FastMath.hpp"
 
@@ -105,6 +106,12 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
      the screen will be loaded in advance */
   radius += 256;
 
+  if (store != nullptr) {
+    /* all tiles are memory-mapped already */
+    dirty = false;
+    return false;
+  }
+
   /**
    * Maximum number of tiles loaded at a time, to reduce system load
    * peaks.
@@ -194,6 +201,65 @@ RasterTileCache::GetInterpolatedHeight(unsigned int lx, unsigned int ly) const
                                   RasterTraits::ToOverview(ly));
 }
 
+void
+RasterTileCache::GetInterpolatedHeights(const RasterLocation *locations,
+                                        TerrainHeight *dest,
+                                        unsigned n) const
+{
+  const unsigned fine_tile_width = GetFineTileWidth();
+  const unsigned fine_tile_height = GetFineTileHeight();
+
+  unsigned i = 0;
+  while (i < n) {
+    const RasterLocation l = locations[i];
+    if (l.x >= overview_width_fine || l.y >= overview_height_fine) {
+      dest[i++] = TerrainHeight::Invalid();
+      continue;
+    }
+
+    const unsigned tile_x = l.x / fine_tile_width;
+    const unsigned tile_y = l.y / fine_tile_height;
+    const RasterTile &tile = tiles.Get(tile_x, tile_y);
+    if (!tile.IsEnabled()) {
+      dest[i] = overview.GetInterpolated(RasterTraits::ToOverview(l.x),
+                                         RasterTraits::ToOverview(l.y));
+      ++i;
+      continue;
+    }
+
+    /* find all following locations within this tile */
+    const unsigned tile_x0 = tile.xstart << RasterTraits::SUBPIXEL_BITS;
+    const unsigned tile_y0 = tile.ystart << RasterTraits::SUBPIXEL_BITS;
+    const unsigned tile_x1 = tile.xend << RasterTraits::SUBPIXEL_BITS;
+    const unsigned tile_y1 = tile.yend << RasterTraits::SUBPIXEL_BITS;
+
+    if (l.x < tile_x0 || l.x >= tile_x1 || l.y < tile_y0 || l.y >= tile_y1) {
+      /* same as RasterTile::GetInterpolatedHeight() */
+      dest[i++] = TerrainHeight::Invalid();
+      continue;
+    }
+
+    unsigned end = i + 1;
+    while (end < n &&
+           locations[end].x >= tile_x0 && locations[end].x < tile_x1 &&
+           locations[end].y >= tile_y0 && locations[end].y < tile_y1)
+      ++end;
+
+    tile.buffer.GetInterpolated(locations + i, dest + i, end - i,
+                                tile_x0, tile_y0);
+    i = end;
+  }
+}
+
+unsigned
+RasterTileCache::GetEnabledTileCount() const
+{
+  return std::count_if(tiles.begin(), tiles.end(),
+                       [](const RasterTile &tile){
+                         return tile.IsEnabled();
+                       });
+}
+
 void
 RasterTileCache::SetSize(unsigned _width, unsigned _height,
                          unsigned _tile_width, unsigned _tile_height,
@@ -234,6 +300,7 @@ RasterTileCache::Reset()
   height = 0;
   bounds.SetInvalid();
   segments.clear();
+  store = nullptr;
 
   overview.Reset();
 
@@ -241,6 +308,32 @@ RasterTileCache::Reset()
     it->Disable();
 }
 
+bool
+RasterTileCache::AttachStore(const RasterTileStore &_store)
+{
+  assert(store == nullptr);
+
+  if (!_store.Matches(width, height, tiles.GetWidth(), tiles.GetHeight()))
+    return false;
+
+  for (unsigned i = 0; i < tiles.GetSize(); ++i) {
+    RasterTile &tile = tiles.GetLinear(i);
+    if (!tile.IsDefined())
+      continue;
+
+    const TerrainHeight *data = _store.GetTile(i, tile.width, tile.height);
+    if (data != nullptr)
+      tile.buffer.SetExternal(data, tile.width, tile.height);
+    else
+      /* not available in the store; fall back to the overview */
+      tile.Disable();
+  }
+
+  store = &_store;
+  ++serial;
+  return true;
+}
+
 const RasterTileCache::MarkerSegmentInfo *
 RasterTileCache::FindMarkerSegment(uint32_t file_offset) const
 {
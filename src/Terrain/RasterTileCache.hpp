@@ -39,6 +39,7 @@ Copyright_License {
 
 struct jas_matrix;
 struct GridLocation;
+class RasterTileStore;
 
 class RasterTileCache {
   static constexpr unsigned MAX_RTC_TILES = 4096;
@@ -130,6 +131,12 @@ protected:
 
   StaticArray<MarkerSegmentInfo, 8192> segments;
 
+  /**
+   * If set, then all fine tiles refer to this memory-mapped store,
+   * and no tile needs to be decoded ever.  See AttachStore().
+   */
+  const RasterTileStore *store = nullptr;
+
   /**
    * An array that is used to sort the requested tiles by distance.
    * This is only used by PollTiles() internally, but is stored in the
@@ -178,6 +185,17 @@ public:
   TerrainHeight GetInterpolatedHeight(unsigned lx,
                                       unsigned ly) const;
 
+  /**
+   * Batch version of GetInterpolatedHeight().  Consecutive locations
+   * which fall into the same tile are grouped and interpolated with
+   * SIMD where available, therefore callers should pass locations in
+   * spatially coherent order (e.g. along a scan line).
+   *
+   * @param locations sub-pixel locations; may be out of range
+   */
+  void GetInterpolatedHeights(const RasterLocation *locations,
+                              TerrainHeight *dest, unsigned n) const;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
@@ -238,8 +256,39 @@ public:
     return serial;
   }
 
+  /**
+   * Count the tiles whose fine data is currently loaded.
+   */
+  gcc_pure
+  unsigned GetEnabledTileCount() const;
+
   void Reset();
 
+  /**
+   * Serve all fine tiles from the given (memory-mapped) store.  This
+   * disables on-demand tile loading and the #MAX_ACTIVE_TILES
+   * limit.  The store must remain valid until Reset() is called.
+   *
+   * @return false if the store does not match this map
+   */
+  bool AttachStore(const RasterTileStore &store);
+
+  bool HasStore() const {
+    return store != nullptr;
+  }
+
+  unsigned GetTileColumns() const {
+    return tiles.GetWidth();
+  }
+
+  unsigned GetTileRows() const {
+    return tiles.GetHeight();
+  }
+
+  const RasterTile &GetTile(unsigned index) const {
+    return tiles.GetLinear(index);
+  }
+
   const GeoBounds &GetBounds() const {
     assert(bounds.IsValid());
 
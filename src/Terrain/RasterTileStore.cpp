@@ -0,0 +1,187 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "RasterTileStore.hpp"
+#include "RasterTileCache.hpp"
+#include "OS/Path.hpp"
+
+#include <assert.h>
+
+extern "C" {
+#include "jasper/jas_seq.h"
+}
+
+static constexpr size_t TILE_ALIGNMENT = 64;
+
+static constexpr uint64_t
+AlignTileOffset(uint64_t offset)
+{
+  return (offset + TILE_ALIGNMENT - 1) & ~uint64_t(TILE_ALIGNMENT - 1);
+}
+
+RasterTileStore::RasterTileStore(Path path, size_t offset)
+  :mapping(path)
+{
+  if (mapping.error() || mapping.size() < offset + sizeof(Header))
+    return;
+
+  base = (const uint8_t *)mapping.at(offset);
+  const size_t size = mapping.size() - offset;
+
+  const auto *h = (const Header *)base;
+  if (h->magic != Header::MAGIC || h->version != Header::VERSION)
+    return;
+
+  const size_t n_tiles = size_t(h->tile_columns) * h->tile_rows;
+  if (sizeof(*h) + n_tiles * sizeof(TileEntry) > size)
+    return;
+
+  const auto *e = (const TileEntry *)(h + 1);
+
+  /* verify that all tiles are inside the file */
+  for (size_t i = 0; i < n_tiles; ++i)
+    if (e[i].offset != 0 &&
+        e[i].offset + uint64_t(e[i].width) * e[i].height * sizeof(TerrainHeight) > size)
+      return;
+
+  header = h;
+  entries = e;
+}
+
+bool
+RasterTileStore::Matches(unsigned width, unsigned height,
+                         unsigned tile_columns, unsigned tile_rows) const
+{
+  return IsDefined() &&
+    header->width == width && header->height == height &&
+    header->tile_columns == tile_columns && header->tile_rows == tile_rows;
+}
+
+const TerrainHeight *
+RasterTileStore::GetTile(unsigned index,
+                         unsigned width, unsigned height) const
+{
+  assert(IsDefined());
+  assert(index < header->tile_columns * header->tile_rows);
+
+  const TileEntry &entry = entries[index];
+  if (entry.offset == 0 || entry.width != width || entry.height != height)
+    return nullptr;
+
+  return (const TerrainHeight *)(base + entry.offset);
+}
+
+bool
+RasterTileStore::Writer::WriteHeader(const RasterTileCache &cache)
+{
+  Header header;
+  header.magic = Header::MAGIC;
+  header.version = Header::VERSION;
+  header.width = cache.GetWidth();
+  header.height = cache.GetHeight();
+  header.tile_columns = cache.GetTileColumns();
+  header.tile_rows = cache.GetTileRows();
+
+  const unsigned n_tiles = header.tile_columns * header.tile_rows;
+  planned.resize(n_tiles);
+  table.resize(n_tiles);
+
+  uint64_t offset = AlignTileOffset(sizeof(header) +
+                                    n_tiles * sizeof(TileEntry));
+  for (unsigned i = 0; i < n_tiles; ++i) {
+    const RasterTile &tile = cache.GetTile(i);
+
+    TileEntry &entry = planned[i];
+    if (tile.IsDefined()) {
+      entry.offset = offset;
+      entry.width = tile.width;
+      entry.height = tile.height;
+      offset = AlignTileOffset(offset + uint64_t(tile.width) * tile.height
+                               * sizeof(TerrainHeight));
+    } else {
+      entry.offset = 0;
+      entry.width = entry.height = 0;
+    }
+
+    table[i].offset = 0;
+    table[i].width = table[i].height = 0;
+  }
+
+  /* reserve some padding after the last tile, see Finish() */
+  end_offset = offset + TILE_ALIGNMENT;
+
+  return fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(table.data(), sizeof(TileEntry), n_tiles, file) == n_tiles;
+}
+
+void
+RasterTileStore::Writer::PutTile(unsigned index,
+                                 unsigned width, unsigned height,
+                                 const struct jas_matrix &m)
+{
+  if (error || index >= planned.size())
+    return;
+
+  const TileEntry &entry = planned[index];
+  if (entry.offset == 0 || entry.width != width || entry.height != height ||
+      unsigned(m.numcols_) != width || unsigned(m.numrows_) != height)
+    /* size mismatch; leave this tile empty */
+    return;
+
+  if (fseek(file, base + entry.offset, SEEK_SET) != 0) {
+    error = true;
+    return;
+  }
+
+  row.GrowDiscard(width);
+
+  for (unsigned y = 0; y < height; ++y) {
+    const jas_seqent_t *src = m.rows_[y];
+    for (unsigned x = 0; x < width; ++x)
+      row[x] = TerrainHeight(src[x]);
+
+    if (fwrite(row.begin(), sizeof(row[0]), width, file) != width) {
+      error = true;
+      return;
+    }
+  }
+
+  table[index] = entry;
+}
+
+bool
+RasterTileStore::Writer::Finish()
+{
+  if (error)
+    return false;
+
+  /* write one byte at the very end, to make sure the file is large
+     enough for all tiles, even if the last ones were not written */
+  if (fseek(file, base + end_offset - 1, SEEK_SET) != 0 ||
+      fputc(0, file) == EOF)
+    return false;
+
+  return fseek(file, base + sizeof(Header), SEEK_SET) == 0 &&
+    fwrite(table.data(), sizeof(TileEntry), table.size(), file) == table.size() &&
+    fflush(file) == 0;
+}
@@ -0,0 +1,167 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_RASTER_TILE_STORE_HPP
+#define XCSOAR_RASTER_TILE_STORE_HPP
+
+#include "Height.hpp"
+#include "OS/FileMapping.hpp"
+#include "Util/AllocatedArray.hxx"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+
+class Path;
+class RasterTileCache;
+struct jas_matrix;
+
+/**
+ * An uncompressed copy of all fine terrain tiles in a file, which is
+ * memory-mapped and then used by #RasterTileCache directly instead
+ * of decoding JPEG2000 tiles on demand.  "Loading" a tile becomes a
+ * page fault.
+ *
+ * The file consists of a #Header, one #TileEntry per tile and the
+ * raw #TerrainHeight values of each tile (row by row).  All offsets
+ * are relative to the start of the #Header, which allows storing it
+ * inside a #FileCache file.
+ */
+class RasterTileStore {
+  struct Header {
+    static constexpr uint32_t MAGIC = 0x58435453;
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic, version;
+    uint32_t width, height;
+    uint32_t tile_columns, tile_rows;
+  };
+
+  struct TileEntry {
+    /**
+     * The position of this tile's data.  0 means this tile is not
+     * available.
+     */
+    uint64_t offset;
+
+    uint32_t width, height;
+  };
+
+  FileMapping mapping;
+
+  const Header *header = nullptr;
+  const TileEntry *entries = nullptr;
+  const uint8_t *base;
+
+public:
+  /**
+   * Map the specified file.  Call IsDefined() to check whether this
+   * has succeeded.
+   *
+   * @param offset the position of the #Header within the file
+   */
+  RasterTileStore(Path path, size_t offset);
+
+  RasterTileStore(const RasterTileStore &) = delete;
+  RasterTileStore &operator=(const RasterTileStore &) = delete;
+
+  bool IsDefined() const {
+    return header != nullptr;
+  }
+
+  /**
+   * Check whether this store was created for a map with the given
+   * dimensions.
+   */
+  gcc_pure
+  bool Matches(unsigned width, unsigned height,
+               unsigned tile_columns, unsigned tile_rows) const;
+
+  /**
+   * Returns a pointer to the heights of the specified tile, or
+   * nullptr if the tile is not available or has a different size.
+   */
+  gcc_pure
+  const TerrainHeight *GetTile(unsigned index,
+                               unsigned width, unsigned height) const;
+
+  /**
+   * Writes a new store file, tile by tile.
+   */
+  class Writer {
+    FILE *const file;
+    const long base;
+
+    /**
+     * The tile table; entries whose tiles have not been written yet
+     * have a zero width.
+     */
+    std::vector<TileEntry> table;
+
+    /**
+     * The planned tile entries (with offsets, width, height).
+     */
+    std::vector<TileEntry> planned;
+
+    /**
+     * The total size of the store, relative to #base.
+     */
+    uint64_t end_offset;
+
+    AllocatedArray<TerrainHeight> row;
+
+    bool error = false;
+
+  public:
+    explicit Writer(FILE *_file)
+      :file(_file), base(ftell(_file)) {}
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    /**
+     * Write the header and the tile table, reserving space for all
+     * tiles which are defined in the #RasterTileCache.
+     */
+    bool WriteHeader(const RasterTileCache &cache);
+
+    /**
+     * Write the data of one tile.  Called by #TerrainLoader with
+     * each decoded tile.
+     */
+    void PutTile(unsigned index, unsigned width, unsigned height,
+                 const struct jas_matrix &m);
+
+    /**
+     * Write the final tile table, which lists only the tiles which
+     * have actually been written.
+     *
+     * @return true if all writes have succeeded
+     */
+    bool Finish();
+  };
+};
+
+#endif
@@ -0,0 +1,345 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+#define XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+
+#include "Height.hpp"
+#include "Util/Clamp.hpp"
+#include "Compiler.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * The per-row constants of the slope shading formula used by
+ * RasterRenderer::GenerateSlopeImage().
+ */
+struct SlopeShadingParameters {
+  /** the horizontal and vertical distance of the neighbours */
+  int p20, p31;
+
+  /** the z component of the surface normal */
+  int dd2;
+
+  /** the light vector */
+  int sx, sy, sz;
+
+  int contrast;
+
+  SlopeShadingParameters(unsigned _p20, unsigned _p31, unsigned height_slope_factor,
+               int _sx, int _sy, int _sz, int _contrast)
+    :p20(_p20), p31(_p31), dd2(_p20 * _p31 * height_slope_factor),
+     sx(_sx), sy(_sy), sz(_sz), contrast(_contrast) {}
+};
+
+/**
+ * Portable implementation of the slope shading formula.
+ */
+struct PortableSlopeShading {
+  /**
+   * Clip the difference between two adjacent terrain height values
+   * to sane bounds.  This works around integer overflows in the
+   * formula when the map file is broken, avoiding the sqrt() call
+   * with a negative argument.
+   */
+  gcc_const
+  static int ClipHeightDelta(int d) {
+    return Clamp(d, -512, 512);
+  }
+
+  gcc_const
+  static int ClipHeightDelta(TerrainHeight a, TerrainHeight b) {
+    return ClipHeightDelta(a.GetValue() - b.GetValue());
+  }
+
+  /**
+   * Calculate the illumination index (-63..63) of one pixel.
+   *
+   * @param p22 the clipped height difference right minus left
+   * @param p32 the clipped height difference above minus below
+   */
+  gcc_pure
+  static int ShadeIndex(int p22, int p32, const SlopeShadingParameters &s) {
+    const int dd0 = p22 * s.p31;
+    const int dd1 = s.p20 * p32;
+    const int num = (s.dd2 * s.sz + dd0 * s.sx + dd1 * s.sy);
+    const unsigned square_mag = unsigned(dd0 * dd0) + unsigned(dd1 * dd1)
+      + unsigned(s.dd2) * unsigned(s.dd2);
+    const unsigned mag = (unsigned)sqrt(square_mag);
+    /* this is a workaround for a SIGFPE (division by zero)
+       observed by our users on some Android devices (e.g. Nexus
+       7), even though we did our best to make sure that the
+       integer arithmetics above can't overflow */
+    /* TODO: debug this problem and replace this workaround */
+    const int sval = num / int(mag|1);
+    const int sindex = (sval - s.sz) * s.contrast / 128;
+    return Clamp(sindex, -63, 63);
+  }
+
+  static void Shade(const TerrainHeight *above, const TerrainHeight *below,
+                    const TerrainHeight *left, const TerrainHeight *right,
+                    int8_t *gcc_restrict dest, unsigned n,
+                    const SlopeShadingParameters &s) {
+    for (unsigned i = 0; i < n; ++i)
+      dest[i] = ShadeIndex(ClipHeightDelta(right[i], left[i]),
+                           ClipHeightDelta(above[i], below[i]), s);
+  }
+};
+
+#ifdef __SSE2__
+
+/**
+ * SSE2 implementation of the slope shading formula, 8 pixels per
+ * iteration.  The square root and the division are done with double
+ * precision, which gives exactly the same results as the integer
+ * formula.
+ */
+struct SSE2SlopeShading {
+  static constexpr unsigned STEP = 8;
+
+  gcc_always_inline
+  static __m128i Clip(__m128i d) {
+    return _mm_min_epi16(_mm_max_epi16(d, _mm_set1_epi16(-512)),
+                         _mm_set1_epi16(512));
+  }
+
+  /**
+   * Calculate the shading value of 4 pixels; the input is
+   * interleaved (p22, p32) pairs.
+   */
+  gcc_always_inline
+  static __m128i Shade4(__m128i pairs, __m128i num_factors,
+                        __m128i dd0_factors, __m128i dd1_factors,
+                        __m128i num_base, __m128d square_dd2,
+                        __m128i contrast, __m128i sz) {
+    const __m128i num = _mm_add_epi32(num_base,
+                                      _mm_madd_epi16(pairs, num_factors));
+    const __m128i dd0 = _mm_madd_epi16(pairs, dd0_factors);
+    const __m128i dd1 = _mm_madd_epi16(pairs, dd1_factors);
+
+    const __m128i lo = Divide(_mm_cvtepi32_pd(num),
+                              _mm_cvtepi32_pd(dd0), _mm_cvtepi32_pd(dd1),
+                              square_dd2);
+    const __m128i hi = Divide(_mm_cvtepi32_pd(_mm_srli_si128(num, 8)),
+                              _mm_cvtepi32_pd(_mm_srli_si128(dd0, 8)),
+                              _mm_cvtepi32_pd(_mm_srli_si128(dd1, 8)),
+                              square_dd2);
+    const __m128i sval = _mm_unpacklo_epi64(lo, hi);
+
+    /* (sval - sz) * contrast / 128, rounding towards zero; both
+       factors fit in 16 bits */
+    const __m128i t = _mm_madd_epi16(_mm_sub_epi32(sval, sz), contrast);
+    const __m128i bias = _mm_srli_epi32(_mm_srai_epi32(t, 31), 25);
+    return _mm_srai_epi32(_mm_add_epi32(t, bias), 7);
+  }
+
+  /**
+   * Calculate num/(sqrt(dd0²+dd1²+dd2²)|1) for two pixels.
+   */
+  gcc_always_inline
+  static __m128i Divide(__m128d num, __m128d dd0, __m128d dd1,
+                        __m128d square_dd2) {
+    const __m128d square_mag =
+      _mm_add_pd(_mm_add_pd(_mm_mul_pd(dd0, dd0), _mm_mul_pd(dd1, dd1)),
+                 square_dd2);
+    __m128i mag = _mm_cvttpd_epi32(_mm_sqrt_pd(square_mag));
+    mag = _mm_or_si128(mag, _mm_set1_epi32(1));
+    return _mm_cvttpd_epi32(_mm_div_pd(num, _mm_cvtepi32_pd(mag)));
+  }
+
+  static void Shade(const TerrainHeight *above, const TerrainHeight *below,
+                    const TerrainHeight *left, const TerrainHeight *right,
+                    int8_t *gcc_restrict dest, unsigned n,
+                    const SlopeShadingParameters &s) {
+    /* these products are used as 16 bit factors for pmaddwd */
+    assert(s.p31 * s.sx >= -32768 && s.p31 * s.sx <= 32767);
+    assert(s.p20 * s.sy >= -32768 && s.p20 * s.sy <= 32767);
+
+    const __m128i num_factors =
+      _mm_set1_epi32((uint16_t)(s.p31 * s.sx) |
+                     ((uint32_t)(uint16_t)(s.p20 * s.sy) << 16));
+    const __m128i dd0_factors = _mm_set1_epi32((uint16_t)s.p31);
+    const __m128i dd1_factors =
+      _mm_set1_epi32((uint32_t)(uint16_t)s.p20 << 16);
+    const __m128i num_base = _mm_set1_epi32(s.dd2 * s.sz);
+    const __m128d square_dd2 = _mm_set1_pd(double(s.dd2) * s.dd2);
+    const __m128i contrast = _mm_set1_epi32((uint16_t)s.contrast);
+    const __m128i sz = _mm_set1_epi32(s.sz);
+    const __m128i min_index = _mm_set1_epi16(-63);
+    const __m128i max_index = _mm_set1_epi16(63);
+
+    for (unsigned i = 0; i < n; i += STEP) {
+      const __m128i va = _mm_loadu_si128((const __m128i *)(above + i));
+      const __m128i vb = _mm_loadu_si128((const __m128i *)(below + i));
+      const __m128i vl = _mm_loadu_si128((const __m128i *)(left + i));
+      const __m128i vr = _mm_loadu_si128((const __m128i *)(right + i));
+
+      /* saturating subtraction followed by clipping is equivalent
+         to clipping the exact difference */
+      const __m128i p22 = Clip(_mm_subs_epi16(vr, vl));
+      const __m128i p32 = Clip(_mm_subs_epi16(va, vb));
+
+      const __m128i lo = Shade4(_mm_unpacklo_epi16(p22, p32),
+                                num_factors, dd0_factors, dd1_factors,
+                                num_base, square_dd2, contrast, sz);
+      const __m128i hi = Shade4(_mm_unpackhi_epi16(p22, p32),
+                                num_factors, dd0_factors, dd1_factors,
+                                num_base, square_dd2, contrast, sz);
+
+      __m128i result = _mm_packs_epi32(lo, hi);
+      result = _mm_min_epi16(_mm_max_epi16(result, min_index), max_index);
+      _mm_storel_epi64((__m128i *)(dest + i),
+                       _mm_packs_epi16(result, result));
+    }
+  }
+};
+
+typedef SSE2SlopeShading OptimisedSlopeShading;
+
+#elif defined(__ARM_NEON__) && defined(__aarch64__)
+
+/**
+ * ARM NEON implementation of the slope shading formula, 8 pixels
+ * per iteration.  This requires AArch64, because 32 bit NEON has
+ * neither a square root nor a division.
+ */
+struct NEONSlopeShading {
+  static constexpr unsigned STEP = 8;
+
+  /**
+   * Calculate num/(sqrt(dd0²+dd1²+dd2²)|1) for two pixels.
+   */
+  gcc_always_inline
+  static int32x2_t Divide(int32x2_t num, int32x2_t dd0, int32x2_t dd1,
+                          float64x2_t square_dd2) {
+    const float64x2_t d0 = vcvtq_f64_s64(vmovl_s32(dd0));
+    const float64x2_t d1 = vcvtq_f64_s64(vmovl_s32(dd1));
+    const float64x2_t square_mag =
+      vaddq_f64(vaddq_f64(vmulq_f64(d0, d0), vmulq_f64(d1, d1)),
+                square_dd2);
+    int64x2_t mag = vcvtq_s64_f64(vsqrtq_f64(square_mag));
+    mag = vorrq_s64(mag, vdupq_n_s64(1));
+    const float64x2_t q = vdivq_f64(vcvtq_f64_s64(vmovl_s32(num)),
+                                    vcvtq_f64_s64(mag));
+    return vmovn_s64(vcvtq_s64_f64(q));
+  }
+
+  gcc_always_inline
+  static int32x4_t Shade4(int16x4_t p22, int16x4_t p32,
+                          const SlopeShadingParameters &s, float64x2_t square_dd2) {
+    const int32x4_t dd0 = vmull_n_s16(p22, s.p31);
+    const int32x4_t dd1 = vmull_n_s16(p32, s.p20);
+
+    int32x4_t num = vdupq_n_s32(s.dd2 * s.sz);
+    num = vmlaq_n_s32(num, dd0, s.sx);
+    num = vmlaq_n_s32(num, dd1, s.sy);
+
+    const int32x4_t sval =
+      vcombine_s32(Divide(vget_low_s32(num), vget_low_s32(dd0),
+                          vget_low_s32(dd1), square_dd2),
+                   Divide(vget_high_s32(num), vget_high_s32(dd0),
+                          vget_high_s32(dd1), square_dd2));
+
+    /* (sval - sz) * contrast / 128, rounding towards zero */
+    const int32x4_t t = vmulq_n_s32(vsubq_s32(sval, vdupq_n_s32(s.sz)),
+                                    s.contrast);
+    const int32x4_t bias = vreinterpretq_s32_u32(
+      vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(t, 31)), 25));
+    return vshrq_n_s32(vaddq_s32(t, bias), 7);
+  }
+
+  static void Shade(const TerrainHeight *above, const TerrainHeight *below,
+                    const TerrainHeight *left, const TerrainHeight *right,
+                    int8_t *gcc_restrict dest, unsigned n,
+                    const SlopeShadingParameters &s) {
+    const int16x8_t min_delta = vdupq_n_s16(-512);
+    const int16x8_t max_delta = vdupq_n_s16(512);
+    const int16x8_t min_index = vdupq_n_s16(-63);
+    const int16x8_t max_index = vdupq_n_s16(63);
+    const float64x2_t square_dd2 = vdupq_n_f64(double(s.dd2) * s.dd2);
+
+    for (unsigned i = 0; i < n; i += STEP) {
+      const int16x8_t va = vld1q_s16((const int16_t *)(above + i));
+      const int16x8_t vb = vld1q_s16((const int16_t *)(below + i));
+      const int16x8_t vl = vld1q_s16((const int16_t *)(left + i));
+      const int16x8_t vr = vld1q_s16((const int16_t *)(right + i));
+
+      const int16x8_t p22 =
+        vminq_s16(vmaxq_s16(vqsubq_s16(vr, vl), min_delta), max_delta);
+      const int16x8_t p32 =
+        vminq_s16(vmaxq_s16(vqsubq_s16(va, vb), min_delta), max_delta);
+
+      const int32x4_t lo = Shade4(vget_low_s16(p22), vget_low_s16(p32),
+                                  s, square_dd2);
+      const int32x4_t hi = Shade4(vget_high_s16(p22), vget_high_s16(p32),
+                                  s, square_dd2);
+
+      int16x8_t result = vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+      result = vminq_s16(vmaxq_s16(result, min_index), max_index);
+      vst1_s8(dest + i, vmovn_s16(result));
+    }
+  }
+};
+
+typedef NEONSlopeShading OptimisedSlopeShading;
+
+#endif
+
+/**
+ * Calculate the illumination index of a row of pixels, using the
+ * optimised implementation as much as possible, and the portable
+ * one for the remainder.
+ *
+ * The four neighbour arrays point to the terrain heights above,
+ * below, left and right of each pixel; special values are not
+ * checked, the caller is responsible for not using those results.
+ */
+static inline void
+ShadeSlopeRow(const TerrainHeight *above, const TerrainHeight *below,
+              const TerrainHeight *left, const TerrainHeight *right,
+              int8_t *gcc_restrict dest, unsigned n,
+              const SlopeShadingParameters &s)
+{
+#if defined(__SSE2__) || (defined(__ARM_NEON__) && defined(__aarch64__))
+  const unsigned no = n & ~(OptimisedSlopeShading::STEP - 1);
+  OptimisedSlopeShading::Shade(above, below, left, right, dest, no, s);
+#else
+  const unsigned no = 0;
+#endif
+
+  PortableSlopeShading::Shade(above + no, below + no,
+                              left + no, right + no,
+                              dest + no, n - no, s);
+}
+
+#endif
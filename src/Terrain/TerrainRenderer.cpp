@@ -346,6 +346,13 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
   compare_projection = CompareProjection(map_projection);
 #endif
 
+#ifdef ENABLE_OPENGL
+  if (terrain_serial != terrain.GetSerial())
+    /* new terrain tiles have been loaded: the previous image must
+       not be scrolled */
+    raster_renderer.Invalidate();
+#endif
+
   terrain_serial = terrain.GetSerial();
 
   last_sun_azimuth = sunazimuth;
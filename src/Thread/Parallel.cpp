@@ -0,0 +1,84 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/Parallel.hpp"
+#include "Thread/Thread.hpp"
+
+#include <forward_list>
+
+#include <assert.h>
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+unsigned
+GetProcessorCount()
+{
+#ifdef HAVE_POSIX
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? unsigned(n) : 1u;
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1u;
+#endif
+}
+
+namespace {
+  class ParallelThread final : public Thread {
+    const std::function<void(unsigned)> &f;
+    const unsigned index;
+
+  public:
+    ParallelThread(const std::function<void(unsigned)> &_f, unsigned _index)
+      :Thread("Parallel"), f(_f), index(_index) {}
+
+  protected:
+    void Run() override {
+      f(index);
+    }
+  };
+}
+
+void
+ParallelRun(unsigned n, const std::function<void(unsigned)> &f)
+{
+  assert(n > 0);
+
+  std::forward_list<ParallelThread> threads;
+  for (unsigned i = 1; i < n; ++i) {
+    threads.emplace_front(f, i);
+    if (!threads.front().Start()) {
+      threads.pop_front();
+      f(i);
+    }
+  }
+
+  f(0);
+
+  for (auto &thread : threads)
+    thread.Join();
+}
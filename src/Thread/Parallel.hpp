@@ -0,0 +1,51 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_PARALLEL_HPP
+#define XCSOAR_THREAD_PARALLEL_HPP
+
+#include "Compiler.h"
+
+#include <functional>
+
+/**
+ * Determine the number of CPU cores which are currently online.
+ * Returns at least 1.
+ */
+gcc_pure
+unsigned
+GetProcessorCount();
+
+/**
+ * Invoke the given function #n times concurrently, each time with a
+ * different index (0 to n-1), and wait until all invocations have
+ * returned.  Index 0 is run in the calling thread, all others on
+ * short-lived helper threads.  If a helper thread cannot be created,
+ * its index is run in the calling thread instead.
+ *
+ * The function must not throw.
+ */
+void
+ParallelRun(unsigned n, const std::function<void(unsigned index)> &f);
+
+#endif
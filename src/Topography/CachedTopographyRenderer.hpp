@@ -48,6 +48,10 @@ public:
 #endif
   {}
 
+  const TopographyRenderer &GetRenderer() const {
+    return renderer;
+  }
+
   void Flush() {
 #ifndef ENABLE_OPENGL
     cache.Invalidate();
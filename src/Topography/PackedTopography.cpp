@@ -0,0 +1,212 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "PackedTopography.hpp"
+#include "Util/ScopeExit.hxx"
+#include "shapelib/mapserver.h"
+
+#include <zzip/util.h>
+
+#include <algorithm>
+
+#include <string.h>
+
+using namespace PackedTopography;
+
+bool
+PackedTopographyFile::Load(zzip_dir *dir, const char *path)
+{
+  size = 0;
+
+  ZZIP_FILE *file = zzip_open_rb(dir, path);
+  if (file == nullptr)
+    return false;
+
+  AtScopeExit(file) { zzip_close(file); };
+
+  ZZIP_STAT st;
+  if (zzip_fstat(file, &st) < 0 ||
+      st.st_size < (zzip_off_t)sizeof(Header) ||
+      st.st_size > 0x7fffffff)
+    return false;
+
+  const size_t file_size = st.st_size;
+  data.ResizeDiscard((file_size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+  uint8_t *p = (uint8_t *)data.begin();
+  size_t remaining = file_size;
+  while (remaining > 0) {
+    const zzip_ssize_t nbytes = zzip_read(file, p, remaining);
+    if (nbytes <= 0)
+      return false;
+
+    p += nbytes;
+    remaining -= nbytes;
+  }
+
+  size = file_size;
+  if (!Verify()) {
+    size = 0;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Is the range [offset, offset + length) inside the file?
+ */
+static constexpr bool
+CheckRange(uint64_t offset, uint64_t length, size_t size)
+{
+  return offset % ALIGN == 0 && offset + length <= size;
+}
+
+bool
+PackedTopographyFile::VerifyIndices(const Shape &shape, uint32_t offset) const
+{
+  /* lines have one count per line, polygons have one count for the
+     whole triangle strip */
+  const unsigned n_counts = shape.type == MS_SHAPE_LINE ? shape.num_lines : 1;
+  if (!CheckRange(offset, n_counts * sizeof(uint16_t), size))
+    return false;
+
+  const uint16_t *counts = At<uint16_t>(offset);
+  unsigned n_indices = 0;
+  for (unsigned i = 0; i < n_counts; ++i)
+    n_indices += counts[i];
+
+  if (offset + uint64_t(n_counts + n_indices) * sizeof(uint16_t) > size)
+    return false;
+
+  const uint16_t *indices = counts + n_counts;
+  const unsigned n_points = shape.n_points;
+  return std::all_of(indices, indices + n_indices,
+                     [n_points](uint16_t i){ return i < n_points; });
+}
+
+bool
+PackedTopographyFile::Verify() const
+{
+  const auto &header = GetHeader();
+  if (header.magic != MAGIC || header.version != VERSION)
+    return false;
+
+  const unsigned n_shapes = header.n_shapes;
+  if (!CheckRange(header.shapes, uint64_t(n_shapes) * sizeof(Shape), size))
+    return false;
+
+  if (header.grid_width == 0 || header.grid_width > 4096 ||
+      header.grid_height == 0 || header.grid_height > 4096)
+    return false;
+
+  const unsigned n_cells = header.grid_width * header.grid_height;
+  if (!CheckRange(header.grid_cells, (n_cells + 1) * sizeof(uint32_t), size))
+    return false;
+
+  const uint32_t *cells = At<uint32_t>(header.grid_cells);
+  if (cells[0] != 0 || !std::is_sorted(cells, cells + n_cells + 1))
+    return false;
+
+  const unsigned n_items = cells[n_cells];
+  if (!CheckRange(header.grid_items, uint64_t(n_items) * sizeof(uint32_t),
+                  size))
+    return false;
+
+  const uint32_t *items = At<uint32_t>(header.grid_items);
+  if (!std::all_of(items, items + n_items,
+                   [n_shapes](uint32_t i){ return i < n_shapes; }))
+    return false;
+
+  const Shape *shapes = At<Shape>(header.shapes);
+  for (unsigned i = 0; i < n_shapes; ++i) {
+    const Shape &shape = shapes[i];
+
+    if (shape.num_lines > MAX_LINES)
+      return false;
+
+    if (!CheckRange(shape.lines, shape.num_lines * sizeof(uint16_t), size) ||
+        !CheckRange(shape.points, uint64_t(shape.n_points) * 2 * sizeof(float),
+                    size))
+      return false;
+
+    const uint16_t *lines = At<uint16_t>(shape.lines);
+    unsigned n_points = 0;
+    for (unsigned l = 0; l < shape.num_lines; ++l)
+      n_points += lines[l];
+    if (n_points != shape.n_points)
+      return false;
+
+    if (shape.label != 0 &&
+        (shape.label >= size ||
+         memchr(At<char>(shape.label), 0, size - shape.label) == nullptr))
+      return false;
+
+    for (unsigned l = 0; l < THINNING_LEVELS; ++l) {
+      if (shape.indices[l] == 0)
+        continue;
+
+      if ((shape.type != MS_SHAPE_LINE && shape.type != MS_SHAPE_POLYGON) ||
+          !VerifyIndices(shape, shape.indices[l]))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+bool
+PackedTopographyFile::WhichShapes(const GeoBounds &bounds, bool *status) const
+{
+  const auto &header = GetHeader();
+  if (!ImportBounds(header.bounds).Overlaps(bounds))
+    return false;
+
+  std::fill_n(status, header.n_shapes, false);
+
+  const Bounds &b = header.bounds;
+  const unsigned width = header.grid_width, height = header.grid_height;
+  const unsigned x0 = ToCell(bounds.GetWest().Native(), b.west, b.east, width);
+  const unsigned x1 = ToCell(bounds.GetEast().Native(), b.west, b.east, width);
+  const unsigned y0 = ToCell(bounds.GetSouth().Native(), b.south, b.north,
+                             height);
+  const unsigned y1 = ToCell(bounds.GetNorth().Native(), b.south, b.north,
+                             height);
+
+  const uint32_t *cells = At<uint32_t>(header.grid_cells);
+  const uint32_t *items = At<uint32_t>(header.grid_items);
+  const Shape *shapes = At<Shape>(header.shapes);
+
+  for (unsigned y = y0; y <= y1; ++y) {
+    for (unsigned x = x0; x <= x1; ++x) {
+      const unsigned cell = y * width + x;
+      for (unsigned j = cells[cell]; j < cells[cell + 1]; ++j) {
+        const unsigned i = items[j];
+        if (!status[i] && ImportBounds(shapes[i].bounds).Overlaps(bounds))
+          status[i] = true;
+      }
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,267 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TOPOGRAPHY_PACKED_HPP
+#define XCSOAR_TOPOGRAPHY_PACKED_HPP
+
+#include "Geo/GeoBounds.hpp"
+#include "Util/AllocatedArray.hxx"
+#include "Compiler.h"
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct zzip_dir;
+
+/**
+ * The layout of a packed topography file (*.xtp).  Such a file
+ * contains one layer of a shapefile whose shapes have already been
+ * converted to #ShapePoint, triangulated and thinned, so it can be
+ * used without parsing and without expensive calculations on the
+ * device.  It is created by the "PackTopography" tool.
+ *
+ * The file is one position independent block: all references are
+ * byte offsets from the beginning of the file, and all values are
+ * stored in host byte order and aligned to #ALIGN bytes.
+ */
+namespace PackedTopography {
+  static constexpr uint32_t MAGIC = 0x50544358; // "XCTP"
+  static constexpr uint32_t VERSION = 1;
+  static constexpr unsigned THINNING_LEVELS = 4;
+  static constexpr unsigned MAX_LINES = 32;
+  static constexpr size_t ALIGN = 8;
+
+  /**
+   * A bounding box in radians.
+   */
+  struct Bounds {
+    double west, east, south, north;
+  };
+
+  struct Header {
+    uint32_t magic, version;
+
+    uint32_t n_shapes;
+
+    /**
+     * The DBF field which the labels were read from, -1 if there are
+     * no labels.
+     */
+    int32_t label_field;
+
+    /**
+     * The center of the file in radians.  All #ShapePoint
+     * coordinates are relative to this point.
+     */
+    double center_longitude, center_latitude;
+
+    Bounds bounds;
+
+    /**
+     * The "min_distance" parameter the indices of each thinning
+     * level were built with (see XShape::GetIndices()).
+     */
+    float min_distance[THINNING_LEVELS];
+
+    /**
+     * The spatial index: a grid of #grid_width x #grid_height cells
+     * which covers #bounds.
+     */
+    uint32_t grid_width, grid_height;
+
+    /**
+     * Offset of a uint32_t[grid_width * grid_height + 1] array with
+     * the position of each cell's first item in #grid_items.
+     */
+    uint32_t grid_cells;
+
+    /**
+     * Offset of a uint32_t array with shape numbers.
+     */
+    uint32_t grid_items;
+
+    /**
+     * Offset of the #Shape array.
+     */
+    uint32_t shapes;
+
+    uint32_t reserved;
+  };
+
+  static_assert(sizeof(Header) == 104, "Wrong Header size");
+
+  struct Shape {
+    Bounds bounds;
+
+    /**
+     * The shapelib type (MS_SHAPE_TYPE).
+     */
+    uint8_t type;
+
+    uint8_t num_lines;
+
+    uint16_t reserved;
+
+    uint32_t n_points;
+
+    /**
+     * Offset of a uint16_t[num_lines] array with the number of points
+     * of each line.
+     */
+    uint32_t lines;
+
+    /**
+     * Offset of a ShapePoint[n_points] array.
+     */
+    uint32_t points;
+
+    /**
+     * Offset of a null-terminated UTF-8 string, or 0 if this shape
+     * has no label.
+     */
+    uint32_t label;
+
+    /**
+     * Offset of the index buffer of each thinning level (the counts,
+     * followed by the indices; see XShape::BuildIndices()), or 0 if
+     * there is none.
+     */
+    uint32_t indices[THINNING_LEVELS];
+
+    uint32_t reserved2;
+  };
+
+  static_assert(sizeof(Shape) == 72, "Wrong Shape size");
+
+  gcc_const
+  static inline GeoBounds
+  ImportBounds(const Bounds &b)
+  {
+    return GeoBounds(GeoPoint(Angle::Native(b.west), Angle::Native(b.north)),
+                     GeoPoint(Angle::Native(b.east), Angle::Native(b.south)));
+  }
+
+  gcc_const
+  static inline Bounds
+  ExportBounds(const GeoBounds &b)
+  {
+    return {
+      b.GetWest().Native(), b.GetEast().Native(),
+      b.GetSouth().Native(), b.GetNorth().Native(),
+    };
+  }
+
+  /**
+   * Convert a coordinate to a grid column/row number, clipped to
+   * the grid.
+   *
+   * @param min the coordinate of the grid's left/bottom edge
+   * @param max the coordinate of the grid's right/top edge
+   * @param n the number of columns/rows
+   */
+  gcc_const
+  static inline unsigned
+  ToCell(double value, double min, double max, unsigned n)
+  {
+    if (max <= min)
+      return 0;
+
+    const int i = int((value - min) / (max - min) * n);
+    return std::min(unsigned(std::max(i, 0)), n - 1);
+  }
+}
+
+/**
+ * A packed topography file which was loaded into memory as one
+ * block.
+ */
+class PackedTopographyFile {
+  /**
+   * The file contents; uint64_t guarantees the alignment.
+   */
+  AllocatedArray<uint64_t> data;
+
+  size_t size = 0;
+
+public:
+  /**
+   * Load and verify the file.
+   *
+   * @return false if the file does not exist or is not valid
+   */
+  bool Load(zzip_dir *dir, const char *path);
+
+  bool IsDefined() const {
+    return size > 0;
+  }
+
+  template<typename T>
+  const T *At(uint32_t offset) const {
+    return (const T *)((const uint8_t *)data.begin() + offset);
+  }
+
+  const PackedTopography::Header &GetHeader() const {
+    return *At<PackedTopography::Header>(0);
+  }
+
+  gcc_pure
+  GeoPoint GetCenter() const {
+    const auto &header = GetHeader();
+    return GeoPoint(Angle::Native(header.center_longitude),
+                    Angle::Native(header.center_latitude));
+  }
+
+  unsigned GetShapeCount() const {
+    return GetHeader().n_shapes;
+  }
+
+  const PackedTopography::Shape &GetShape(unsigned i) const {
+    assert(i < GetShapeCount());
+
+    return At<PackedTopography::Shape>(GetHeader().shapes)[i];
+  }
+
+  /**
+   * Determine which shapes overlap the given bounds, using the
+   * spatial index.
+   *
+   * @param status an array of GetShapeCount() elements which
+   * receives the result
+   * @return false if the bounds do not overlap with this file (and
+   * the status array was not modified)
+   */
+  bool WhichShapes(const GeoBounds &bounds, bool *status) const;
+
+private:
+  gcc_pure
+  bool VerifyIndices(const PackedTopography::Shape &shape,
+                     uint32_t offset) const;
+
+  gcc_pure
+  bool Verify() const;
+};
+
+#endif
@@ -0,0 +1,293 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "PackedTopographyWriter.hpp"
+#include "PackedTopography.hpp"
+#include "TopographyFile.hpp"
+#include "XShape.hpp"
+#include "IO/OutputStream.hxx"
+#include "Thread/Mutex.hpp"
+
+#ifdef _UNICODE
+#include "Util/ConvertString.hpp"
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <math.h>
+#include <string.h>
+
+using namespace PackedTopography;
+
+namespace {
+
+/**
+ * Builds the packed file in memory.
+ */
+class PackedBuffer {
+  std::vector<uint8_t> data;
+
+public:
+  size_t size() const {
+    return data.size();
+  }
+
+  /**
+   * Append the given data, aligned to #ALIGN.
+   *
+   * @return the offset of the new data
+   */
+  uint32_t Append(const void *p, size_t length) {
+    const size_t offset = (data.size() + ALIGN - 1) & ~(ALIGN - 1);
+    if (offset + length > UINT32_MAX)
+      throw std::runtime_error("Packed topography file too large");
+
+    data.resize(offset + length);
+    memcpy(data.data() + offset, p, length);
+    return offset;
+  }
+
+  /**
+   * Reserve space for the given number of zero-initialized objects.
+   *
+   * @return the offset of the new objects
+   */
+  template<typename T>
+  uint32_t Allocate(size_t n) {
+    const size_t offset = (data.size() + ALIGN - 1) & ~(ALIGN - 1);
+    const size_t length = n * sizeof(T);
+    if (offset + length > UINT32_MAX)
+      throw std::runtime_error("Packed topography file too large");
+
+    data.resize(offset + length);
+    return offset;
+  }
+
+  template<typename T>
+  T &At(uint32_t offset) {
+    return *(T *)(data.data() + offset);
+  }
+
+  void Write(OutputStream &os) const {
+    os.Write(data.data(), data.size());
+  }
+};
+
+}
+
+/**
+ * Is this shape usable, i.e. does it have valid bounds and a
+ * supported type?
+ */
+gcc_pure
+static bool
+IsValidShape(const XShape &shape)
+{
+  return shape.GetPoints() != nullptr && !shape.GetLines().IsEmpty();
+}
+
+static unsigned
+CountPoints(const XShape &shape)
+{
+  unsigned n = 0;
+  for (auto i : shape.GetLines())
+    n += i;
+  return n;
+}
+
+static uint32_t
+AppendIndices(PackedBuffer &buffer, const XShape &shape, unsigned level,
+              float min_distance)
+{
+  if (shape.get_type() != MS_SHAPE_LINE &&
+      shape.get_type() != MS_SHAPE_POLYGON)
+    return 0;
+
+  const uint16_t *count;
+  const uint16_t *indices = shape.GetIndices(level, min_distance, count);
+  if (indices == nullptr)
+    return 0;
+
+  /* the counts precede the indices in the same buffer; see
+     XShape::BuildIndices() */
+  const unsigned n_counts = indices - count;
+  unsigned n_indices = 0;
+  for (unsigned i = 0; i < n_counts; ++i)
+    n_indices += count[i];
+
+  return buffer.Append(count, (n_counts + n_indices) * sizeof(*count));
+}
+
+static uint32_t
+AppendLabel(PackedBuffer &buffer, const XShape &shape)
+{
+  const TCHAR *label = shape.GetLabel();
+  if (label == nullptr)
+    return 0;
+
+#ifdef _UNICODE
+  const WideToUTF8Converter utf8(label);
+  if (!utf8.IsValid())
+    return 0;
+
+  const char *src = utf8;
+#else
+  const char *src = label;
+#endif
+
+  return buffer.Append(src, strlen(src) + 1);
+}
+
+void
+WritePackedTopography(OutputStream &os, const TopographyFile &file,
+                      const float min_distance[])
+{
+  const ScopeLock protect(file.mutex);
+
+  std::vector<const XShape *> shapes;
+  for (const XShape &shape : file)
+    shapes.push_back(&shape);
+
+  const unsigned n_shapes = shapes.size();
+
+  /* the spatial index covers the union of all valid shapes */
+
+  GeoBounds file_bounds = GeoBounds::Invalid();
+  unsigned n_valid = 0;
+  for (const XShape *shape : shapes) {
+    if (!IsValidShape(*shape))
+      continue;
+
+    if (file_bounds.IsValid()) {
+      file_bounds.Extend(shape->get_bounds().GetNorthWest());
+      file_bounds.Extend(shape->get_bounds().GetSouthEast());
+    } else
+      file_bounds = shape->get_bounds();
+    ++n_valid;
+  }
+
+  if (!file_bounds.IsValid())
+    throw std::runtime_error("Topography file is empty");
+
+  /* aim for about four shapes per cell */
+  const unsigned grid_size =
+    std::max(1u, std::min(256u, (unsigned)sqrt(n_valid / 4.)));
+
+  const Bounds b = ExportBounds(file_bounds);
+  std::vector<std::vector<uint32_t>> cells(grid_size * grid_size);
+  for (unsigned i = 0; i < n_shapes; ++i) {
+    const XShape &shape = *shapes[i];
+    if (!IsValidShape(shape))
+      continue;
+
+    const GeoBounds &sb = shape.get_bounds();
+    const unsigned x0 = ToCell(sb.GetWest().Native(), b.west, b.east,
+                               grid_size);
+    const unsigned x1 = ToCell(sb.GetEast().Native(), b.west, b.east,
+                               grid_size);
+    const unsigned y0 = ToCell(sb.GetSouth().Native(), b.south, b.north,
+                               grid_size);
+    const unsigned y1 = ToCell(sb.GetNorth().Native(), b.south, b.north,
+                               grid_size);
+
+    for (unsigned y = y0; y <= y1; ++y)
+      for (unsigned x = x0; x <= x1; ++x)
+        cells[y * grid_size + x].push_back(i);
+  }
+
+  PackedBuffer buffer;
+  buffer.Allocate<Header>(1);
+
+  {
+    Header &header = buffer.At<Header>(0);
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.n_shapes = n_shapes;
+    header.label_field = file.GetLabelField();
+    header.center_longitude = file.GetCenter().longitude.Native();
+    header.center_latitude = file.GetCenter().latitude.Native();
+    header.bounds = b;
+    std::copy_n(min_distance, THINNING_LEVELS, header.min_distance);
+    header.grid_width = header.grid_height = grid_size;
+  }
+
+  const uint32_t grid_cells = buffer.Allocate<uint32_t>(cells.size() + 1);
+  unsigned n_items = 0;
+  for (unsigned i = 0; i < cells.size(); ++i) {
+    buffer.At<uint32_t>(grid_cells + i * sizeof(uint32_t)) = n_items;
+    n_items += cells[i].size();
+  }
+  buffer.At<uint32_t>(grid_cells + cells.size() * sizeof(uint32_t)) = n_items;
+
+  const uint32_t grid_items = buffer.Allocate<uint32_t>(n_items);
+  uint32_t item = grid_items;
+  for (const auto &cell : cells) {
+    for (uint32_t i : cell) {
+      buffer.At<uint32_t>(item) = i;
+      item += sizeof(uint32_t);
+    }
+  }
+
+  const uint32_t shapes_offset = buffer.Allocate<Shape>(n_shapes);
+
+  for (unsigned i = 0; i < n_shapes; ++i) {
+    const XShape &shape = *shapes[i];
+
+    /* collect all referenced data before obtaining a reference to
+       the Shape, because Append() may reallocate the buffer */
+    Shape dest;
+    memset(&dest, 0, sizeof(dest));
+
+    if (IsValidShape(shape)) {
+      dest.bounds = ExportBounds(shape.get_bounds());
+      dest.type = shape.get_type();
+      dest.num_lines = shape.GetLines().size;
+      dest.n_points = CountPoints(shape);
+      dest.lines = buffer.Append(shape.GetLines().data,
+                                 dest.num_lines * sizeof(uint16_t));
+      dest.points = buffer.Append(shape.GetPoints(),
+                                  dest.n_points * sizeof(ShapePoint));
+      dest.label = AppendLabel(buffer, shape);
+
+      for (unsigned l = 0; l < THINNING_LEVELS; ++l)
+        dest.indices[l] = AppendIndices(buffer, shape, l, min_distance[l]);
+    } else
+      dest.type = MS_SHAPE_NULL;
+
+    buffer.At<Shape>(shapes_offset + i * sizeof(Shape)) = dest;
+  }
+
+  {
+    Header &header = buffer.At<Header>(0);
+    header.grid_cells = grid_cells;
+    header.grid_items = grid_items;
+    header.shapes = shapes_offset;
+  }
+
+  /* pad the file so its size is aligned */
+  buffer.Allocate<uint8_t>(0);
+
+  buffer.Write(os);
+}
@@ -0,0 +1,44 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TOPOGRAPHY_PACKED_WRITER_HPP
+#define XCSOAR_TOPOGRAPHY_PACKED_WRITER_HPP
+
+class OutputStream;
+class TopographyFile;
+
+/**
+ * Write the contents of a #TopographyFile as a packed topography
+ * file (see #PackedTopography).  The caller must have called
+ * TopographyFile::LoadAll() before.
+ *
+ * Throws std::exception on error.
+ *
+ * @param min_distance the "min_distance" parameter for building the
+ * indices of each thinning level; see XShape::GetIndices()
+ */
+void
+WritePackedTopography(OutputStream &os, const TopographyFile &file,
+                      const float min_distance[]);
+
+#endif
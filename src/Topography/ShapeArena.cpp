@@ -0,0 +1,152 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ShapeArena.hpp"
+
+#include <new>
+
+#include <assert.h>
+#include <stdlib.h>
+
+static constexpr size_t
+AlignSize(size_t size)
+{
+  return (size + 7) & ~size_t(7);
+}
+
+ShapeArena::Chunk *
+ShapeArena::NewChunk(size_t size)
+{
+  void *p = malloc(sizeof(Chunk) + size);
+  if (p == nullptr)
+    throw std::bad_alloc();
+
+  Chunk *chunk = ::new(p) Chunk(size);
+  chunks.push_front(*chunk);
+  reserved_bytes += sizeof(Chunk) + size;
+  return chunk;
+}
+
+void
+ShapeArena::DeleteChunk(Chunk &chunk)
+{
+  assert(chunk.n_allocations == 0);
+
+  reserved_bytes -= sizeof(Chunk) + chunk.size;
+  chunks.erase(chunks.iterator_to(chunk));
+  chunk.~Chunk();
+  free(&chunk);
+}
+
+void *
+ShapeArena::Allocate(size_t size)
+{
+  const size_t needed = sizeof(Header) + AlignSize(size);
+
+  const ScopeLock protect(mutex);
+
+  Chunk *chunk;
+  if (needed > MAX_SHARED_SIZE) {
+    /* big block: allocate a chunk just for this one */
+    chunk = NewChunk(needed);
+  } else {
+    if (current == nullptr ||
+        current->position + needed > current->size) {
+      if (current != nullptr && current->n_allocations == 0)
+        DeleteChunk(*current);
+
+      current = NewChunk(CHUNK_SIZE);
+    }
+
+    chunk = current;
+  }
+
+  Header *header = (Header *)(chunk->GetData() + chunk->position);
+  header->chunk = chunk;
+  header->size = needed;
+
+  chunk->position += needed;
+  ++chunk->n_allocations;
+  allocated_bytes += needed;
+
+  return header + 1;
+}
+
+void
+ShapeArena::Free(const void *p)
+{
+  if (p == nullptr)
+    return;
+
+  const Header *header = (const Header *)p - 1;
+  Chunk &chunk = *header->chunk;
+
+  const ScopeLock protect(mutex);
+
+  assert(chunk.n_allocations > 0);
+  assert(allocated_bytes >= header->size);
+
+  allocated_bytes -= header->size;
+
+  if (--chunk.n_allocations > 0)
+    return;
+
+  if (&chunk == current)
+    /* keep the current chunk, start over at its beginning */
+    chunk.position = 0;
+  else
+    DeleteChunk(chunk);
+}
+
+void
+ShapeArena::Shrink(const void *p, size_t size)
+{
+  Header *header = (Header *)const_cast<void *>(p) - 1;
+  const size_t needed = sizeof(Header) + AlignSize(size);
+  assert(needed <= header->size);
+
+  const ScopeLock protect(mutex);
+
+  Chunk &chunk = *header->chunk;
+  if (&chunk != current ||
+      (uint8_t *)header + header->size != chunk.GetData() + chunk.position)
+    /* not the most recent allocation */
+    return;
+
+  const size_t unused = header->size - needed;
+  chunk.position -= unused;
+  allocated_bytes -= unused;
+  header->size = needed;
+}
+
+void
+ShapeArena::Clear()
+{
+  const ScopeLock protect(mutex);
+
+  assert(allocated_bytes == 0);
+
+  current = nullptr;
+  while (!chunks.empty())
+    DeleteChunk(chunks.front());
+}
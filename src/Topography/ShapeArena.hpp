@@ -0,0 +1,176 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TOPOGRAPHY_SHAPE_ARENA_HPP
+#define XCSOAR_TOPOGRAPHY_SHAPE_ARENA_HPP
+
+#include "Thread/Mutex.hpp"
+#include "Compiler.h"
+
+#include <boost/intrusive/list.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A memory pool for the variable-sized payload (points, indices,
+ * labels) of the #XShape objects of one #TopographyFile.
+ *
+ * Allocations are carved sequentially out of big chunks.  Each chunk
+ * counts its allocations, and is returned to the system heap as soon
+ * as the last one is freed.  Shapes loaded by one cache update are
+ * usually evicted together, because they are close to each other, so
+ * this avoids fragmenting the heap with many small blocks.
+ *
+ * This class is thread-safe, because indices are built by the
+ * rendering thread while the cache is being updated.
+ */
+class ShapeArena {
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+  /**
+   * Allocations bigger than this get a chunk of their own.
+   */
+  static constexpr size_t MAX_SHARED_SIZE = CHUNK_SIZE / 4;
+
+  struct alignas(8) Chunk
+    : boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>> {
+    /**
+     * The size of the data area following this struct.
+     */
+    size_t size;
+
+    /**
+     * The offset of the first unused byte in the data area.
+     */
+    size_t position = 0;
+
+    /**
+     * The number of allocations which have not been freed yet.
+     */
+    unsigned n_allocations = 0;
+
+    explicit Chunk(size_t _size):size(_size) {}
+
+    uint8_t *GetData() {
+      return (uint8_t *)(this + 1);
+    }
+  };
+
+  /**
+   * Precedes each allocation.
+   */
+  struct alignas(8) Header {
+    Chunk *chunk;
+
+    /**
+     * The size of this allocation, including this header.
+     */
+    size_t size;
+  };
+
+  typedef boost::intrusive::list<Chunk,
+                                 boost::intrusive::constant_time_size<false>> ChunkList;
+
+  mutable Mutex mutex;
+
+  ChunkList chunks;
+
+  /**
+   * The chunk which new small allocations are carved from.  It is
+   * not freed when it becomes empty, but rewound.
+   */
+  Chunk *current = nullptr;
+
+  /**
+   * The number of payload bytes currently allocated.
+   */
+  size_t allocated_bytes = 0;
+
+  /**
+   * The number of bytes obtained from the system heap.
+   */
+  size_t reserved_bytes = 0;
+
+public:
+  ShapeArena() = default;
+  ShapeArena(const ShapeArena &) = delete;
+
+  ~ShapeArena() {
+    Clear();
+  }
+
+  /**
+   * Allocate an uninitialized memory block, aligned to 8 bytes.
+   */
+  gcc_malloc
+  void *Allocate(size_t size);
+
+  template<typename T>
+  gcc_malloc
+  T *Allocate(size_t n) {
+    return (T *)Allocate(n * sizeof(T));
+  }
+
+  /**
+   * Free a block which was allocated by this object.  Does nothing
+   * if the parameter is nullptr.
+   */
+  void Free(const void *p);
+
+  /**
+   * Shrink the given block, returning the unused tail to the pool.
+   * This works only for the most recent allocation of a shared
+   * chunk; in all other cases, this is a no-op.
+   */
+  void Shrink(const void *p, size_t size);
+
+  /**
+   * Release all chunks.  All blocks must have been freed already.
+   */
+  void Clear();
+
+  /**
+   * Returns the number of payload bytes currently allocated.
+   */
+  gcc_pure
+  size_t GetAllocatedBytes() const {
+    const ScopeLock protect(mutex);
+    return allocated_bytes;
+  }
+
+  /**
+   * Returns the number of bytes obtained from the system heap.
+   */
+  gcc_pure
+  size_t GetReservedBytes() const {
+    const ScopeLock protect(mutex);
+    return reserved_bytes;
+  }
+
+private:
+  Chunk *NewChunk(size_t size);
+  void DeleteChunk(Chunk &chunk);
+};
+
+#endif
@@ -23,12 +23,16 @@ Copyright_License {
 
 #include "Thread.hpp"
 #include "TopographyStore.hpp"
+#include "Thread/Parallel.hpp"
+
+#include <algorithm>
 
 TopographyThread::TopographyThread(TopographyStore &_store,
                                    std::function<void()> &&_callback)
   :StandbyThread("Topography"),
    store(_store),
    callback(std::move(_callback)),
+   n_workers(std::min(GetProcessorCount(), MAX_WORKERS)),
    last_bounds(GeoBounds::Invalid()) {}
 
 TopographyThread::~TopographyThread()
@@ -73,7 +77,11 @@ TopographyThread::Tick()
     const WindowProjection projection = next_projection;
 
     const ScopeUnlock unlock(mutex);
-    again = store.ScanVisibility(projection, 1) > 0;
+    again = store.ScanVisibility(projection, n_workers, n_workers) > 0;
+
+    if (again && callback)
+      /* let the renderer show the files updated so far */
+      callback();
   }
 
   /* notify the client that we have updated the topography cache */
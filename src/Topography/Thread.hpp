@@ -36,10 +36,21 @@ class TopographyStore;
  * A thread that loads topography files asynchronously.
  */
 class TopographyThread final : private StandbyThread {
+  /**
+   * The maximum number of files updated concurrently.  Most of the
+   * work is I/O on the same storage, so more would not help.
+   */
+  static constexpr unsigned MAX_WORKERS = 4;
+
   TopographyStore &store;
 
   const std::function<void()> callback;
 
+  /**
+   * The number of files updated concurrently.
+   */
+  const unsigned n_workers;
+
   WindowProjection next_projection;
 
   GeoBounds last_bounds;
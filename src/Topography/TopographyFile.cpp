@@ -25,11 +25,51 @@ Copyright_License {
 #include "Topography/XShape.hpp"
 #include "Convert.hpp"
 #include "Projection/WindowProjection.hpp"
+#include "Util/ScopeExit.hxx"
 
 #include <zzip/lib.h>
 
 #include <algorithm>
 
+#include <string.h>
+
+/**
+ * Serialises all shapefile I/O.  The files of one map share a
+ * zzip_dir, which is not thread-safe, but TopographyStore updates
+ * several files concurrently.
+ */
+static Mutex io_mutex;
+
+/**
+ * Attempt to load the packed version of the given shapefile, i.e.
+ * the same name with the suffix ".xtp".
+ */
+static bool
+LoadPacked(PackedTopographyFile &packed, zzip_dir *dir, const char *filename,
+           int label_field)
+{
+  const size_t length = strlen(filename);
+  if (length < 4 || length >= 256 ||
+      strcmp(filename + length - 4, ".shp") != 0)
+    return false;
+
+  char path[256];
+  memcpy(path, filename, length - 4);
+  strcpy(path + length - 4, ".xtp");
+
+  if (!packed.Load(dir, path))
+    return false;
+
+  if (packed.GetHeader().label_field != label_field ||
+      packed.GetShapeCount() == 0) {
+    /* packed with different settings: ignore it */
+    packed = PackedTopographyFile();
+    return false;
+  }
+
+  return true;
+}
+
 TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
                                double _threshold,
                                double _label_threshold,
@@ -46,6 +86,21 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
    important_label_threshold(_important_label_threshold),
    cache_bounds(GeoBounds::Invalid())
 {
+  if (LoadPacked(packed, dir, filename, label_field)) {
+    center = packed.GetCenter();
+
+    const unsigned n_shapes = packed.GetShapeCount();
+    shapes.ResizeDiscard(n_shapes);
+    std::fill(shapes.begin(), shapes.end(), ShapeList(nullptr));
+    packed_status.ResizeDiscard(n_shapes);
+
+    if (dir != nullptr)
+      ++dir->refcount;
+
+    ++serial;
+    return;
+  }
+
   if (msShapefileOpen(&file, "rb", dir, filename, 0) == -1)
     return;
 
@@ -78,7 +133,9 @@ TopographyFile::~TopographyFile()
     return;
 
   ClearCache();
-  msShapefileClose(&file);
+
+  if (!packed.IsDefined())
+    msShapefileClose(&file);
 
   if (dir != nullptr) {
     --dir->refcount;
@@ -90,18 +147,59 @@ void
 TopographyFile::ClearCache()
 {
   for (auto i = shapes.begin(), end = shapes.end(); i != end; ++i) {
-    delete i->shape;
-    i->shape = nullptr;
+    if (i->shape != nullptr) {
+      FreeShape(i->shape);
+      i->shape = nullptr;
+    }
   }
 
   first = nullptr;
+
+  /* all payload blocks have been freed: return the memory to the
+     system */
+  arena.Clear();
 }
 
-static XShape *
-LoadShape(shapefileObj *file, const GeoPoint &center, int i,
-          int label_field)
+XShape *
+TopographyFile::LoadShape(unsigned i)
 {
-  return new XShape(file, center, i, label_field);
+  XShape *shape = shape_allocator.allocate(1);
+
+  try {
+    if (packed.IsDefined()) {
+      shape_allocator.construct(shape, arena, packed, i);
+    } else {
+      shapeObj record;
+      msInitShape(&record);
+      AtScopeExit(&record) { msFreeShape(&record); };
+
+      const char *label = nullptr;
+
+      {
+        const ScopeLock protect(io_mutex);
+        msSHPReadShape(file.hSHP, i, &record);
+        if (label_field >= 0)
+          /* the returned buffer belongs to our DBF handle, it remains
+             valid after releasing the lock */
+          label = msDBFReadStringAttribute(file.hDBF, i, label_field);
+      }
+
+      shape_allocator.construct(shape, arena, record, center, label);
+    }
+  } catch (...) {
+    shape_allocator.deallocate(shape, 1);
+    throw;
+  }
+
+  return shape;
+}
+
+void
+TopographyFile::FreeShape(const XShape *shape)
+{
+  XShape *p = const_cast<XShape *>(shape);
+  shape_allocator.destroy(p);
+  shape_allocator.deallocate(p, 1);
 }
 
 bool
@@ -122,30 +220,45 @@ TopographyFile::Update(const WindowProjection &map_projection)
 
   cache_bounds = screenRect.Scale(2);
 
-  rectObj deg_bounds = ConvertRect(cache_bounds);
-
   // Test which shapes are inside the given bounds and save the
-  // status to file.status
-  switch (msShapefileWhichShapes(&file, dir, deg_bounds, 0)) {
-  case MS_FAILURE:
-    ClearCache();
-    return false;
+  // status to file.status (or packed_status)
+  if (packed.IsDefined()) {
+    if (!packed.WhichShapes(cache_bounds, packed_status.begin()))
+      /* screen is outside of map bounds */
+      return false;
+  } else {
+    rectObj deg_bounds = ConvertRect(cache_bounds);
+
+    int result;
+    {
+      const ScopeLock protect(io_mutex);
+      result = msShapefileWhichShapes(&file, dir, deg_bounds, 0);
+    }
 
-  case MS_DONE:
-    /* screen is outside of map bounds */
-    return false;
+    switch (result) {
+    case MS_FAILURE:
+      ClearCache();
+      return false;
 
-  case MS_SUCCESS:
-    break;
-  }
+    case MS_DONE:
+      /* screen is outside of map bounds */
+      return false;
 
-  assert(file.status != nullptr);
+    case MS_SUCCESS:
+      break;
+    }
+
+    assert(file.status != nullptr);
+  }
 
   // Iterate through the shapefile entries
   const ShapeList **current = &first;
   auto it = shapes.begin();
-  for (int i = 0; i < file.numshapes; ++i, ++it) {
-    if (!msGetBit(file.status, i)) {
+  for (unsigned i = 0; i < shapes.size(); ++i, ++it) {
+    const bool inside = packed.IsDefined()
+      ? packed_status[i]
+      : msGetBit(file.status, i);
+    if (!inside) {
       // If the shape is outside the bounds
       // delete the shape from the cache
       if (it->shape != nullptr) {
@@ -160,7 +273,7 @@ TopographyFile::Update(const WindowProjection &map_projection)
 
         /* now it's unreachable, and we can delete the XShape without
            holding a lock */
-        delete it->shape;
+        FreeShape(it->shape);
         it->shape = nullptr;
       }
     } else {
@@ -169,7 +282,7 @@ TopographyFile::Update(const WindowProjection &map_projection)
         assert(*current != it);
 
         // shape isn't cached yet -> cache the shape
-        it->shape = LoadShape(&file, center, i, label_field);
+        it->shape = LoadShape(i);
         it->next = *current;
 
         /* insert into linked list (protected) */
@@ -195,10 +308,10 @@ TopographyFile::LoadAll()
   // Iterate through the shapefile entries
   const ShapeList **current = &first;
   auto it = shapes.begin();
-  for (int i = 0; i < file.numshapes; ++i, ++it) {
+  for (unsigned i = 0; i < shapes.size(); ++i, ++it) {
     if (it->shape == nullptr)
       // shape isn't cached yet -> cache the shape
-      it->shape = LoadShape(&file, center, i, label_field);
+      it->shape = LoadShape(i);
     // update list pointer
     *current = it;
     current = &it->next;
@@ -209,6 +322,23 @@ TopographyFile::LoadAll()
   ++serial;
 }
 
+TopographyFile::CacheStatistics
+TopographyFile::GetCacheStatistics() const
+{
+  assert(mutex.IsLockedByCurrent());
+
+  unsigned n_shapes = 0;
+  for (auto i = begin(), e = end(); i != e; ++i)
+    ++n_shapes;
+
+  return {
+    n_shapes,
+    n_shapes * sizeof(XShape),
+    arena.GetAllocatedBytes(),
+    arena.GetReservedBytes(),
+  };
+}
+
 unsigned
 TopographyFile::GetSkipSteps(double map_scale) const
 {
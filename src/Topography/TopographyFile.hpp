@@ -25,9 +25,12 @@ Copyright_License {
 #ifndef TOPOGRAPHY_HPP
 #define TOPOGRAPHY_HPP
 
+#include "PackedTopography.hpp"
+#include "ShapeArena.hpp"
 #include "shapelib/mapserver.h"
 #include "Geo/GeoBounds.hpp"
 #include "Util/AllocatedArray.hxx"
+#include "Util/SliceAllocator.hpp"
 #include "Util/Serial.hpp"
 #include "Screen/Color.hpp"
 #include "ResourceId.hpp"
@@ -62,6 +65,27 @@ class TopographyFile {
 
   shapefileObj file;
 
+  /**
+   * The packed version of this file (*.xtp), if one was found next
+   * to the shapefile.  If it is defined, then #file is not opened.
+   */
+  PackedTopographyFile packed;
+
+  /**
+   * Receives the result of PackedTopographyFile::WhichShapes().
+   */
+  AllocatedArray<bool> packed_status;
+
+  /**
+   * Allocates the payload of all cached #XShape objects.
+   */
+  ShapeArena arena;
+
+  /**
+   * Allocates the cached #XShape objects.
+   */
+  SliceAllocator<XShape, 64> shape_allocator;
+
   /**
    * The center of shapefileObj::bounds.
    */
@@ -188,6 +212,17 @@ public:
     return center;
   }
 
+  int GetLabelField() const {
+    return label_field;
+  }
+
+  /**
+   * Was this file loaded from a packed topography file?
+   */
+  bool IsPacked() const {
+    return packed.IsDefined();
+  }
+
   bool IsEmpty() const {
     return shapes.empty();
   }
@@ -254,6 +289,36 @@ public:
     return const_iterator(nullptr);
   }
 
+  struct CacheStatistics {
+    /**
+     * The number of shapes in the cache.
+     */
+    unsigned n_shapes;
+
+    /**
+     * The memory occupied by the #XShape objects.
+     */
+    size_t shape_bytes;
+
+    /**
+     * The memory allocated for points, indices and labels.
+     */
+    size_t payload_bytes;
+
+    /**
+     * The memory reserved by the #ShapeArena, including unused
+     * space.
+     */
+    size_t reserved_bytes;
+  };
+
+  /**
+   * Determine the memory usage of the shape cache.  The caller is
+   * responsible for locking the mutex.
+   */
+  gcc_pure
+  CacheStatistics GetCacheStatistics() const;
+
   gcc_pure
   unsigned GetSkipSteps(double map_scale) const;
 
@@ -289,6 +354,11 @@ public:
 
 protected:
   void ClearCache();
+
+  gcc_malloc
+  XShape *LoadShape(unsigned i);
+
+  void FreeShape(const XShape *shape);
 };
 
 #endif
@@ -59,7 +59,7 @@ TopographyFileRenderer::TopographyFileRenderer(const TopographyFile &_file,
   :file(_file), look(_look),
    pen(Layout::ScaleFinePenWidth(file.GetPenWidth()), file.GetColor()),
 #ifdef ENABLE_OPENGL
-   array_buffer(nullptr)
+   array_buffer(nullptr), index_buffer(nullptr)
 #else
    brush(file.GetColor())
 #endif
@@ -79,6 +79,7 @@ TopographyFileRenderer::~TopographyFileRenderer()
   RemoveSurfaceListener(*this);
 
   delete array_buffer;
+  delete index_buffer;
 #endif
 }
 
@@ -95,6 +96,9 @@ TopographyFileRenderer::UpdateVisibleShapes(const WindowProjection &projection)
   visible_bounds = projection.GetScreenBounds().Scale(1.2);
   visible_shapes.clear();
   visible_labels.clear();
+#ifdef ENABLE_OPENGL
+  index_buffer_dirty = true;
+#endif
 
   for (const XShape &shape : file) {
     if (!visible_bounds.Overlaps(shape.get_bounds()))
@@ -144,6 +148,90 @@ TopographyFileRenderer::UpdateArrayBuffer()
   array_buffer->CommitWrite(n * sizeof(*p), p - n);
 }
 
+inline void
+TopographyFileRenderer::UpdateIndexBuffer(unsigned level,
+                                          ShapeScalar min_distance)
+{
+  if (index_buffer == nullptr)
+    index_buffer = new GLFallbackElementArrayBuffer();
+  else if (!index_buffer_dirty && level == index_buffer_level)
+    return;
+
+  index_buffer_dirty = false;
+  index_buffer_level = level;
+
+  /* pass 1: triangulate/thin all visible shapes and count the
+     indices */
+
+  visible_indices.clear();
+  visible_indices.reserve(visible_shapes.size());
+
+  unsigned n = 0;
+  for (const XShape *shape : visible_shapes) {
+    VisibleIndices v{nullptr, n, false};
+    const auto lines = shape->GetLines();
+    const GLushort *count;
+
+    switch (shape->get_type()) {
+    case MS_SHAPE_LINE:
+      if (level > 0 &&
+          shape->GetIndices(level, min_distance, count) != nullptr) {
+        v.count = count;
+        n = std::accumulate(count, count + lines.size, n);
+      }
+      break;
+
+    case MS_SHAPE_POLYGON:
+      if (shape->GetIndices(level, min_distance, count) != nullptr) {
+        const unsigned n_points =
+          std::accumulate(lines.begin(), lines.end(), 0u);
+
+        v.count = count;
+        v.absolute = shape->GetOffset() + n_points <= 0x10000;
+        n += *count;
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    visible_indices.push_back(v);
+  }
+
+  if (n == 0)
+    return;
+
+  /* pass 2: copy the indices to the buffer */
+
+  GLushort *p = (GLushort *)index_buffer->BeginWrite(n * sizeof(*p));
+  assert(p != nullptr);
+
+  for (unsigned i = 0; i < visible_shapes.size(); ++i) {
+    const VisibleIndices &v = visible_indices[i];
+    if (v.count == nullptr)
+      continue;
+
+    const XShape &shape = *visible_shapes[i];
+    const GLushort *count;
+    const GLushort *src = shape.GetIndices(level, min_distance, count);
+
+    if (shape.get_type() == MS_SHAPE_LINE) {
+      p = std::copy_n(src, std::accumulate(count,
+                                           count + shape.GetLines().size,
+                                           0u), p);
+    } else if (v.absolute) {
+      const unsigned offset = shape.GetOffset();
+      p = std::transform(src, src + *count, p, [offset](GLushort i){
+          return GLushort(offset + i);
+        });
+    } else
+      p = std::copy_n(src, *count, p);
+  }
+
+  index_buffer->CommitWrite(n * sizeof(*p), p - n);
+}
+
 inline void
 TopographyFileRenderer::PaintPoint(Canvas &canvas,
                                    const WindowProjection &projection,
@@ -218,9 +306,18 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 #endif
 
 #ifdef ENABLE_OPENGL
+  const unsigned level = file.GetThinningLevel(map_scale);
+  const ShapeScalar min_distance =
+    ShapeScalar(file.GetMinimumPointDistance(level))
+    / (Layout::Scale(1) * FAISphere::REARTH);
+
   UpdateArrayBuffer();
+  UpdateIndexBuffer(level, min_distance);
+
   const ShapePoint *const buffer = (const ShapePoint *)
     array_buffer->BeginRead();
+  const GLushort *const index_buffer_base = (const GLushort *)
+    index_buffer->BeginRead();
 
   pen.Bind();
 
@@ -235,11 +332,6 @@ TopographyFileRenderer::Paint(Canvas &canvas,
   // get drawing info
 
 #ifdef ENABLE_OPENGL
-  const unsigned level = file.GetThinningLevel(map_scale);
-  const ShapeScalar min_distance =
-    ShapeScalar(file.GetMinimumPointDistance(level))
-    / (Layout::Scale(1) * FAISphere::REARTH);
-
 #ifdef HAVE_GLES
   const float *const opengl_matrix = nullptr;
 #else
@@ -266,12 +358,17 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 
 #ifdef GL_EXT_multi_draw_arrays
   std::vector<GLsizei> polygon_counts;
-  std::vector<GLshort> polygon_indices;
+  std::vector<const GLushort *> polygon_pointers;
 #endif
+
+  auto visible_indices_i = visible_indices.begin();
 #endif
 
   for (const XShape *shape_p : visible_shapes) {
     const XShape &shape = *shape_p;
+#ifdef ENABLE_OPENGL
+    const VisibleIndices &indices = *visible_indices_i++;
+#endif
 
     const auto lines = shape.GetLines();
 #ifdef ENABLE_OPENGL
@@ -309,18 +406,18 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 #ifdef ENABLE_OPENGL
         vp.Update(GL_FLOAT, points);
 
-        const GLushort *indices, *count;
-        if (level == 0 ||
-            (indices = shape.GetIndices(level, min_distance, count)) == nullptr) {
+        if (indices.count == nullptr) {
           unsigned offset = 0;
           for (unsigned n : lines) {
             glDrawArrays(GL_LINE_STRIP, offset, n);
             offset += n;
           }
         } else {
-          for (unsigned n : ConstBuffer<GLushort>(count, lines.size)) {
-            glDrawElements(GL_LINE_STRIP, n, GL_UNSIGNED_SHORT, indices);
-            indices += n;
+          const GLushort *i = index_buffer_base + indices.offset;
+          for (unsigned n : ConstBuffer<GLushort>(indices.count,
+                                                  lines.size)) {
+            glDrawElements(GL_LINE_STRIP, n, GL_UNSIGNED_SHORT, i);
+            i += n;
           }
         }
 #else // !ENABLE_OPENGL
@@ -342,27 +439,21 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 
     case MS_SHAPE_POLYGON:
 #ifdef ENABLE_OPENGL
-      {
-        const GLushort *index_count;
-        const GLushort *triangles = shape.GetIndices(level, min_distance,
-                                                     index_count);
-        const unsigned n = *index_count;
+      if (indices.count != nullptr) {
+        const unsigned n = *indices.count;
+        const GLushort *triangles = index_buffer_base + indices.offset;
 
 #ifdef GL_EXT_multi_draw_arrays
-        const unsigned offset = shape.GetOffset();
-        if (GLExt::HaveMultiDrawElements() && offset + n < 0x10000) {
+        if (indices.absolute && GLExt::HaveMultiDrawElements()) {
           /* postpone, draw many polygons with a single
              glMultiDrawElements() call */
           polygon_counts.push_back(n);
-          const size_t size = polygon_indices.size();
-          polygon_indices.resize(size + n, offset);
-          for (unsigned i = 0; i < n; ++i)
-            polygon_indices[size + i] += triangles[i];
+          polygon_pointers.push_back(triangles);
           break;
         }
 #endif
 
-        vp.Update(GL_FLOAT, points);
+        vp.Update(GL_FLOAT, indices.absolute ? buffer : points);
         glDrawElements(GL_TRIANGLE_STRIP, n, GL_UNSIGNED_SHORT,
                        triangles);
       }
@@ -404,17 +495,10 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 #ifdef ENABLE_OPENGL
 
 #ifdef GL_EXT_multi_draw_arrays
-  if (!polygon_indices.empty()) {
+  if (!polygon_counts.empty()) {
     assert(GLExt::HaveMultiDrawElements());
 
-    std::vector<const GLshort *> polygon_pointers;
-    unsigned i = 0;
-    for (auto count : polygon_counts) {
-      polygon_pointers.push_back(polygon_indices.data() + i);
-      i += count;
-    }
-
-    vp.Update(GL_FLOAT, nullptr);
+    vp.Update(GL_FLOAT, buffer);
 
     GLExt::MultiDrawElements(GL_TRIANGLE_STRIP, polygon_counts.data(),
                              GL_UNSIGNED_SHORT,
@@ -434,6 +518,7 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 
   pen.Unbind();
 
+  index_buffer->EndRead();
   array_buffer->EndRead();
 #else
   shape_renderer.Commit();
@@ -544,6 +629,9 @@ TopographyFileRenderer::SurfaceDestroyed()
 {
   delete array_buffer;
   array_buffer = nullptr;
+
+  delete index_buffer;
+  index_buffer = nullptr;
 }
 
 #endif
@@ -31,6 +31,7 @@ Copyright_License {
 
 #ifdef ENABLE_OPENGL
 #include "Screen/OpenGL/Surface.hpp"
+#include "Topography/XShapePoint.hpp"
 #else
 #include "Screen/Brush.hpp"
 #include "Topography/ShapeRenderer.hpp"
@@ -41,6 +42,7 @@ Copyright_License {
 class TopographyFile;
 class Canvas;
 class GLFallbackArrayBuffer;
+class GLFallbackElementArrayBuffer;
 class WindowProjection;
 class LabelBlock;
 class XShape;
@@ -79,6 +81,48 @@ class TopographyFileRenderer final
 #ifdef ENABLE_OPENGL
   GLFallbackArrayBuffer *array_buffer;
   Serial array_buffer_serial;
+
+  /**
+   * The indices of all #visible_shapes at thinning level
+   * #index_buffer_level, uploaded once instead of being passed from
+   * client memory on every frame.
+   */
+  GLFallbackElementArrayBuffer *index_buffer;
+  unsigned index_buffer_level;
+
+  /**
+   * Set by UpdateVisibleShapes() when the #index_buffer must be
+   * rebuilt.
+   */
+  bool index_buffer_dirty;
+
+  /**
+   * Describes where the indices of one element of #visible_shapes
+   * are in #index_buffer.
+   */
+  struct VisibleIndices {
+    /**
+     * The number of indices per line (MS_SHAPE_LINE) or the total
+     * number of indices (MS_SHAPE_POLYGON), owned by the #XShape.
+     * nullptr if the shape is not drawn from the #index_buffer.
+     */
+    const unsigned short *count;
+
+    /**
+     * The position of the first index in #index_buffer.
+     */
+    unsigned offset;
+
+    /**
+     * Are the indices relative to the start of the #array_buffer
+     * (instead of relative to the shape's first point)?  This
+     * allows drawing many polygons with one glMultiDrawElements()
+     * call.
+     */
+    bool absolute;
+  };
+
+  std::vector<VisibleIndices> visible_indices;
 #endif
 
 public:
@@ -112,6 +156,7 @@ private:
 
 #ifdef ENABLE_OPENGL
   void UpdateArrayBuffer();
+  void UpdateIndexBuffer(unsigned level, ShapeScalar min_distance);
 
   void PaintPoint(Canvas &canvas, const WindowProjection &projection,
                   const XShape &shape, const float *opengl_matrix) const;
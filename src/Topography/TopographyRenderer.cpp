@@ -23,11 +23,16 @@ Copyright_License {
 
 #include "Topography/TopographyRenderer.hpp"
 #include "Topography/TopographyFileRenderer.hpp"
+#include "OS/Clock.hpp"
+
+#include <algorithm>
 
 TopographyRenderer::TopographyRenderer(const TopographyStore &_store,
                                        const TopographyLook &look)
   :store(_store)
 {
+  draw_statistics.Reset();
+
   for (unsigned i = 0; i < store.size(); ++i)
     files.append(new TopographyFileRenderer(store[i], look));
 }
@@ -42,8 +47,16 @@ void
 TopographyRenderer::Draw(Canvas &canvas,
                          const WindowProjection &projection) const
 {
+  const uint64_t start = MonotonicClockUS();
+
   for (auto it = files.begin(), end = files.end(); it != end; ++it)
     (*it)->Paint(canvas, projection);
+
+  const uint64_t duration = MonotonicClockUS() - start;
+  ++draw_statistics.n_frames;
+  draw_statistics.total_us += duration;
+  draw_statistics.max_us = std::max(draw_statistics.max_us, duration);
+  draw_statistics.last_us = duration;
 }
 
 void
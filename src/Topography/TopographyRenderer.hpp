@@ -27,6 +27,8 @@ Copyright_License {
 #include "Topography/TopographyStore.hpp"
 #include "Util/StaticArray.hxx"
 
+#include <stdint.h>
+
 class Canvas;
 class WindowProjection;
 class LabelBlock;
@@ -37,9 +39,31 @@ struct TopographyLook;
  * Class used to manage and render vector topography layers
  */
 class TopographyRenderer : private NonCopyable {
+public:
+  /**
+   * How long Draw() took.  This measures the CPU time spent
+   * submitting the frame, not the time the GPU spends rendering it.
+   */
+  struct DrawStatistics {
+    unsigned n_frames;
+    uint64_t total_us, max_us, last_us;
+
+    void Reset() {
+      n_frames = 0;
+      total_us = max_us = last_us = 0;
+    }
+
+    uint64_t GetAverageUS() const {
+      return n_frames > 0 ? total_us / n_frames : 0;
+    }
+  };
+
+private:
   const TopographyStore &store;
   StaticArray<TopographyFileRenderer *, TopographyStore::MAXTOPOGRAPHY> files;
 
+  mutable DrawStatistics draw_statistics;
+
 public:
   TopographyRenderer(const TopographyStore &store, const TopographyLook &look);
 
@@ -60,6 +84,14 @@ public:
 
   void DrawLabels(Canvas &canvas, const WindowProjection &projection,
                   LabelBlock &label_block) const;
+
+  const DrawStatistics &GetDrawStatistics() const {
+    return draw_statistics;
+  }
+
+  void ResetDrawStatistics() {
+    draw_statistics.Reset();
+  }
 };
 
 #endif
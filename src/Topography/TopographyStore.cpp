@@ -31,6 +31,10 @@ Copyright_License {
 #include "Compatibility/path.h"
 #include "Asset.hpp"
 #include "Resources.hpp"
+#include "Thread/Parallel.hpp"
+#include "Thread/Util.hpp"
+
+#include <atomic>
 
 #include <stdint.h>
 #include <windef.h> // for MAX_PATH
@@ -107,21 +111,38 @@ TopographyStore::GetNextScaleThreshold(double map_scale) const
 
 unsigned
 TopographyStore::ScanVisibility(const WindowProjection &m_projection,
-                              unsigned max_update)
+                                unsigned max_update, unsigned n_workers)
 {
   // check if any needs to have cache updates because wasnt
   // visible previously when bounds moved
 
   // we will make sure we update at least one cache per call
   // to make sure eventually everything gets refreshed
-  unsigned num_updated = 0;
-  for (auto *file : files) {
-    if (file->Update(m_projection)) {
-      ++num_updated;
-      if (num_updated >= max_update)
-        break;
-    }
-  }
+
+  /* the files are independent of each other; each worker picks the
+     next file from the list until enough files have been updated.
+     TopographyFile::Update() publishes its results through the
+     file's mutex, so the renderer may pick up each file as soon as
+     it is done */
+  std::atomic<unsigned> next(0), num_updated(0);
+
+  const auto worker = [&](unsigned index){
+    if (index > 0)
+      /* like the TopographyThread */
+      SetThreadIdlePriority();
+
+    unsigned i;
+    while (num_updated.load(std::memory_order_relaxed) < max_update &&
+           (i = next.fetch_add(1, std::memory_order_relaxed)) < files.size())
+      if (files[i]->Update(m_projection))
+        num_updated.fetch_add(1, std::memory_order_relaxed);
+  };
+
+  n_workers = std::min(n_workers, std::min(max_update, unsigned(files.size())));
+  if (n_workers > 1)
+    ParallelRun(n_workers, worker);
+  else
+    worker(0);
 
   serial += num_updated;
   return num_updated;
@@ -72,6 +72,10 @@ public:
     return *files[i];
   }
 
+  TopographyFile &operator [](unsigned i) {
+    return *files[i];
+  }
+
   /**
    * @see TopographyFile::GetNextScaleThreshold()
    */
@@ -80,11 +84,15 @@ public:
 
   /**
    * @param max_update the maximum number of files updated in this
-   * call
+   * call; with more than one worker, this may be exceeded by up to
+   * n_workers-1
+   * @param n_workers the number of files which are updated
+   * concurrently
    * @return the number of files which were updated
    */
   unsigned ScanVisibility(const WindowProjection &m_projection,
-                          unsigned max_update=1024);
+                          unsigned max_update=1024,
+                          unsigned n_workers=1);
 
   /**
    * Load all shapes of all files into memory.  For debugging
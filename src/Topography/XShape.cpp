@@ -22,11 +22,13 @@ Copyright_License {
 */
 
 #include "Topography/XShape.hpp"
+#include "Topography/PackedTopography.hpp"
+#include "Topography/XShapePoint.hpp"
+#include "Topography/ShapeArena.hpp"
 #include "Convert.hpp"
 #include "Util/StringAPI.hxx"
 #include "Util/UTF8.hpp"
 #include "Util/StringUtil.hpp"
-#include "Util/ScopeExit.hxx"
 
 #ifdef ENABLE_OPENGL
 #include "Projection/Projection.hpp"
@@ -41,8 +43,30 @@ Copyright_License {
 
 #include <tchar.h>
 
-static AllocatedString<TCHAR>
-ImportLabel(const char *src)
+/**
+ * Copy a valid UTF-8 label to the #ShapeArena.
+ */
+static const TCHAR *
+DuplicateLabel(ShapeArena &arena, const char *src)
+{
+#ifdef _UNICODE
+  const UTF8ToWideConverter converted(src);
+  if (!converted.IsValid())
+    return nullptr;
+
+  const TCHAR *value = converted;
+#else
+  const char *value = src;
+#endif
+
+  const size_t size = StringLength(value) + 1;
+  TCHAR *dest = arena.Allocate<TCHAR>(size);
+  std::copy_n(value, size, dest);
+  return dest;
+}
+
+static const TCHAR *
+ImportLabel(ShapeArena &arena, const char *src)
 {
   if (src == nullptr)
     return nullptr;
@@ -53,14 +77,12 @@ ImportLabel(const char *src)
       StringIsEqual(src, "UNK"))
     return nullptr;
 
-#ifdef _UNICODE
-  return AllocatedString<TCHAR>::Donate(ConvertUTF8ToWide(src));
-#else
+#ifndef _UNICODE
   if (!ValidateUTF8(src))
     return nullptr;
-
-  return AllocatedString<TCHAR>::Duplicate(src);
 #endif
+
+  return DuplicateLabel(arena, src);
 }
 
 /**
@@ -87,20 +109,17 @@ GetMinPointsForShapeType(int shapelib_type)
   }
 }
 
-XShape::XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
-               int label_field)
-  :label(nullptr)
+XShape::XShape(ShapeArena &_arena, const shapeObj &shape,
+               const GeoPoint &file_center, const char *_label)
+  :arena(_arena), label(nullptr)
 {
 #ifdef ENABLE_OPENGL
   std::fill_n(index_count, THINNING_LEVELS, nullptr);
   std::fill_n(indices, THINNING_LEVELS, nullptr);
+  packed_points = false;
+  packed_levels = 0;
 #endif
 
-  shapeObj shape;
-  msInitShape(&shape);
-  AtScopeExit(&shape) { msFreeShape(&shape); };
-  msSHPReadShape(shpfile->hSHP, i, &shape);
-
   bounds = ImportRect(shape.bounds);
   if (!bounds.Check()) {
     /* malformed bounds */
@@ -136,14 +155,13 @@ XShape::XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
   /* OpenGL: convert GeoPoints to ShapePoints, make them relative to
      the map's boundary center */
 
-  points = new ShapePoint[num_points];
-  ShapePoint *p = points;
+  ShapePoint *p = arena.Allocate<ShapePoint>(num_points);
 #else // !ENABLE_OPENGL
   /* convert all points of all lines to GeoPoints */
 
-  points = new GeoPoint[num_points];
-  GeoPoint *p = points;
+  GeoPoint *p = arena.Allocate<GeoPoint>(num_points);
 #endif
+  points = p;
   for (unsigned l = 0; l < num_lines; ++l) {
     const pointObj *src = shape.line[l].point;
     num_points = lines[l];
@@ -161,20 +179,74 @@ XShape::XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
     }
   }
 
-  if (label_field >= 0) {
-    const char *src = msDBFReadStringAttribute(shpfile->hDBF, i, label_field);
-    label = ImportLabel(src);
+  label = ImportLabel(arena, _label);
+}
+
+XShape::XShape(ShapeArena &_arena, const PackedTopographyFile &file,
+               unsigned i)
+  :arena(_arena), label(nullptr)
+{
+  using namespace PackedTopography;
+
+  const Shape &src = file.GetShape(i);
+
+  bounds = ImportBounds(src.bounds);
+  type = src.type;
+  num_lines = src.num_lines;
+
+  const uint16_t *src_lines = file.At<uint16_t>(src.lines);
+  std::copy_n(src_lines, num_lines, lines);
+
+#ifdef ENABLE_OPENGL
+  /* the file contains ShapePoints relative to its center already,
+     and the indices of all thinning levels; use them in-place */
+
+  points = file.At<ShapePoint>(src.points);
+  packed_points = true;
+  packed_levels = 0;
+
+  for (unsigned l = 0; l < THINNING_LEVELS; ++l) {
+    if (src.indices[l] == 0) {
+      index_count[l] = indices[l] = nullptr;
+      continue;
+    }
+
+    index_count[l] = file.At<uint16_t>(src.indices[l]);
+    indices[l] = index_count[l] + (type == MS_SHAPE_LINE ? num_lines : 1);
+    packed_levels |= 1 << l;
+  }
+#else // !ENABLE_OPENGL
+  const GeoPoint center = file.GetCenter();
+  const ShapePoint *src_points = file.At<ShapePoint>(src.points);
+
+  GeoPoint *p = arena.Allocate<GeoPoint>(src.n_points);
+  points = p;
+  for (unsigned j = 0; j < src.n_points; ++j)
+    *p++ = GeoPoint(center.longitude + Angle::Native(src_points[j].x),
+                    center.latitude + Angle::Native(src_points[j].y));
+#endif
+
+  if (src.label != 0) {
+    /* the label has been filtered by ImportLabel() already */
+    label = DuplicateLabel(arena, file.At<char>(src.label));
   }
 }
 
 XShape::~XShape()
 {
-  delete[] points;
 #ifdef ENABLE_OPENGL
+  if (!packed_points)
+    arena.Free(points);
+
   // Note: index_count and indices share one buffer
   for (unsigned i = 0; i < THINNING_LEVELS; i++)
-    delete[] index_count[i];
+    if (!(packed_levels & (1 << i)))
+      arena.Free(index_count[i]);
+#else
+  arena.Free(points);
 #endif
+
+  arena.Free(label);
 }
 
 #ifdef ENABLE_OPENGL
@@ -194,7 +266,7 @@ XShape::BuildIndices(unsigned thinning_level, ShapeScalar min_distance)
     if (num_points <= 2)
       return false;  // line cannot be simplified, so don't create indices
     index_count[thinning_level] = idx_count =
-      new GLushort[num_lines + num_points];
+      arena.Allocate<GLushort>(num_lines + num_points);
     indices[thinning_level] = idx = idx_count + num_lines;
 
     const uint16_t *end_l = lines + num_lines;
@@ -220,11 +292,13 @@ XShape::BuildIndices(unsigned thinning_level, ShapeScalar min_distance)
       p++; i++;
       *idx_count++ = idx - after_first_idx + 1;
     }
-    // TODO: free memory saved by thinning (use malloc/realloc or some class?)
+    // free memory saved by thinning
+    arena.Shrink(index_count[thinning_level],
+                 (idx - index_count[thinning_level]) * sizeof(*idx));
     return true;
   } else if (type == MS_SHAPE_POLYGON) {
     index_count[thinning_level] = idx_count =
-      new GLushort[1 + 3*(num_points-2) + 2*(num_lines-1)];
+      arena.Allocate<GLushort>(1 + 3*(num_points-2) + 2*(num_lines-1));
     indices[thinning_level] = idx = idx_count + 1;
 
     *idx_count = 0;
@@ -242,7 +316,8 @@ XShape::BuildIndices(unsigned thinning_level, ShapeScalar min_distance)
       pt += lines[i];
     }
     *idx_count = TriangleToStrip(idx, *idx_count, num_points, num_lines);
-    // TODO: free memory saved by thinning (use malloc/realloc or some class?)
+    // free memory saved by thinning
+    arena.Shrink(idx_count, (1 + *idx_count) * sizeof(*idx_count));
     return true;
   } else {
     gcc_unreachable();
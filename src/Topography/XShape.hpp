@@ -26,7 +26,6 @@ Copyright_License {
 #define TOPOGRAPHY_XSHAPE_HPP
 
 #include "Util/ConstBuffer.hxx"
-#include "Util/AllocatedString.hxx"
 #include "Geo/GeoBounds.hpp"
 #include "shapelib/mapserver.h"
 #include "shapelib/mapshape.h"
@@ -38,6 +37,8 @@ Copyright_License {
 #include <stdint.h>
 
 struct GeoPoint;
+class PackedTopographyFile;
+class ShapeArena;
 
 class XShape {
   static constexpr unsigned MAX_LINES = 32;
@@ -45,6 +46,11 @@ class XShape {
   static constexpr unsigned THINNING_LEVELS = 4;
 #endif
 
+  /**
+   * The points, indices and the label are allocated here.
+   */
+  ShapeArena &arena;
+
   GeoBounds bounds;
 
   uint8_t type;
@@ -65,12 +71,12 @@ class XShape {
    * All points of all lines.
    */
 #ifdef ENABLE_OPENGL
-  ShapePoint *points;
+  const ShapePoint *points;
 
   /**
    * Indices of polygon triangles or lines with reduced number of vertices.
    */
-  uint16_t *indices[THINNING_LEVELS];
+  const uint16_t *indices[THINNING_LEVELS];
 
   /**
    * For polygons this will contain the total number of triangle vertices
@@ -78,7 +84,18 @@ class XShape {
    * For lines there will be an array of size num_lines for each thinning
    * level, which contains the number of points for each line.
    */
-  uint16_t *index_count[THINNING_LEVELS];
+  const uint16_t *index_count[THINNING_LEVELS];
+
+  /**
+   * If true, then #points is owned by a #PackedTopographyFile.
+   */
+  bool packed_points;
+
+  /**
+   * A bit mask of thinning levels whose #index_count buffer is owned
+   * by a #PackedTopographyFile.
+   */
+  uint8_t packed_levels;
 
   /**
    * The start offset in the #GLArrayBuffer (vertex buffer object).
@@ -89,11 +106,24 @@ class XShape {
   GeoPoint *points;
 #endif
 
-  AllocatedString<TCHAR> label;
+  const TCHAR *label;
 
 public:
-  XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
-         int label_field=-1);
+  /**
+   * Construct the shape from a shapefile record.
+   *
+   * @param label the raw label attribute from the DBF file, or
+   * nullptr if there is none
+   */
+  XShape(ShapeArena &arena, const shapeObj &shape,
+         const GeoPoint &file_center, const char *label);
+
+  /**
+   * Construct the shape from a packed topography file.  Points and
+   * indices are not copied; the #PackedTopographyFile must outlive
+   * this object.
+   */
+  XShape(ShapeArena &arena, const PackedTopographyFile &file, unsigned i);
 
   XShape(const XShape &) = delete;
 
@@ -138,7 +168,7 @@ public:
   }
 
   const TCHAR *GetLabel() const {
-    return label.c_str();
+    return label;
   }
 };
 
@@ -28,21 +28,111 @@ Copyright_License {
 #include "OS/ByteOrder.hpp"
 #include "Util/CRC.hpp"
 
+#include <assert.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <errno.h>
+#endif
+
 namespace SkyLinesTracking {
 
+/**
+ * One receive socket with its own buffer.  Each receiver has at
+ * most one pending receive operation, therefore its handler never
+ * runs concurrently with itself, but it may run concurrently with
+ * other receivers' handlers.
+ */
+class Server::Receiver {
+  Server &server;
+
+  boost::asio::ip::udp::socket socket;
+
+  uint8_t buffer[4096];
+
+  Client client_buffer;
+
+public:
+  Receiver(Server &_server, boost::asio::io_service &io_service,
+           boost::asio::ip::udp::endpoint endpoint, bool reuse_port)
+    :server(_server), socket(io_service) {
+    socket.open(endpoint.protocol());
+
+#ifdef SO_REUSEPORT
+    if (reuse_port) {
+      const int value = 1;
+      if (setsockopt(socket.native_handle(), SOL_SOCKET, SO_REUSEPORT,
+                     &value, sizeof(value)) < 0)
+        throw boost::system::system_error(errno,
+                                          boost::system::system_category(),
+                                          "Failed to set SO_REUSEPORT");
+    }
+#else
+    (void)reuse_port;
+#endif
+
+    socket.bind(endpoint);
+  }
+
+  ~Receiver() {
+    if (socket.is_open()) {
+      socket.cancel();
+      socket.close();
+    }
+  }
+
+  boost::asio::ip::udp::socket &GetSocket() {
+    return socket;
+  }
+
+  void AsyncReceive() {
+    socket.async_receive_from(boost::asio::buffer(buffer, sizeof(buffer)),
+                              client_buffer.endpoint,
+                              std::bind(&Receiver::OnReceive, this,
+                                        std::placeholders::_1,
+                                        std::placeholders::_2));
+  }
+
+private:
+  void OnReceive(const boost::system::error_code &ec, size_t size);
+};
+
 Server::Server(boost::asio::io_service &io_service,
-               boost::asio::ip::udp::endpoint endpoint)
-  :socket(io_service, endpoint)
+               boost::asio::ip::udp::endpoint endpoint,
+               unsigned n_sockets)
 {
-  AsyncReceive();
+  assert(n_sockets > 0);
+
+#ifndef SO_REUSEPORT
+  n_sockets = 1;
+#endif
+
+  const bool reuse_port = n_sockets > 1;
+  for (unsigned i = 0; i < n_sockets; ++i)
+    receivers.emplace_back(new Receiver(*this, io_service, endpoint,
+                                        reuse_port));
+
+  for (auto &i : receivers)
+    i->AsyncReceive();
+}
+
+Server::~Server() = default;
+
+boost::asio::io_service &
+Server::get_io_service()
+{
+  return receivers.front()->GetSocket().get_io_service();
 }
 
-Server::~Server()
+inline boost::asio::ip::udp::socket &
+Server::GetSendSocket()
 {
-  if (socket.is_open()) {
-    socket.cancel();
-    socket.close();
-  }
+  /* all sockets are bound to the same address, so it doesn't matter
+     which one is used for sending; synchronous sends on one socket
+     from several threads are safe, they map directly to a system
+     call */
+  return receivers.front()->GetSocket();
 }
 
 void
@@ -52,12 +142,90 @@ Server::SendBuffer(const boost::asio::ip::udp::endpoint &endpoint,
   // TODO: use async_send_to()?
 
   try {
-    socket.send_to(boost::asio::const_buffers_1(data), endpoint, 0);
+    GetSendSocket().send_to(boost::asio::const_buffers_1(data), endpoint, 0);
   } catch (std::runtime_error e) {
     OnSendError(endpoint, std::move(e));
   }
 }
 
+void
+Server::SendQueue::Push(const boost::asio::ip::udp::endpoint &endpoint,
+                        boost::asio::const_buffer data)
+{
+  const size_t size = boost::asio::buffer_size(data);
+  assert(size <= BUFFER_SIZE);
+
+  if (n_datagrams == MAX_DATAGRAMS || fill + size > BUFFER_SIZE)
+    Flush();
+
+  auto &d = datagrams[n_datagrams++];
+  d.endpoint = endpoint;
+  d.offset = fill;
+  d.size = size;
+
+  memcpy(buffer + fill, boost::asio::buffer_cast<const void *>(data), size);
+  fill += size;
+}
+
+void
+Server::SendQueue::Flush()
+{
+  unsigned i = 0;
+
+#ifdef __linux__
+  struct iovec iov[MAX_DATAGRAMS];
+  struct mmsghdr msgs[MAX_DATAGRAMS];
+
+  for (unsigned j = 0; j < n_datagrams; ++j) {
+    auto &d = datagrams[j];
+    iov[j].iov_base = buffer + d.offset;
+    iov[j].iov_len = d.size;
+
+    auto &h = msgs[j].msg_hdr;
+    memset(&h, 0, sizeof(h));
+    h.msg_name = d.endpoint.data();
+    h.msg_namelen = d.endpoint.size();
+    h.msg_iov = &iov[j];
+    h.msg_iovlen = 1;
+    msgs[j].msg_len = 0;
+  }
+
+  const int fd = server.GetSendSocket().native_handle();
+
+  while (i < n_datagrams) {
+    int n = sendmmsg(fd, msgs + i, n_datagrams - i, MSG_DONTWAIT);
+    if (n > 0) {
+      i += n;
+      continue;
+    }
+
+    if (errno == EINTR)
+      continue;
+
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      /* the socket buffer is full; let the blocking code path below
+         handle the rest */
+      break;
+
+    /* this datagram failed; skip it and continue with the rest */
+    server.OnSendError(datagrams[i].endpoint,
+                       boost::system::system_error(errno,
+                                                   boost::system::system_category(),
+                                                   "sendmmsg() failed"));
+    ++i;
+  }
+#endif
+
+  for (; i < n_datagrams; ++i) {
+    const auto &d = datagrams[i];
+    server.SendBuffer(d.endpoint,
+                      boost::asio::const_buffer(buffer + d.offset, d.size));
+  }
+
+  n_datagrams = 0;
+  fill = 0;
+}
+
 void
 Server::OnPing(const Client &client, unsigned id)
 {
@@ -170,7 +338,7 @@ Server::OnDatagramReceived(Client &&client,
 }
 
 void
-Server::OnReceive(const boost::system::error_code &ec, size_t size)
+Server::Receiver::OnReceive(const boost::system::error_code &ec, size_t size)
 {
   // TODO: use recvmmsg() on Linux
 
@@ -180,23 +348,13 @@ Server::OnReceive(const boost::system::error_code &ec, size_t size)
 
     socket.close();
 
-    OnError(boost::system::system_error(ec));
+    server.OnError(boost::system::system_error(ec));
     return;
   }
 
-  OnDatagramReceived(std::move(client_buffer), buffer, size);
+  server.OnDatagramReceived(std::move(client_buffer), buffer, size);
 
   AsyncReceive();
 }
 
-void
-Server::AsyncReceive()
-{
-  socket.async_receive_from(boost::asio::buffer(buffer, sizeof(buffer)),
-                            client_buffer.endpoint,
-                            std::bind(&Server::OnReceive, this,
-                                      std::placeholders::_1,
-                                      std::placeholders::_2));
-}
-
 }
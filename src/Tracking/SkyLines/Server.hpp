@@ -26,7 +26,10 @@ Copyright_License {
 
 #include <boost/asio/ip/udp.hpp>
 
+#include <array>
 #include <chrono>
+#include <memory>
+#include <vector>
 
 #include <stdint.h>
 
@@ -39,24 +42,35 @@ namespace SkyLinesTracking {
  *
  * To use this class, derive your class from it and implement the
  * virtual methods.
+ *
+ * The server may receive on several sockets bound to the same port
+ * (SO_REUSEPORT), and the kernel distributes incoming datagrams
+ * among them.  If the io_service is run by several threads, the
+ * virtual methods may then be invoked concurrently, and the derived
+ * class is responsible for protecting its data.
  */
 class Server {
-  boost::asio::ip::udp::socket socket;
-
-  uint8_t buffer[4096];
-
 public:
   struct Client {
     boost::asio::ip::udp::endpoint endpoint;
     uint64_t key;
   };
 
+  class SendQueue;
+
 private:
-  Client client_buffer;
+  class Receiver;
+
+  std::vector<std::unique_ptr<Receiver>> receivers;
 
 public:
+  /**
+   * @param n_sockets the number of receive sockets; values above 1
+   * are only effective on platforms supporting SO_REUSEPORT
+   */
   Server(boost::asio::io_service &io_service,
-         boost::asio::ip::udp::endpoint endpoint);
+         boost::asio::ip::udp::endpoint endpoint,
+         unsigned n_sockets=1);
 
   ~Server();
 
@@ -70,8 +84,13 @@ public:
     return "5597";
   }
 
-  boost::asio::io_service &get_io_service() {
-    return socket.get_io_service();
+  boost::asio::io_service &get_io_service();
+
+  /**
+   * Returns the number of receive sockets.
+   */
+  unsigned GetSocketCount() const {
+    return receivers.size();
   }
 
   void SendBuffer(const boost::asio::ip::udp::endpoint &endpoint,
@@ -84,9 +103,9 @@ public:
   }
 
 private:
+  boost::asio::ip::udp::socket &GetSendSocket();
+
   void OnDatagramReceived(Client &&client, void *data, size_t length);
-  void OnReceive(const boost::system::error_code &ec, size_t size);
-  void AsyncReceive();
 
 protected:
   virtual void OnPing(const Client &client, unsigned id);
@@ -132,6 +151,58 @@ protected:
   virtual void OnError(std::exception &&e) = 0;
 };
 
+/**
+ * Collects outgoing datagrams and submits them with as few system
+ * calls as possible (sendmmsg() on Linux).  It is flushed
+ * automatically by the destructor, which allows declaring it before
+ * a lock to send all responses after the lock has been released.
+ */
+class Server::SendQueue {
+  Server &server;
+
+  static constexpr unsigned MAX_DATAGRAMS = 32;
+  static constexpr size_t BUFFER_SIZE = 32768;
+
+  struct Datagram {
+    boost::asio::ip::udp::endpoint endpoint;
+    size_t offset, size;
+  };
+
+  std::array<Datagram, MAX_DATAGRAMS> datagrams;
+  unsigned n_datagrams = 0;
+
+  size_t fill = 0;
+  uint8_t buffer[BUFFER_SIZE];
+
+public:
+  explicit SendQueue(Server &_server):server(_server) {}
+
+  ~SendQueue() {
+    Flush();
+  }
+
+  SendQueue(const SendQueue &) = delete;
+  SendQueue &operator=(const SendQueue &) = delete;
+
+  /**
+   * Copy a datagram into the queue.  Flushes the queue first if
+   * it is full.
+   */
+  void Push(const boost::asio::ip::udp::endpoint &endpoint,
+            boost::asio::const_buffer data);
+
+  template<typename P>
+  void PushPacket(const boost::asio::ip::udp::endpoint &endpoint,
+                  const P &packet) {
+    Push(endpoint, boost::asio::buffer(&packet, sizeof(packet)));
+  }
+
+  /**
+   * Send all queued datagrams.
+   */
+  void Flush();
+};
+
 } /* namespace SkyLinesTracking */
 
 #endif
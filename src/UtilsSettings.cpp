@@ -185,7 +185,7 @@ SettingsLeave(const UISettings &old_ui_settings)
       glide_computer->ClearAirspaces();
 
     airspace_database.Clear();
-    ReadAirspace(airspace_database, terrain,
+    ReadAirspace(airspace_database, file_cache, terrain,
                  CommonInterface::GetComputerSettings().pressure,
                  operation);
   }
@@ -34,6 +34,7 @@
 #include "FlightPhaseJSON.hpp"
 #include "Computer/Settings.hpp"
 #include "Util/StringCompare.hxx"
+#include "Thread/Parallel.hpp"
 
 struct Result {
   BrokenDateTime takeoff_time, release_time, landing_time;
@@ -179,6 +180,7 @@ SolveContest(Contest contest,
              Trace &full_trace, Trace &triangle_trace, Trace &sprint_trace)
 {
   ContestManager manager(contest, full_trace, triangle_trace, sprint_trace);
+  manager.SetParallel(ParallelRun, GetProcessorCount());
   manager.SolveExhaustive();
   return manager.GetStats();
 }
@@ -0,0 +1,135 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program replays a flight through an AirspaceWarningManager
+ * the same way WarningComputer does, and reports how long the
+ * warning updates take per fix.  Useful for profiling with dense
+ * airspace files.
+ */
+
+#include "DebugReplay.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceWarningManager.hpp"
+#include "Engine/Airspace/AirspaceWarningConfig.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "Atmosphere/Pressure.hpp"
+#include "NMEA/Aircraft.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+
+#include <algorithm>
+
+#include <stdio.h>
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "AIRSPACE DRIVER FILE");
+  const auto airspace_path = args.ExpectNextPath();
+
+  DebugReplay *replay = CreateDebugReplay(args);
+  if (replay == nullptr)
+    return EXIT_FAILURE;
+
+  args.ExpectEnd();
+
+  Airspaces airspaces;
+
+  {
+    FileLineReader reader(airspace_path, Charset::AUTO);
+    AirspaceParser parser(airspaces);
+    NullOperationEnvironment operation;
+    if (!parser.Parse(reader, operation)) {
+      fprintf(stderr, "Failed to parse airspace file\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  airspaces.Optimise();
+  airspaces.SetFlightLevels(AtmosphericPressure::Standard());
+
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+
+  AirspaceWarningManager warnings(config, airspaces);
+
+  const GlidePolar glide_polar(1);
+
+  TaskStats task_stats;
+  task_stats.reset();
+
+  unsigned n_fixes = 0, n_changed = 0, max_warnings = 0;
+  uint64_t total_us = 0, max_us = 0;
+  double last_time = -1;
+
+  while (replay->Next()) {
+    const MoreData &basic = replay->Basic();
+    const DerivedInfo &calculated = replay->Calculated();
+
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    const AircraftState state = ToAircraftState(basic, calculated);
+
+    if (last_time < 0 || basic.time <= last_time) {
+      /* first fix or time warp */
+      warnings.Reset(state);
+      last_time = basic.time;
+      continue;
+    }
+
+    const unsigned dt = std::max(1u, unsigned(basic.time - last_time));
+    last_time = basic.time;
+
+    const uint64_t start = MonotonicClockUS();
+    const bool changed = warnings.Update(state, glide_polar, task_stats,
+                                         calculated.circling, dt);
+    const uint64_t duration = MonotonicClockUS() - start;
+
+    ++n_fixes;
+    n_changed += changed;
+    max_warnings = std::max(max_warnings, unsigned(warnings.size()));
+    total_us += duration;
+    max_us = std::max(max_us, duration);
+  }
+
+  delete replay;
+
+  printf("%u airspaces, %u fixes, %u changes, max %u warnings\n",
+         unsigned(airspaces.GetSize()), n_fixes, n_changed, max_warnings);
+  if (n_fixes > 0)
+    printf("total %.1f ms, %.1f us per fix, max %lu us\n",
+           total_us / 1000., double(total_us) / n_fixes,
+           (unsigned long)max_us);
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
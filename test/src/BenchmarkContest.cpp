@@ -0,0 +1,195 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program replays all IGC files in a directory through one
+ * #ContestManager per contest type, the same way ContestComputer
+ * does during the flight (incremental solving every INTERVAL seconds
+ * of flight time, followed by an exhaustive search after landing).
+ * INTERVAL defaults to 10; 0 skips the incremental phase.
+ *
+ * It prints one tab-separated line per file and contest, with a
+ * header line, suitable for comparing solver performance between
+ * revisions:
+ *
+ *  file, contest, points, incremental_ms, exhaustive_ms, iterations,
+ *  trace_peak_bytes, distance_km, score
+ */
+
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/ContestManager.hpp"
+#include "Contest/Solvers/Contests.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/Path.hpp"
+#include "DebugReplayIGC.hpp"
+
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr Contest contests[] = {
+  Contest::OLC_SPRINT,
+  Contest::OLC_FAI,
+  Contest::OLC_CLASSIC,
+  Contest::OLC_LEAGUE,
+  Contest::OLC_PLUS,
+  Contest::XCONTEST,
+  Contest::DHV_XC,
+  Contest::SIS_AT,
+  Contest::NET_COUPE,
+  Contest::DMST,
+};
+
+class IGCFileVisitor final : public File::Visitor {
+public:
+  std::vector<std::string> paths;
+
+  void Visit(Path path, gcc_unused Path filename) override {
+    paths.emplace_back(path.c_str());
+  }
+};
+
+/**
+ * Load the valid fixes from an IGC file, with everything before the
+ * release removed.
+ */
+static bool
+LoadFixes(const char *path, std::vector<TracePoint> &fixes)
+{
+  DebugReplay *replay = DebugReplayIGC::Create(Path(path));
+  if (replay == nullptr)
+    return false;
+
+  while (replay->Next()) {
+    const MoreData &basic = replay->Basic();
+    if (basic.time_available && basic.location_available &&
+        basic.NavAltitudeAvailable())
+      fixes.emplace_back(basic);
+  }
+
+  const double release_time = replay->Calculated().flight.release_time;
+  if (release_time >= 0)
+    fixes.erase(std::remove_if(fixes.begin(), fixes.end(),
+                               [release_time](const TracePoint &p){
+                                 return p.GetTime() < release_time;
+                               }),
+                fixes.end());
+
+  delete replay;
+  return true;
+}
+
+struct ContestRun {
+  const Contest contest;
+
+  ContestManager manager;
+
+  uint64_t incremental_us = 0, exhaustive_us = 0;
+
+  ContestRun(Contest _contest, const Trace &full, const Trace &triangle,
+             const Trace &sprint)
+    :contest(_contest), manager(_contest, full, triangle, sprint, true) {
+    manager.SetIncremental(true);
+  }
+};
+
+static void
+BenchmarkFile(const char *path, unsigned interval)
+{
+  std::vector<TracePoint> fixes;
+  if (!LoadFixes(path, fixes)) {
+    fprintf(stderr, "Failed to load %s\n", path);
+    return;
+  }
+
+  /* same trace parameters as in TraceComputer */
+  Trace full_trace(120, Trace::null_time, 1024);
+  Trace triangle_trace(0, Trace::null_time, 256);
+  Trace sprint_trace(0, 9000, 128);
+
+  std::list<ContestRun> runs;
+  for (const auto contest : contests)
+    runs.emplace_back(contest, full_trace, triangle_trace, sprint_trace);
+
+  double next_update = 0;
+
+  for (const auto &fix : fixes) {
+    full_trace.push_back(fix);
+    triangle_trace.push_back(fix);
+    sprint_trace.push_back(fix);
+
+    if (interval == 0 || fix.GetTime() < next_update)
+      continue;
+
+    next_update = fix.GetTime() + interval;
+
+    for (auto &run : runs) {
+      const uint64_t start = MonotonicClockUS();
+      run.manager.UpdateIdle();
+      run.incremental_us += MonotonicClockUS() - start;
+    }
+  }
+
+  for (auto &run : runs) {
+    const uint64_t start = MonotonicClockUS();
+    run.manager.SolveExhaustive();
+    run.exhaustive_us = MonotonicClockUS() - start;
+
+    const ContestResult &result = run.manager.GetStats().GetResult();
+
+    printf("%s\t%s\t%u\t%.3f\t%.3f\t%lu\t%zu\t%.3f\t%.3f\n",
+           path, ContestToString(run.contest), unsigned(fixes.size()),
+           run.incremental_us / 1000., run.exhaustive_us / 1000.,
+           run.manager.GetIterations(),
+           run.manager.GetPeakTraceMemory(),
+           result.distance / 1000., result.score);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "DIRECTORY [INTERVAL]");
+  const auto directory = args.ExpectNextPath();
+  const unsigned interval = args.IsEmpty()
+    ? 10
+    : strtoul(args.GetNext(), nullptr, 10);
+  args.ExpectEnd();
+
+  IGCFileVisitor visitor;
+  Directory::VisitSpecificFiles(directory, _T("*.igc"), visitor);
+  std::sort(visitor.paths.begin(), visitor.paths.end());
+
+  printf("file\tcontest\tpoints\tincremental_ms\texhaustive_ms"
+         "\titerations\ttrace_peak_bytes\tdistance_km\tscore\n");
+
+  for (const auto &path : visitor.paths)
+    BenchmarkFile(path.c_str(), interval);
+
+  return EXIT_SUCCESS;
+}
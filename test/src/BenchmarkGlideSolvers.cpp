@@ -0,0 +1,173 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures the glide solvers with the cases of the
+ * test_mc, test_bestcruisetrack and test_effectivemc harness
+ * programs, at MacCready 0 (pure glide, speed optimisation) and 1.
+ *
+ * It prints one tab-separated line per case, with a header line:
+ *
+ *  case, mc, calls, us_per_call, checksum
+ *
+ * The checksum sums up the results and should not change between
+ * revisions unless the solver results change.
+ */
+
+#include "Engine/GlideSolvers/GlideSettings.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/GlideSolvers/GlideState.hpp"
+#include "Engine/GlideSolvers/GlideResult.hpp"
+#include "Engine/GlideSolvers/MacCready.hpp"
+#include "Engine/Task/TaskBehaviour.hpp"
+#include "Engine/Task/Unordered/UnorderedTaskPoint.hpp"
+#include "Engine/Task/Solvers/TaskBestMc.hpp"
+#include "Engine/Waypoint/Waypoint.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "OS/Clock.hpp"
+
+#include <stdio.h>
+
+static GlideSettings settings;
+
+static SpeedVector
+MakeWind(double w, double angle)
+{
+  return w < 0
+    ? SpeedVector(Angle::Degrees(180 + angle), -w)
+    : SpeedVector(Angle::Degrees(angle), w);
+}
+
+/**
+ * MacCready::Solve() over a range of heights, winds and wind angles
+ * (test_mc).
+ */
+static double
+SolveAltitudes(const GlidePolar &polar, unsigned &n)
+{
+  double checksum = 0;
+
+  for (double h = 0; h < 40; h += 0.5) {
+    for (double w = -10; w <= 10; w += 2.5) {
+      for (double a = 0; a < 360; a += 15) {
+        const GlideState gs(GeoVector(400, Angle::Zero()), 0, h,
+                            MakeWind(w, a));
+        const GlideResult gr = MacCready::Solve(settings, polar, gs);
+        checksum += gr.altitude_difference + gr.v_opt;
+        ++n;
+      }
+    }
+  }
+
+  return checksum;
+}
+
+/**
+ * The cruise track cases (test_bestcruisetrack).  The cruise track
+ * bearing itself is always the bearing of the vector in these cases,
+ * so the checksum uses the solver's speed and time instead.
+ */
+static double
+SolveCruiseTrack(const GlidePolar &polar, unsigned &n)
+{
+  double checksum = 0;
+
+  for (double h = 0; h < 400; h += 50) {
+    for (double a = 0; a < 360; a += 5) {
+      const GlideState gs(GeoVector(10000, Angle::Degrees(30)), 0, h,
+                          MakeWind(10, a));
+      GlideResult gr = MacCready::Solve(settings, polar, gs);
+      gr.CalcDeferred();
+      checksum += gr.v_opt + gr.time_elapsed;
+      ++n;
+    }
+  }
+
+  return checksum;
+}
+
+/**
+ * TaskBestMc searches for a single task point (test_effectivemc).
+ */
+static double
+SolveBestMc(const GlidePolar &polar, unsigned &n)
+{
+  TaskBehaviour task_behaviour;
+  task_behaviour.SetDefaults();
+
+  const GeoPoint origin(Angle::Degrees(7), Angle::Degrees(51));
+  UnorderedTaskPoint tp(WaypointPtr(new Waypoint(origin)), task_behaviour);
+
+  double checksum = 0;
+
+  for (double h = 500; h < 2500; h += 100) {
+    for (double a = 0; a < 360; a += 30) {
+      AircraftState aircraft;
+      aircraft.Reset();
+      aircraft.location = GeoVector(30000, Angle::Degrees(a)).EndPoint(origin);
+      aircraft.altitude = h;
+      aircraft.wind = MakeWind(8, 45);
+
+      TaskBestMc bmc(&tp, aircraft, settings, polar);
+      checksum += bmc.search(polar.GetMC());
+      ++n;
+    }
+  }
+
+  return checksum;
+}
+
+template<typename F>
+static void
+Run(const char *name, double mc, F &&f)
+{
+  GlidePolar polar(mc);
+
+  static constexpr unsigned n_runs = 20;
+
+  unsigned n = 0;
+  double checksum = 0;
+
+  const auto start = MonotonicClockUS();
+  for (unsigned i = 0; i < n_runs; ++i)
+    checksum = f(polar, n);
+  const auto elapsed = MonotonicClockUS() - start;
+
+  printf("%s\t%.1f\t%u\t%.3f\t%.3f\n", name, mc, n,
+         double(elapsed) / n, checksum);
+}
+
+int main(int argc, char **argv)
+{
+  settings.SetDefaults();
+
+  printf("case\tmc\tcalls\tus_per_call\tchecksum\n");
+
+  for (double mc = 0; mc <= 1; mc += 1) {
+    Run("mc", mc, SolveAltitudes);
+    Run("bestcruisetrack", mc, SolveCruiseTrack);
+    Run("effectivemc", mc, SolveBestMc);
+  }
+
+  return 0;
+}
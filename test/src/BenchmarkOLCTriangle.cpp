@@ -0,0 +1,144 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures the time needed by the triangle solvers to
+ * find the exhaustive solution for a number of IGC files, once with
+ * the serial branch and bound and then with the parallel one using
+ * an increasing number of threads.  It verifies that all runs yield
+ * the same score.
+ */
+
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/ContestManager.hpp"
+#include "Thread/Parallel.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "DebugReplay.hpp"
+
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+struct TriangleResult {
+  double fai_score, xcontest_score;
+  uint64_t fai_us, xcontest_us;
+};
+
+static void
+LoadTrace(DebugReplay &replay, Trace &trace)
+{
+  bool released = false;
+
+  while (replay.Next()) {
+    const MoreData &basic = replay.Basic();
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    if (!released && replay.Calculated().flight.release_time >= 0) {
+      released = true;
+      trace.EraseEarlierThan(replay.Calculated().flight.release_time);
+    }
+
+    trace.push_back(TracePoint(basic));
+  }
+}
+
+static double
+Solve(Contest contest, unsigned result_index,
+      const Trace &trace, unsigned n_workers, uint64_t &duration_us)
+{
+  static Trace empty_trace(0, Trace::null_time, 16);
+
+  ContestManager manager(contest, empty_trace, trace, empty_trace);
+  manager.SetParallel(ParallelRun, n_workers);
+
+  const uint64_t start = MonotonicClockUS();
+  manager.SolveExhaustive();
+  duration_us = MonotonicClockUS() - start;
+
+  return manager.GetStats().GetResult(result_index).score;
+}
+
+static TriangleResult
+Solve(const Trace &trace, unsigned n_workers)
+{
+  TriangleResult result;
+  result.fai_score = Solve(Contest::OLC_FAI, 0, trace, n_workers,
+                           result.fai_us);
+  result.xcontest_score = Solve(Contest::XCONTEST, 1, trace, n_workers,
+                                result.xcontest_us);
+  return result;
+}
+
+static bool
+Equals(double a, double b)
+{
+  return fabs(a - b) < 0.001;
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "FILE.igc ...");
+
+  const unsigned max_workers = std::max(GetProcessorCount(), 2u);
+  unsigned mismatches = 0;
+
+  do {
+    const char *path = args.PeekNext();
+    DebugReplay *replay = CreateDebugReplay(args);
+    if (replay == nullptr)
+      return EXIT_FAILURE;
+
+    Trace trace(0, Trace::null_time, 1024);
+    LoadTrace(*replay, trace);
+    delete replay;
+
+    const TriangleResult serial = Solve(trace, 1);
+    printf("%s points=%u workers=1 fai_ms=%.1f fai_score=%.3f"
+           " xcontest_ms=%.1f xcontest_score=%.3f\n",
+           path, trace.size(),
+           serial.fai_us / 1000., serial.fai_score,
+           serial.xcontest_us / 1000., serial.xcontest_score);
+
+    for (unsigned n = 2; n <= max_workers; n *= 2) {
+      const TriangleResult parallel = Solve(trace, n);
+      const bool ok = Equals(parallel.fai_score, serial.fai_score) &&
+        Equals(parallel.xcontest_score, serial.xcontest_score);
+      if (!ok)
+        ++mismatches;
+
+      printf("%s points=%u workers=%u fai_ms=%.1f fai_score=%.3f"
+             " xcontest_ms=%.1f xcontest_score=%.3f%s\n",
+             path, trace.size(), n,
+             parallel.fai_us / 1000., parallel.fai_score,
+             parallel.xcontest_us / 1000., parallel.xcontest_score,
+             ok ? "" : " MISMATCH");
+    }
+  } while (!args.IsEmpty());
+
+  return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
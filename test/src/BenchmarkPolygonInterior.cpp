@@ -0,0 +1,128 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program compares the speed of the point-in-polygon tests of
+ * SearchPointVector and PackedPolygon on a large star-shaped polygon
+ * (similar to a detailed airspace border), and verifies that both
+ * return the same results.
+ */
+
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/PackedPolygon.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+
+#include <random>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static SearchPointVector
+MakePolygon(const GeoPoint &center, unsigned n_vertices,
+            std::mt19937 &random)
+{
+  std::uniform_real_distribution<double> radius(0.2, 1.0);
+
+  SearchPointVector polygon;
+  polygon.reserve(n_vertices + 1);
+
+  for (unsigned i = 0; i < n_vertices; ++i) {
+    const Angle direction = Angle::FullCircle() * i / n_vertices;
+    const double r = radius(random);
+    polygon.emplace_back(GeoPoint(center.longitude + Angle::Degrees(r * direction.cos()),
+                                  center.latitude + Angle::Degrees(r * direction.sin())));
+  }
+
+  /* close the polygon */
+  polygon.emplace_back(polygon.front().GetLocation());
+  return polygon;
+}
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv, "[VERTICES]");
+  const int n_vertices = args.IsEmpty() ? 4096 : args.ExpectNextInt();
+  args.ExpectEnd();
+
+  if (n_vertices < 3) {
+    fprintf(stderr, "Too few vertices\n");
+    return EXIT_FAILURE;
+  }
+
+  const GeoPoint center(Angle::Degrees(7.7), Angle::Degrees(51.05));
+
+  std::mt19937 random(42);
+  const SearchPointVector polygon = MakePolygon(center, n_vertices, random);
+  const PackedPolygon packed(polygon);
+
+  std::uniform_real_distribution<double> offset(-1.1, 1.1);
+  std::vector<GeoPoint> points;
+  for (unsigned i = 0; i < 4096; ++i)
+    points.emplace_back(center.longitude + Angle::Degrees(offset(random)),
+                        center.latitude + Angle::Degrees(offset(random)));
+
+  static constexpr unsigned N_ROUNDS = 8;
+
+  std::vector<bool> expected;
+  unsigned n_inside = 0;
+
+  uint64_t start = MonotonicClockUS();
+  for (unsigned round = 0; round < N_ROUNDS; ++round) {
+    expected.clear();
+    for (const auto &p : points)
+      expected.push_back(polygon.IsInside(p));
+  }
+  const uint64_t vector_us = MonotonicClockUS() - start;
+
+  unsigned n_mismatches = 0;
+
+  start = MonotonicClockUS();
+  for (unsigned round = 0; round < N_ROUNDS; ++round) {
+    n_inside = 0;
+    for (unsigned i = 0; i < points.size(); ++i) {
+      const bool inside = packed.IsInside(points[i]);
+      n_inside += inside;
+      n_mismatches += inside != expected[i];
+    }
+  }
+  const uint64_t packed_us = MonotonicClockUS() - start;
+
+  const unsigned n_tests = N_ROUNDS * points.size();
+  printf("%d vertices, %u tests, %u inside\n",
+         n_vertices, n_tests, n_inside);
+  printf("SearchPointVector: %.1f ms, %.3f us per test\n",
+         vector_us / 1000., double(vector_us) / n_tests);
+  printf("PackedPolygon: %.1f ms, %.3f us per test\n",
+         packed_us / 1000., double(packed_us) / n_tests);
+
+  if (n_mismatches > 0) {
+    fprintf(stderr, "%u mismatches\n", n_mismatches);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures how long RasterRenderer needs to generate
+ * one terrain image, with and without slope shading.
+ */
+
+#define ENABLE_MAIN_WINDOW
+#define ENABLE_CMDLINE
+#define USAGE "PATH [WIDTH HEIGHT]"
+
+#include "Main.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/RasterRenderer.hpp"
+#include "Terrain/Loader.hpp"
+#include "Screen/Ramp.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Math/Angle.hpp"
+#include "OS/Clock.hpp"
+#include "IO/ZipArchive.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/NumberParser.hpp"
+
+static constexpr ColorRamp terrain_colors[NUM_COLOR_RAMP_LEVELS] = {
+  {0, { 0x70, 0xc0, 0xa7 }},
+  {250, { 0xca, 0xe7, 0xb9 }},
+  {500, { 0xf4, 0xea, 0xaf }},
+  {750, { 0xdc, 0xb2, 0x82 }},
+  {1000, { 0xca, 0x8e, 0x72 }},
+  {1250, { 0xde, 0xc8, 0xbd }},
+  {1500, { 0xe3, 0xe4, 0xe9 }},
+  {1750, { 0xdb, 0xd9, 0xef }},
+  {2000, { 0xce, 0xcd, 0xf5 }},
+  {2250, { 0xc2, 0xc1, 0xfa }},
+  {2500, { 0xb7, 0xb9, 0xff }},
+  {5000, { 0xb7, 0xb9, 0xff }},
+  {6000, { 0xb7, 0xb9, 0xff }}
+};
+
+static constexpr unsigned FRAMES = 50;
+
+static AllocatedPath map_path = nullptr;
+static PixelSize screen_size{1280, 800};
+
+static void
+ParseCommandLine(Args &args)
+{
+  map_path = args.ExpectNextPath();
+
+  if (!args.IsEmpty()) {
+    screen_size.cx = ParseUnsigned(args.ExpectNext());
+    screen_size.cy = ParseUnsigned(args.ExpectNext());
+  }
+}
+
+/**
+ * Render #FRAMES frames and return the average time per frame in
+ * milliseconds.
+ */
+static double
+BenchmarkFrames(RasterRenderer &renderer, const RasterMap &map,
+                const WindowProjection &projection, bool do_shading)
+{
+  const uint64_t start = MonotonicClockUS();
+
+  for (unsigned i = 0; i < FRAMES; ++i) {
+    renderer.ScanMap(map, projection);
+    renderer.GenerateImage(do_shading, 4, 64, 128,
+                           Angle::Degrees(45), true);
+  }
+
+  return (MonotonicClockUS() - start) / (1000. * FRAMES);
+}
+
+static void
+Main()
+{
+  ZipArchive archive(map_path);
+
+  RasterMap map;
+
+  NullOperationEnvironment operation;
+  if (!LoadTerrainOverview(archive.get(), map.GetTileCache(),
+                           operation))
+    throw std::runtime_error("Failed to load map");
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), 50000);
+  } while (map.IsDirty());
+
+  WindowProjection projection;
+  projection.SetScreenSize(screen_size);
+  projection.SetScaleFromRadius(20000);
+  projection.SetGeoLocation(map.GetMapCenter());
+  projection.SetScreenOrigin(screen_size.cx / 2, screen_size.cy / 2);
+  projection.UpdateScreenBounds();
+
+  RasterRenderer renderer;
+  renderer.PrepareColorTable(terrain_colors, true, 4, 2);
+
+  const double unshaded = BenchmarkFrames(renderer, map, projection, false);
+  const double shaded = BenchmarkFrames(renderer, map, projection, true);
+
+  printf("size=%ux%u frames=%u\n",
+         (unsigned)screen_size.cx, (unsigned)screen_size.cy, FRAMES);
+  printf("unshaded: %.2f ms/frame\n", unshaded);
+  printf("shaded:   %.2f ms/frame\n", shaded);
+}
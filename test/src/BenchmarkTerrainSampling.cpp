@@ -0,0 +1,120 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program compares the performance of the scalar terrain
+ * sampling function RasterTileCache::GetInterpolatedHeight() with
+ * the batched (SIMD) version GetInterpolatedHeights() on a real
+ * terrain file, and verifies that both produce the same results.
+ */
+
+#include "Terrain/RasterTileCache.hpp"
+#include "Terrain/Loader.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/ZipArchive.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Generate sample locations the way the terrain renderer does: rows
+ * of equally spaced sub-pixel locations, slightly rotated.
+ */
+static std::vector<RasterLocation>
+MakeLocations(const RasterTileCache &rtc, unsigned width, unsigned height)
+{
+  std::vector<RasterLocation> locations;
+  locations.reserve(width * height);
+
+  const unsigned fine_width = rtc.GetFineWidth();
+  const unsigned fine_height = rtc.GetFineHeight();
+  const unsigned x0 = fine_width / 4, y0 = fine_height / 4;
+  const unsigned step_x = (fine_width / 2) / width;
+  const unsigned step_y = (fine_height / 2) / height;
+
+  for (unsigned y = 0; y < height; ++y)
+    for (unsigned x = 0; x < width; ++x)
+      locations.emplace_back(x0 + x * step_x, y0 + y * step_y + x / 8);
+
+  return locations;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH");
+  const auto map_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  NullOperationEnvironment operation;
+  RasterTileCache rtc;
+  if (!LoadTerrainOverview(archive.get(), rtc, operation)) {
+    fprintf(stderr, "LoadOverview failed\n");
+    return EXIT_FAILURE;
+  }
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), rtc, mutex,
+                       rtc.GetWidth() / 2, rtc.GetHeight() / 2,
+                       rtc.GetWidth());
+  } while (rtc.IsDirty());
+
+  constexpr unsigned ROUNDS = 20;
+
+  const auto locations = MakeLocations(rtc, 1280, 800);
+  const unsigned n = locations.size();
+  std::vector<TerrainHeight> scalar(n), batch(n);
+
+  uint64_t start = MonotonicClockUS();
+  for (unsigned round = 0; round < ROUNDS; ++round)
+    for (unsigned i = 0; i < n; ++i)
+      scalar[i] = rtc.GetInterpolatedHeight(locations[i].x, locations[i].y);
+  const uint64_t scalar_us = MonotonicClockUS() - start;
+
+  start = MonotonicClockUS();
+  for (unsigned round = 0; round < ROUNDS; ++round)
+    rtc.GetInterpolatedHeights(locations.data(), batch.data(), n);
+  const uint64_t batch_us = MonotonicClockUS() - start;
+
+  unsigned mismatches = 0;
+  for (unsigned i = 0; i < n; ++i)
+    if (scalar[i].GetValue() != batch[i].GetValue())
+      ++mismatches;
+
+  printf("samples=%u rounds=%u\n", n, ROUNDS);
+  printf("scalar: %.2f ns/sample\n", scalar_us * 1000. / (n * ROUNDS));
+  printf("batch:  %.2f ns/sample\n", batch_us * 1000. / (n * ROUNDS));
+  printf("mismatches=%u\n", mismatches);
+
+  return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -24,6 +24,10 @@ Copyright_License {
 /*
  * This program loads the terrain from a map file and exits.  Useful
  * for valgrind and profiling.
+ *
+ * If a maximum number of threads is given, the fine tiles are decoded
+ * repeatedly with 1 to that many decoder threads, and the decoding
+ * speed is reported for each thread count.
  */
 
 #include "Terrain/RasterTileCache.hpp"
@@ -32,18 +36,64 @@ Copyright_License {
 #include "OS/ConvertPathName.hpp"
 #include "IO/ZipArchive.hpp"
 #include "Operation/Operation.hpp"
+#include "OS/Clock.hpp"
 #include "Util/PrintException.hxx"
 
+#include <vector>
+#include <algorithm>
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <tchar.h>
 
+static void
+BenchmarkTileDecoder(Path map_path, unsigned n_threads)
+{
+  std::vector<ZipArchive> archives;
+  std::vector<struct zzip_dir *> dirs;
+  for (unsigned i = 0; i < n_threads; ++i) {
+    archives.emplace_back(map_path);
+    dirs.push_back(archives.back().get());
+  }
+
+  NullOperationEnvironment operation;
+  RasterTileCache rtc;
+  if (!LoadTerrainOverview(dirs.front(), rtc, operation)) {
+    fprintf(stderr, "LoadOverview failed\n");
+    return;
+  }
+
+  SharedMutex mutex;
+  const uint64_t start = MonotonicClockUS();
+  unsigned n_tiles = 0;
+  do {
+    UpdateTerrainTiles(dirs.data(), n_threads, rtc, mutex,
+                       rtc.GetWidth() / 2, rtc.GetHeight() / 2, 1000);
+    n_tiles = std::max(n_tiles, rtc.GetEnabledTileCount());
+  } while (rtc.IsDirty());
+  const uint64_t duration_us = MonotonicClockUS() - start;
+
+  printf("threads=%u tiles=%u time=%.3fs tiles/s=%.1f\n",
+         n_threads, n_tiles, duration_us / 1000000.,
+         duration_us > 0 ? n_tiles * 1000000. / duration_us : 0.);
+}
+
 int main(int argc, char **argv)
 try {
-  Args args(argc, argv, "PATH");
+  Args args(argc, argv, "PATH [MAX_THREADS]");
   const auto map_path = args.ExpectNextPath();
+  const unsigned max_threads = args.IsEmpty()
+    ? 0
+    : strtoul(args.GetNext(), nullptr, 10);
   args.ExpectEnd();
 
+  if (max_threads > 0) {
+    for (unsigned n = 1; n <= max_threads; ++n)
+      BenchmarkTileDecoder(map_path, n);
+    return EXIT_SUCCESS;
+  }
+
   ZipArchive archive(map_path);
 
   NullOperationEnvironment operation;
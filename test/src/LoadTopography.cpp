@@ -24,16 +24,27 @@ Copyright_License {
 /*
  * This program loads the topography from a map file and exits.  Useful
  * for valgrind and profiling.
+ *
+ * If a number of workers is given, it simulates panning and zooming
+ * across the map instead, and reports how long the cache updates
+ * take per layer (sequentially) and in total (with the given number
+ * of workers).
  */
 
 #include "Topography/TopographyStore.hpp"
 #include "Topography/TopographyFile.hpp"
 #include "Topography/XShape.hpp"
+#include "Projection/WindowProjection.hpp"
 #include "OS/Args.hpp"
+#include "OS/Clock.hpp"
 #include "IO/ZipArchive.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "Operation/Operation.hpp"
 #include "Util/PrintException.hxx"
+#include "Util/Macros.hpp"
+
+#include <algorithm>
+#include <vector>
 
 #include <stdio.h>
 #include <tchar.h>
@@ -61,19 +72,136 @@ TriangulateAll(const TopographyStore &store)
 
 #endif
 
+static void
+PrintCacheStatistics(const TopographyStore &store)
+{
+  size_t total = 0;
+
+  for (unsigned i = 0; i < store.size(); ++i) {
+    const TopographyFile &file = store[i];
+    const ScopeLock protect(file.mutex);
+    const auto stats = file.GetCacheStatistics();
+    printf("layer %u: %u shapes, %lu bytes shapes, %lu bytes payload, %lu bytes reserved\n",
+           i, stats.n_shapes,
+           (unsigned long)stats.shape_bytes,
+           (unsigned long)stats.payload_bytes,
+           (unsigned long)stats.reserved_bytes);
+    total += stats.shape_bytes + stats.reserved_bytes;
+  }
+
+  printf("total: %lu bytes\n", (unsigned long)total);
+}
+
+static void
+LoadStore(TopographyStore &store, ZipArchive &archive)
+{
+  ZipLineReaderA reader(archive.get(), "topology.tpl");
+
+  NullOperationEnvironment operation;
+  store.Load(operation, reader, NULL, archive.get());
+}
+
+static constexpr unsigned N_STEPS = 64;
+
+/**
+ * Generate the projection of one step of a simulated flight across
+ * the map, zooming in and out while panning.
+ */
+static WindowProjection
+MakeProjection(const GeoPoint &center, unsigned step)
+{
+  static constexpr double widths[] = { 5000, 10000, 20000, 50000 };
+
+  WindowProjection projection;
+  projection.SetScreenSize({640, 480});
+  projection.SetScreenOrigin(320, 240);
+  projection.SetGeoLocation(GeoPoint(center.longitude +
+                                     Angle::Degrees(0.02 * (int(step) - int(N_STEPS / 2))),
+                                     center.latitude));
+  projection.SetScale(640 / widths[step % ARRAY_SIZE(widths)]);
+  projection.UpdateScreenBounds();
+  return projection;
+}
+
+static void
+RunTiming(ZipArchive &archive, unsigned n_workers)
+{
+  /* per layer, sequentially */
+
+  TopographyStore sequential;
+  LoadStore(sequential, archive);
+  if (sequential.size() == 0)
+    return;
+
+  const GeoPoint center = sequential[0].GetCenter();
+
+  struct LayerTiming {
+    unsigned n_updates = 0;
+    uint64_t total_us = 0, max_us = 0;
+  };
+
+  std::vector<LayerTiming> layers(sequential.size());
+  uint64_t sequential_us = 0;
+
+  for (unsigned step = 0; step < N_STEPS; ++step) {
+    const auto projection = MakeProjection(center, step);
+
+    for (unsigned i = 0; i < sequential.size(); ++i) {
+      const uint64_t start = MonotonicClockUS();
+      const bool updated = sequential[i].Update(projection);
+      const uint64_t duration = MonotonicClockUS() - start;
+
+      LayerTiming &layer = layers[i];
+      layer.n_updates += updated;
+      layer.total_us += duration;
+      layer.max_us = std::max(layer.max_us, duration);
+      sequential_us += duration;
+    }
+  }
+
+  for (unsigned i = 0; i < layers.size(); ++i)
+    printf("layer %u: %u updates, total %.1f ms, max %.1f ms\n", i,
+           layers[i].n_updates,
+           layers[i].total_us / 1000., layers[i].max_us / 1000.);
+
+  /* all layers, concurrently */
+
+  TopographyStore parallel;
+  LoadStore(parallel, archive);
+
+  uint64_t parallel_us = 0, max_step_us = 0;
+  for (unsigned step = 0; step < N_STEPS; ++step) {
+    const auto projection = MakeProjection(center, step);
+
+    const uint64_t start = MonotonicClockUS();
+    parallel.ScanVisibility(projection, parallel.size(), n_workers);
+    const uint64_t duration = MonotonicClockUS() - start;
+
+    parallel_us += duration;
+    max_step_us = std::max(max_step_us, duration);
+  }
+
+  printf("sequential: total %.1f ms\n", sequential_us / 1000.);
+  printf("%u workers: total %.1f ms, max %.1f ms per step\n",
+         n_workers, parallel_us / 1000., max_step_us / 1000.);
+}
+
 int main(int argc, char **argv)
 try {
-  Args args(argc, argv, "PATH");
+  Args args(argc, argv, "PATH [WORKERS]");
   const auto path = args.ExpectNextPath();
+  const int n_workers = args.IsEmpty() ? 0 : args.ExpectNextInt();
   args.ExpectEnd();
 
   ZipArchive archive(path);
 
-  ZipLineReaderA reader(archive.get(), "topology.tpl");
+  if (n_workers > 0) {
+    RunTiming(archive, n_workers);
+    return EXIT_SUCCESS;
+  }
 
   TopographyStore topography;
-  NullOperationEnvironment operation;
-  topography.Load(operation, reader, NULL, archive.get());
+  LoadStore(topography, archive);
 
   topography.LoadAll();
 
@@ -81,6 +209,8 @@ try {
   TriangulateAll(topography);
 #endif
 
+  PrintCacheStatistics(topography);
+
   return EXIT_SUCCESS;
 } catch (const std::runtime_error &e) {
   PrintException(e);
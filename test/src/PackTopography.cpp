@@ -0,0 +1,129 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program converts the topography layers of a map file to
+ * packed topography files (*.xtp), which can be added to the map
+ * file to speed up loading and rendering.
+ */
+
+#include "Topography/TopographyFile.hpp"
+#include "Topography/PackedTopographyWriter.hpp"
+#include "Topography/XShape.hpp"
+#include "OS/Args.hpp"
+#include "OS/ConvertPathName.hpp"
+#include "IO/ZipArchive.hpp"
+#include "IO/ZipLineReader.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "Geo/FAISphere.hpp"
+#include "Util/StringCompare.hxx"
+#include "Util/PrintException.hxx"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void
+PackFile(zzip_dir *dir, Path out_dir, const char *name,
+         double range, int label_field, unsigned scale)
+{
+  std::string shp_name(name);
+  shp_name += ".shp";
+
+  TopographyFile file(dir, shp_name.c_str(), range, range, 0, Color(),
+                      label_field);
+  if (file.IsEmpty() || file.IsPacked()) {
+    fprintf(stderr, "Skipping %s\n", name);
+    return;
+  }
+
+  file.LoadAll();
+
+  /* the same values as in TopographyFileRenderer::Paint() */
+  float min_distance[PackedTopography::THINNING_LEVELS];
+  for (unsigned i = 0; i < PackedTopography::THINNING_LEVELS; ++i)
+    min_distance[i] = ShapeScalar(file.GetMinimumPointDistance(i))
+      / (scale * FAISphere::REARTH);
+
+  std::string xtp_name(name);
+  xtp_name += ".xtp";
+
+  const auto path = AllocatedPath::Build(out_dir,
+                                         PathName(xtp_name.c_str()));
+  FileOutputStream os(path);
+  WritePackedTopography(os, file, min_distance);
+  os.Commit();
+
+  printf("%s\n", xtp_name.c_str());
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "MAPFILE OUTDIR [SCALE]");
+  const auto map_path = args.ExpectNextPath();
+  const auto out_dir = args.ExpectNextPath();
+  const unsigned scale = args.IsEmpty() ? 1 : args.ExpectNextInt();
+  args.ExpectEnd();
+
+  if (scale < 1) {
+    fprintf(stderr, "Invalid scale\n");
+    return EXIT_FAILURE;
+  }
+
+  ZipArchive archive(map_path);
+
+  ZipLineReaderA reader(archive.get(), "topology.tpl");
+
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    // .tpl Line format: filename,range,icon,field,...
+
+    if (StringIsEmpty(line) || line[0] == '*')
+      continue;
+
+    char *p = strchr(line, ',');
+    if (p == nullptr || p == line)
+      continue;
+
+    *p = 0;
+    const char *name = line;
+
+    const double range = strtod(p + 1, &p) * 1000;
+    if (*p != ',')
+      continue;
+
+    // skip the icon name
+    p = strchr(p + 1, ',');
+    if (p == nullptr)
+      continue;
+
+    const int label_field = strtol(p + 1, &p, 10) - 1;
+
+    PackFile(archive.get(), out_dir, name, range, label_field, scale);
+  }
+
+  return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -139,6 +139,9 @@ void PrintHelper::print_route(RoutePlanner& r)
   printf("#   airspace queries %d\n", (int)r.count_airspace);
   printf("#   terrain queries %d\n", (int)r.count_terrain);
   printf("#   supressed %d\n", (int)r.count_supressed);
+  printf("#   clearance cache hits %lu misses %lu flushes %lu\n",
+         r.clearance_statistics.hits, r.clearance_statistics.misses,
+         r.clearance_statistics.flushes);
 }
 
 #include "Route/ReachFan.hpp"
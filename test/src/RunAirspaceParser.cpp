@@ -21,22 +21,93 @@ Copyright_License {
 }
 */
 
+/*
+ * This program parses an airspace file and reports how long that
+ * took, compared with saving the result to a binary cache (as used
+ * by ReadAirspace() with a FileCache) and loading it back.
+ */
+
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
 #include "OS/Args.hpp"
+#include "OS/Clock.hpp"
 #include "IO/FileLineReader.hpp"
 #include "Operation/Operation.hpp"
 #include "Util/PrintException.hxx"
 
+#include <vector>
+
 #include <stdio.h>
 #include <tchar.h>
 
+static bool
+operator==(const AirspaceAltitude &a, const AirspaceAltitude &b)
+{
+  return a.altitude == b.altitude &&
+    a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain &&
+    a.reference == b.reference;
+}
+
+/**
+ * Compare all attributes of two airspaces, and print the first
+ * difference.
+ *
+ * @return true if both are equal
+ */
+static bool
+CompareAirspace(unsigned i, const AbstractAirspace &a,
+                const AbstractAirspace &b)
+{
+  const char *field = nullptr;
+
+  if (a.GetShape() != b.GetShape())
+    field = "shape";
+  else if (_tcscmp(a.GetName(), b.GetName()) != 0)
+    field = "name";
+  else if (a.GetRadioText() != b.GetRadioText())
+    field = "radio";
+  else if (a.GetType() != b.GetType())
+    field = "class";
+  else if (!(a.GetBase() == b.GetBase()))
+    field = "base";
+  else if (!(a.GetTop() == b.GetTop()))
+    field = "top";
+  else if (!a.GetDays().equals(b.GetDays()))
+    field = "days";
+  else if (a.GetShape() == AbstractAirspace::Shape::CIRCLE &&
+           (!(a.GetCenter() == b.GetCenter()) ||
+            ((const AirspaceCircle &)a).GetRadius() !=
+            ((const AirspaceCircle &)b).GetRadius()))
+    field = "circle";
+  else if (a.GetPoints().size() != b.GetPoints().size())
+    field = "number of points";
+  else {
+    const auto &pa = a.GetPoints(), &pb = b.GetPoints();
+    for (unsigned j = 0; j < pa.size(); ++j) {
+      if (!(pa[j].GetLocation() == pb[j].GetLocation())) {
+        fprintf(stderr, "Cache mismatch: airspace %u point %u\n", i, j);
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  fprintf(stderr, "Cache mismatch: airspace %u %s\n", i, field);
+  return false;
+}
+
 int main(int argc, char **argv)
 try {
   Args args(argc, argv, "PATH");
   const auto path = args.ExpectNextPath();
   args.ExpectEnd();
 
+  uint64_t start = MonotonicClockUS();
+
   FileLineReader reader(path, Charset::AUTO);
 
   Airspaces airspaces;
@@ -48,7 +119,69 @@ try {
     return 1;
   }
 
+  const uint64_t parse_us = MonotonicClockUS() - start;
+
+  /* save the parsed airspaces to a temporary cache file */
+
+  FILE *file = tmpfile();
+  if (file == nullptr) {
+    perror("Failed to create temporary file");
+    return EXIT_FAILURE;
+  }
+
+  const auto &pending = airspaces.GetPending();
+  const std::vector<const AbstractAirspace *> parsed(pending.begin(),
+                                                     pending.end());
+
+  start = MonotonicClockUS();
+  if (!SaveAirspaceCache(file, parsed)) {
+    fprintf(stderr, "Failed to save cache\n");
+    return EXIT_FAILURE;
+  }
+
+  const uint64_t save_us = MonotonicClockUS() - start;
+  const long cache_size = ftell(file);
+
+  start = MonotonicClockUS();
   airspaces.Optimise();
+  const uint64_t optimise_us = MonotonicClockUS() - start;
+
+  /* load it back */
+
+  rewind(file);
+
+  Airspaces cached;
+
+  start = MonotonicClockUS();
+  if (!LoadAirspaceCache(file, cached)) {
+    fprintf(stderr, "Failed to load cache\n");
+    return EXIT_FAILURE;
+  }
+
+  const uint64_t load_us = MonotonicClockUS() - start;
+  fclose(file);
+
+  /* compare before Optimise(), while both are still in insertion
+     order */
+
+  const auto &loaded = cached.GetPending();
+  if (loaded.size() != parsed.size()) {
+    fprintf(stderr, "Cache mismatch: %u airspaces\n",
+            unsigned(loaded.size()));
+    return EXIT_FAILURE;
+  }
+
+  for (unsigned i = 0; i < parsed.size(); ++i)
+    if (!CompareAirspace(i, *parsed[i], *loaded[i]))
+      return EXIT_FAILURE;
+
+  cached.Optimise();
+
+  printf("%u airspaces, cache %ld bytes\n", airspaces.GetSize(), cache_size);
+  printf("parse: %.1f ms, optimise: %.1f ms\n",
+         parse_us / 1000., optimise_us / 1000.);
+  printf("save cache: %.1f ms, load cache: %.1f ms\n",
+         save_us / 1000., load_us / 1000.);
 
   printf("OK\n");
 
@@ -0,0 +1,300 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * A load generator for the xcsoar-cloud-server.  It simulates a
+ * number of SkyLines tracking clients which fly around in a small
+ * area, each submitting a fix and a traffic request per round, and
+ * measures the rate and latency of the server's traffic responses.
+ */
+
+#include "Tracking/SkyLines/Assemble.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Geo/Math.hpp"
+#include "OS/ByteOrder.hpp"
+#include "OS/Args.hpp"
+#include "Util/NumberParser.hpp"
+
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <random>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * All clients share this key prefix; the lower bits are the client
+ * index.
+ */
+static constexpr uint64_t KEY_BASE = 0x4c4f414400000000ull;
+
+static constexpr unsigned DEFAULT_PORT = 5597;
+
+struct SimulatedClient {
+  GeoPoint location;
+  Angle track;
+
+  /**
+   * The time the last traffic request was sent, or
+   * Clock::time_point::min() if the response has already been
+   * received.
+   */
+  Clock::time_point request_time = Clock::time_point::min();
+
+  void Move(double distance) {
+    location = FindLatitudeLongitude(location, track, distance);
+  }
+};
+
+class CloudLoad {
+  boost::asio::ip::udp::socket socket;
+  const boost::asio::ip::udp::endpoint server;
+
+  boost::asio::steady_timer timer;
+  const Clock::duration interval;
+  const Clock::time_point end_time;
+
+  std::vector<SimulatedClient> clients;
+
+  uint8_t receive_buffer[4096];
+  boost::asio::ip::udp::endpoint sender;
+
+  unsigned n_sent = 0, n_received = 0;
+  std::vector<Clock::duration> latencies;
+
+public:
+  CloudLoad(boost::asio::io_service &io_service,
+            boost::asio::ip::udp::endpoint _server,
+            unsigned n_clients, Clock::duration _interval,
+            Clock::duration duration)
+    :socket(io_service, boost::asio::ip::udp::endpoint(_server.protocol(), 0)),
+     server(_server),
+     timer(io_service), interval(_interval),
+     end_time(Clock::now() + duration),
+     clients(n_clients) {
+    /* scatter the clients in a 100 km square, which is crowded
+       enough that every traffic request gets a response */
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> latitude(47, 47.9);
+    std::uniform_real_distribution<double> longitude(8, 9.3);
+    std::uniform_real_distribution<double> track(0, 360);
+
+    for (auto &c : clients) {
+      c.location = GeoPoint(Angle::Degrees(longitude(rng)),
+                            Angle::Degrees(latitude(rng)));
+      c.track = Angle::Degrees(track(rng));
+    }
+
+    socket.set_option(boost::asio::socket_base::receive_buffer_size(4 * 1024 * 1024));
+  }
+
+  void Start() {
+    AsyncReceive();
+    Round(boost::system::error_code());
+  }
+
+  void Print(Clock::duration elapsed) const;
+
+private:
+  template<typename P>
+  void Send(const P &packet) {
+    boost::system::error_code ec;
+    socket.send_to(boost::asio::buffer(&packet, sizeof(packet)), server,
+                   0, ec);
+    if (!ec)
+      ++n_sent;
+  }
+
+  void Round(const boost::system::error_code &ec);
+  void AsyncReceive();
+  void OnReceive(const boost::system::error_code &ec, size_t nbytes);
+};
+
+void
+CloudLoad::Round(const boost::system::error_code &ec)
+{
+  if (ec)
+    return;
+
+  const auto now = Clock::now();
+  if (now >= end_time) {
+    /* give the server a moment to answer the last round */
+    timer.expires_from_now(std::chrono::milliseconds(500));
+    timer.async_wait([this](const boost::system::error_code &ec){
+        if (!ec)
+          socket.get_io_service().stop();
+      });
+    return;
+  }
+
+  const uint32_t time_of_day_ms =
+    std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count()
+    % (24 * 3600 * 1000);
+
+  for (unsigned i = 0; i < clients.size(); ++i) {
+    auto &c = clients[i];
+    const uint64_t key = KEY_BASE | i;
+
+    /* 40 m/s, i.e. a typical cross-country glider */
+    c.Move(40 * std::chrono::duration<double>(interval).count());
+
+    using SkyLinesTracking::FixPacket;
+    Send(SkyLinesTracking::MakeFix(key,
+                                   FixPacket::FLAG_LOCATION|FixPacket::FLAG_ALTITUDE,
+                                   time_of_day_ms, c.location, c.track,
+                                   0, 0, 1500, 0, 0));
+
+    c.request_time = Clock::now();
+    Send(SkyLinesTracking::MakeTrafficRequest(key, false, false, true));
+  }
+
+  timer.expires_at(now + interval);
+  timer.async_wait(std::bind(&CloudLoad::Round, this, std::placeholders::_1));
+}
+
+void
+CloudLoad::AsyncReceive()
+{
+  socket.async_receive_from(boost::asio::buffer(receive_buffer,
+                                                sizeof(receive_buffer)),
+                            sender,
+                            std::bind(&CloudLoad::OnReceive, this,
+                                      std::placeholders::_1,
+                                      std::placeholders::_2));
+}
+
+void
+CloudLoad::OnReceive(const boost::system::error_code &ec, size_t nbytes)
+{
+  if (ec) {
+    if (ec != boost::asio::error::operation_aborted)
+      fprintf(stderr, "Receive failed: %s\n", ec.message().c_str());
+    return;
+  }
+
+  const auto now = Clock::now();
+
+  const auto &header = *(const SkyLinesTracking::Header *)receive_buffer;
+  if (nbytes >= sizeof(header) &&
+      FromBE32(header.magic) == SkyLinesTracking::MAGIC &&
+      FromBE16(header.type) == SkyLinesTracking::Type::TRAFFIC_RESPONSE) {
+    const uint64_t key = FromBE64(header.key);
+    const uint64_t i = key & ~KEY_BASE;
+    if ((key & KEY_BASE) == KEY_BASE && i < clients.size()) {
+      auto &c = clients[i];
+
+      /* count only the first datagram of each response */
+      if (c.request_time != Clock::time_point::min()) {
+        latencies.push_back(now - c.request_time);
+        c.request_time = Clock::time_point::min();
+        ++n_received;
+      }
+    }
+  }
+
+  AsyncReceive();
+}
+
+static double
+ToMicroseconds(Clock::duration d)
+{
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+void
+CloudLoad::Print(Clock::duration elapsed) const
+{
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+
+  printf("clients=%u datagrams_sent=%u responses=%u\n",
+         unsigned(clients.size()), n_sent, n_received);
+  printf("requests_per_second=%.0f responses_per_second=%.0f\n",
+         n_sent / 2 / seconds, n_received / seconds);
+
+  if (latencies.empty())
+    return;
+
+  auto sorted = latencies;
+  std::sort(sorted.begin(), sorted.end());
+
+  auto percentile = [&sorted](unsigned p){
+    return ToMicroseconds(sorted[(sorted.size() - 1) * p / 100]);
+  };
+
+  printf("latency_us p50=%.0f p90=%.0f p99=%.0f max=%.0f\n",
+         percentile(50), percentile(90), percentile(99),
+         ToMicroseconds(sorted.back()));
+}
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv, "HOST[:PORT] N_CLIENTS [SECONDS [INTERVAL_MS]]");
+  const char *host = args.ExpectNext();
+  const unsigned n_clients = ParseUnsigned(args.ExpectNext());
+  const unsigned seconds = args.IsEmpty() ? 10 : ParseUnsigned(args.GetNext());
+  const unsigned interval_ms = args.IsEmpty()
+    ? 1000
+    : ParseUnsigned(args.GetNext());
+  args.ExpectEnd();
+
+  if (n_clients == 0 || n_clients > 0xffffff || interval_ms == 0) {
+    fprintf(stderr, "Invalid parameters\n");
+    return EXIT_FAILURE;
+  }
+
+  std::string host_name(host), port = std::to_string(DEFAULT_PORT);
+  const auto colon = host_name.rfind(':');
+  if (colon != std::string::npos) {
+    port = host_name.substr(colon + 1);
+    host_name.erase(colon);
+  }
+
+  boost::asio::io_service io_service;
+
+  boost::asio::ip::udp::resolver resolver(io_service);
+  const auto endpoint =
+    *resolver.resolve(boost::asio::ip::udp::resolver::query(boost::asio::ip::udp::v4(),
+                                                            host_name, port));
+
+  CloudLoad load(io_service, endpoint, n_clients,
+                 std::chrono::milliseconds(interval_ms),
+                 std::chrono::seconds(seconds));
+
+  const auto start = Clock::now();
+  load.Start();
+  io_service.run();
+  load.Print(Clock::now() - start);
+
+  return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+  fprintf(stderr, "%s\n", e.what());
+  return EXIT_FAILURE;
+}
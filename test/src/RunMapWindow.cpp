@@ -38,6 +38,7 @@ Copyright_License {
 #include "Waypoint/WaypointGlue.hpp"
 #include "Topography/TopographyStore.hpp"
 #include "Topography/TopographyGlue.hpp"
+#include "Topography/CachedTopographyRenderer.hpp"
 #include "Blackboard/DeviceBlackboard.hpp"
 #include "Airspace/AirspaceParser.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
@@ -48,6 +49,8 @@ Copyright_License {
 #include "Operation/Operation.hpp"
 #include "Thread/Debug.hpp"
 
+#include <stdio.h>
+
 void
 DeviceBlackboard::SetStartupLocation(const GeoPoint &loc, const double alt) {}
 
@@ -205,6 +208,14 @@ Main()
 
   main_window.RunEventLoop();
 
+  const auto *topography_renderer = map.GetTopographyRenderer();
+  if (topography_renderer != nullptr) {
+    const auto &stats = topography_renderer->GetRenderer().GetDrawStatistics();
+    printf("topography: %u frames, average %lu us, max %lu us\n",
+           stats.n_frames, (unsigned long)stats.GetAverageUS(),
+           (unsigned long)stats.max_us);
+  }
+
   delete terrain;
   delete topography;
 }
@@ -25,6 +25,7 @@
 #include "Printing.hpp"
 #include "OS/Args.hpp"
 #include "DebugReplay.hpp"
+#include "Thread/Parallel.hpp"
 
 #include <assert.h>
 #include <stdio.h>
@@ -162,6 +163,11 @@ int main(int argc, char **argv)
 
   args.ExpectEnd();
 
+  const unsigned n_workers = GetProcessorCount();
+  olc_fai.SetParallel(ParallelRun, n_workers);
+  olc_plus.SetParallel(ParallelRun, n_workers);
+  xcontest.SetParallel(ParallelRun, n_workers);
+
   int result = TestOLC(*replay);
   delete replay;
   return result;
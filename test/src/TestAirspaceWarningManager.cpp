@@ -0,0 +1,253 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+/*
+ * Flies along airspace borders with two AirspaceWarningManager
+ * instances, one with the clearance cache disabled, and checks that
+ * both report exactly the same warnings at every fix.
+ */
+
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspaceWarningManager.hpp"
+#include "Engine/Airspace/AirspaceWarningConfig.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Geo/Math.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+#include <math.h>
+
+static const GeoPoint center(Angle::Degrees(7), Angle::Degrees(51));
+
+static void
+SetHeights(AbstractAirspace &airspace, double base, double top)
+{
+  AirspaceAltitude _base, _top;
+  _base.altitude = base;
+  _base.reference = AltitudeReference::MSL;
+  _top.altitude = top;
+  _top.reference = AltitudeReference::MSL;
+  airspace.SetProperties(_T("test"), CTR, _base, _top);
+}
+
+/**
+ * A polygon with many vertices, alternating between 14 and 16 km
+ * from the center.
+ */
+static void
+AddJagged(Airspaces &airspaces)
+{
+  std::vector<GeoPoint> points;
+  const unsigned n = 300;
+  for (unsigned i = 0; i < n; ++i)
+    points.push_back(FindLatitudeLongitude(center,
+                                           Angle::FullCircle() * (double(i) / n),
+                                           i % 2 == 0 ? 14000 : 16000));
+
+  AbstractAirspace *airspace = new AirspacePolygon(points);
+  SetHeights(*airspace, 0, 1500);
+  airspaces.Add(airspace);
+}
+
+/**
+ * A long rectangle whose northern edge runs east-west 30 km north of
+ * the center.
+ */
+static void
+AddRectangle(Airspaces &airspaces)
+{
+  const GeoPoint nw(center.longitude - Angle::Degrees(0.3),
+                    center.latitude + Angle::Degrees(0.27));
+  const GeoPoint ne(nw.longitude + Angle::Degrees(0.6), nw.latitude);
+  const GeoPoint se(ne.longitude, ne.latitude - Angle::Degrees(0.05));
+  const GeoPoint sw(nw.longitude, se.latitude);
+
+  AbstractAirspace *airspace = new AirspacePolygon({nw, ne, se, sw});
+  SetHeights(*airspace, 500, 2000);
+  airspaces.Add(airspace);
+}
+
+static void
+AddCircle(Airspaces &airspaces)
+{
+  AbstractAirspace *airspace =
+    new AirspaceCircle(FindLatitudeLongitude(center, Angle::Degrees(90),
+                                             15000), 3000);
+  SetHeights(*airspace, 1000, 3000);
+  airspaces.Add(airspace);
+}
+
+static bool
+SameWarnings(const AirspaceWarningManager &a, const AirspaceWarningManager &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (auto i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j) {
+    if (&i->GetAirspace() != &j->GetAirspace() ||
+        i->GetWarningState() != j->GetWarningState())
+      return false;
+
+    const AirspaceInterceptSolution &s = i->GetSolution();
+    const AirspaceInterceptSolution &t = j->GetSolution();
+    if (s.distance != t.distance || s.altitude != t.altitude ||
+        s.elapsed_time != t.elapsed_time)
+      return false;
+  }
+
+  return true;
+}
+
+/** around the jagged polygon, weaving in and out of it */
+static GeoPoint
+WeaveJagged(double t)
+{
+  return FindLatitudeLongitude(center, Angle::FullCircle() * (t / 3000),
+                               15000 + 1500 * sin(t / 23));
+}
+
+/** around the jagged polygon, sweeping across each vertex spike */
+static GeoPoint
+HugJagged(double t)
+{
+  return FindLatitudeLongitude(center, Angle::FullCircle() * (t / 3000),
+                               14000 + 2000 * fmod(t / 5, 1));
+}
+
+/** along the northern edge of the rectangle, within 110 m of it */
+static GeoPoint
+AlongRectangle(double t)
+{
+  return GeoPoint(center.longitude + Angle::Degrees(-0.25 + 0.0006 * t),
+                  center.latitude +
+                  Angle::Degrees(0.27 + 0.001 * sin(t / 11)));
+}
+
+/** around the circle's edge, crossing it every few seconds */
+static GeoPoint
+AroundCircle(double t)
+{
+  return FindLatitudeLongitude(FindLatitudeLongitude(center,
+                                                     Angle::Degrees(90),
+                                                     15000),
+                               Angle::FullCircle() * (t / 1000),
+                               3000 + 300 * sin(t / 7));
+}
+
+static double
+Level(double t)
+{
+  return 1000;
+}
+
+static double
+Undulate(double t)
+{
+  return 1500 + 600 * sin(t / 41);
+}
+
+static double
+Climb(double t)
+{
+  return 2000 + 1200 * sin(t / 97);
+}
+
+/**
+ * Fly a path given as a function of time (one fix per second) with a
+ * cached and an uncached warning manager.
+ *
+ * @return true if both managers agreed at every fix and at least one
+ * warning was raised
+ */
+static bool
+Fly(const Airspaces &airspaces, unsigned duration,
+    GeoPoint (*path)(double t), double (*altitude)(double t))
+{
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+
+  AirspaceWarningManager cached(config, airspaces);
+  AirspaceWarningManager uncached(config, airspaces);
+  uncached.SetClearanceCache(false);
+
+  const GlidePolar glide_polar(1);
+  TaskStats task_stats;
+  task_stats.reset();
+
+  AircraftState state;
+  state.Reset();
+  state.flying = true;
+
+  unsigned n_warnings = 0, n_mismatches = 0;
+  for (unsigned t = 0; t <= duration; ++t) {
+    state.time = t;
+    state.location = path(t);
+    state.altitude = altitude(t);
+    state.vario = altitude(t + 1) - state.altitude;
+    const GeoPoint next = path(t + 1);
+    state.track = state.location.Bearing(next);
+    state.ground_speed = state.true_airspeed = state.location.Distance(next);
+
+    if (t == 0) {
+      cached.Reset(state);
+      uncached.Reset(state);
+      continue;
+    }
+
+    const bool circling = (t / 200) % 2 == 1;
+    cached.Update(state, glide_polar, task_stats, circling, 1);
+    uncached.Update(state, glide_polar, task_stats, circling, 1);
+
+    n_warnings += uncached.size();
+    if (!SameWarnings(cached, uncached))
+      ++n_mismatches;
+  }
+
+  if (n_mismatches > 0)
+    printf("# %u of %u fixes differ\n", n_mismatches, duration);
+
+  return n_mismatches == 0 && n_warnings > 0;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(4);
+
+  Airspaces airspaces;
+  AddJagged(airspaces);
+  AddRectangle(airspaces);
+  AddCircle(airspaces);
+  airspaces.Optimise();
+
+  ok1(Fly(airspaces, 3000, WeaveJagged, Undulate));
+  ok1(Fly(airspaces, 3000, HugJagged, Level));
+  ok1(Fly(airspaces, 1000, AlongRectangle, Undulate));
+  ok1(Fly(airspaces, 2000, AroundCircle, Climb));
+
+  return exit_status();
+}
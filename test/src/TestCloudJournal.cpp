@@ -0,0 +1,222 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#include "Cloud/Data.hpp"
+#include "Cloud/Journal.hpp"
+#include "Cloud/Serialiser.hpp"
+#include "Cloud/MemoryOutputStream.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "IO/FileReader.hxx"
+#include "OS/FileUtil.hpp"
+#include "OS/Path.hpp"
+#include "Util/PrintException.hxx"
+#include "TestUtil.hpp"
+
+#include <chrono>
+#include <vector>
+
+static const Path db_path(_T("output/test/cloud.db"));
+static const Path journal_path(_T("output/test/cloud.db.journal"));
+
+static const boost::asio::ip::udp::endpoint endpoint(boost::asio::ip::address_v4::loopback(),
+                                                     5597);
+
+static void
+AddClient(CloudData &data, uint64_t key)
+{
+  data.clients.Make(endpoint, key,
+                    GeoPoint(Angle::Degrees(7 + key * 0.01),
+                             Angle::Degrees(51)),
+                    1000 + key);
+}
+
+static void
+SaveSnapshot(const std::vector<uint8_t> &snapshot)
+{
+  FileOutputStream fos(db_path);
+  fos.Write(snapshot.data(), snapshot.size());
+  fos.Commit();
+}
+
+static std::vector<uint8_t>
+Serialise(const CloudData &data)
+{
+  MemoryOutputStream memory;
+  Serialiser s(memory);
+  data.Save(s);
+  s.Flush();
+  return std::move(memory.data);
+}
+
+static void
+LoadSnapshot(CloudData &data)
+{
+  FileReader fr(db_path);
+  Deserialiser s(fr);
+  data.Load(s);
+}
+
+/**
+ * How far did the simulated CloudServer::Save() get?
+ */
+enum class Crash {
+  /**
+   * After the cut, before the new snapshot was committed.
+   */
+  BEFORE_SNAPSHOT,
+
+  /**
+   * After the new snapshot was committed, before the journal was
+   * reset.
+   */
+  BEFORE_RESET,
+
+  /**
+   * No crash, the journal was reset.
+   */
+  NONE,
+};
+
+/**
+ * Simulate a server which saves generation 1 with client 1, records
+ * client 2 in the journal, then begins saving generation 2 while
+ * client 3 (which requests traffic) is recorded after the cut, and
+ * stops at the given point.
+ */
+static void
+RunServer(Crash crash, std::chrono::steady_clock::time_point wants_traffic)
+{
+  CloudData data;
+  CloudJournal journal(journal_path);
+
+  AddClient(data, 1);
+  data.journal_generation = 1;
+  SaveSnapshot(Serialise(data));
+  journal.Reset(1);
+
+  AddClient(data, 2);
+  journal.AppendClient(*data.clients.Find(2));
+  journal.Flush();
+
+  /* CloudServer::Save() */
+  const uint64_t generation = ++data.journal_generation;
+  const auto snapshot = Serialise(data);
+  journal.Cut(generation);
+
+  AddClient(data, 3);
+  auto &client3 = *data.clients.Find(3);
+  client3.wants_traffic = wants_traffic;
+  journal.AppendClient(client3);
+  journal.Flush();
+
+  if (crash == Crash::BEFORE_SNAPSHOT)
+    return;
+
+  SaveSnapshot(snapshot);
+
+  if (crash == Crash::BEFORE_RESET)
+    return;
+
+  journal.Reset(generation);
+}
+
+static unsigned
+Recover(CloudData &data)
+{
+  LoadSnapshot(data);
+  CloudJournal journal(journal_path);
+  return journal.Replay(data);
+}
+
+static bool
+CheckClient(CloudData &data, uint64_t key)
+{
+  const auto *client = data.clients.Find(key);
+  return client != nullptr && client->altitude == int(1000 + key);
+}
+
+static void
+TestCrash(Crash crash, uint64_t expected_generation, unsigned expected_n)
+{
+  /* time stamps are stored with a resolution of one second */
+  const auto wants_traffic = std::chrono::steady_clock::now() +
+    std::chrono::minutes(5);
+
+  RunServer(crash, wants_traffic);
+
+  CloudData data;
+  ok1(Recover(data) == expected_n);
+  ok1(data.journal_generation == expected_generation);
+  ok1(CheckClient(data, 1));
+  ok1(CheckClient(data, 2));
+  ok1(CheckClient(data, 3));
+
+  const auto *client3 = data.clients.Find(3);
+  ok1(client3 != nullptr &&
+      client3->wants_traffic > wants_traffic - std::chrono::seconds(2) &&
+      client3->wants_traffic < wants_traffic + std::chrono::seconds(2));
+  ok1(client3 != nullptr &&
+      client3->wants_thermals == std::chrono::steady_clock::time_point::min());
+}
+
+/**
+ * A journal which is older than the snapshot and has no cut for it
+ * is obsolete.
+ */
+static void
+TestObsolete()
+{
+  RunServer(Crash::BEFORE_RESET, std::chrono::steady_clock::now());
+
+  CloudData data;
+  LoadSnapshot(data);
+  data.journal_generation = 3;
+
+  CloudJournal journal(journal_path);
+  ok1(journal.Replay(data) == 0);
+  ok1(data.clients.Find(3) == nullptr);
+}
+
+int main(int argc, char **argv)
+try {
+  plan_tests(3 * 7 + 2);
+
+  Directory::Create(Path(_T("output/test")));
+
+  /* the old snapshot and the whole journal */
+  TestCrash(Crash::BEFORE_SNAPSHOT, 1, 2);
+
+  /* the new snapshot and the records after its cut in the old
+     journal */
+  TestCrash(Crash::BEFORE_RESET, 2, 1);
+
+  /* the new snapshot and the new journal */
+  TestCrash(Crash::NONE, 2, 1);
+
+  TestObsolete();
+
+  return exit_status();
+} catch (const std::exception &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
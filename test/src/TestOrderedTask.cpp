@@ -28,6 +28,10 @@
 #include "Engine/Task/Ordered/Points/FinishPoint.hpp"
 #include "Engine/Task/Ordered/Points/ASTPoint.hpp"
 #include "Engine/Task/ObservationZones/LineSectorZone.hpp"
+#include "Engine/Task/ObservationZones/CylinderZone.hpp"
+#include "OS/Clock.hpp"
+
+#include <stdio.h>
 
 #define ACCURACY 500
 
@@ -407,6 +411,45 @@ TestLowTPFinal()
   CheckTotal(aircraft, stats, tp1, tp2, tp3);
 }
 
+/**
+ * Measure the time needed by the minimum/maximum distance searches
+ * (#TaskDijkstraMin, #TaskDijkstraMax) of a task with large
+ * cylinders.
+ */
+static void
+BenchScanDistance()
+{
+  OrderedTask task(task_behaviour);
+  const StartPoint tp1(new CylinderZone(wp1->location, 5000),
+                       WaypointPtr(wp1), task_behaviour,
+                       ordered_task_settings.start_constraints);
+  task.Append(tp1);
+  const ASTPoint tp2(new CylinderZone(wp3->location, 20000),
+                     WaypointPtr(wp3), task_behaviour);
+  task.Append(tp2);
+  const ASTPoint tp3(new CylinderZone(wp4->location, 20000),
+                     WaypointPtr(wp4), task_behaviour);
+  task.Append(tp3);
+  const FinishPoint tp4(new CylinderZone(wp5->location, 5000),
+                        WaypointPtr(wp5), task_behaviour,
+                        ordered_task_settings.finish_constraints, false);
+  task.Append(tp4);
+
+  static constexpr unsigned n_runs = 200;
+
+  const auto start = MonotonicClockUS();
+  for (unsigned i = 0; i < n_runs; ++i)
+    /* this runs both searches */
+    task.UpdateGeometry();
+  const auto elapsed = MonotonicClockUS() - start;
+
+  printf("# task distance scan: %u us per update\n",
+         unsigned(elapsed / n_runs));
+
+  const TaskStats &stats = task.GetStats();
+  ok1(stats.distance_max > stats.distance_min);
+}
+
 static void
 TestAll()
 {
@@ -421,7 +464,7 @@ TestAll()
 
 int main(int argc, char **argv)
 {
-  plan_tests(728);
+  plan_tests(729);
 
   task_behaviour.SetDefaults();
 
@@ -436,5 +479,7 @@ int main(int argc, char **argv)
   glide_polar.SetMC(4);
   TestAll();
 
+  BenchScanDistance();
+
   return exit_status();
 }
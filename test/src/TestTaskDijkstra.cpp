@@ -0,0 +1,230 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#include "Engine/Task/PathSolvers/TaskDijkstraMin.hpp"
+#include "Engine/Task/PathSolvers/TaskDijkstraMax.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "OS/Clock.hpp"
+#include "TestUtil.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr unsigned NUM_STAGES = 6;
+
+static SearchPointVector boundaries[NUM_STAGES];
+static Serial serials[NUM_STAGES];
+
+static GeoPoint
+RandomPoint(const GeoPoint &center, double radius)
+{
+  return GeoVector(radius * (rand() % 1000) / 1000.,
+                   Angle::Degrees(rand() % 360)).EndPoint(center);
+}
+
+/**
+ * Fill a stage with a random point cloud around its nominal
+ * location.
+ */
+static void
+RandomiseStage(unsigned stage)
+{
+  const GeoPoint center(Angle::Degrees(7 + 0.4 * (stage % 2)),
+                        Angle::Degrees(51 + 0.3 * stage));
+  const unsigned n = stage == 0 || stage + 1 == NUM_STAGES
+    ? 1 + rand() % 4
+    : 8 + rand() % 40;
+
+  boundaries[stage].clear();
+  for (unsigned i = 0; i < n; ++i)
+    boundaries[stage].emplace_back(RandomPoint(center, 20000));
+
+  ++serials[stage];
+}
+
+static void
+SetBoundaries(TaskDijkstra &dijkstra, unsigned first)
+{
+  for (unsigned i = first; i < NUM_STAGES; ++i)
+    dijkstra.SetBoundary(i - first, boundaries[i], serials[i]);
+}
+
+/**
+ * Calculate the total (integer) distance of the solution, the same
+ * way #TaskDijkstra does.
+ */
+template<typename T>
+static unsigned
+SolutionDistance(const T &dijkstra, unsigned n_stages,
+                 const SearchPoint &location)
+{
+  unsigned distance = location.IsValid()
+    ? unsigned(dijkstra.GetSolution(0).GetLocation()
+               .Distance(location.GetLocation()))
+    : 0;
+
+  for (unsigned i = 1; i < n_stages; ++i)
+    distance += unsigned(dijkstra.GetSolution(i - 1).GetLocation()
+                         .Distance(dijkstra.GetSolution(i).GetLocation()));
+
+  return distance;
+}
+
+/**
+ * Modify single stages between searches and verify that the
+ * incremental mode finds solutions as good as the full search.  Like
+ * in a flight, the active task point stays the same for a while and
+ * then advances, so the minimum search re-expands only the stages
+ * affected by each modification.
+ */
+static void
+TestIncremental()
+{
+  for (unsigned i = 0; i < NUM_STAGES; ++i)
+    RandomiseStage(i);
+
+  TaskDijkstraMin full_min, incremental_min;
+  TaskDijkstraMax full_max, incremental_max;
+  incremental_min.SetIncremental(true);
+  incremental_max.SetIncremental(true);
+
+  bool min_ok = true, max_ok = true;
+
+  /* like OrderedTask, the minimum search starts at the active task
+     point */
+  for (unsigned active = 0; active < NUM_STAGES; ++active) {
+    const unsigned n_stages = NUM_STAGES - active;
+
+    for (unsigned run = 0; run < 40; ++run) {
+      if (rand() % 2 == 0)
+        RandomiseStage(rand() % NUM_STAGES);
+
+      /* alternate between runs with and without an aircraft
+         location: without one, the forward values are kept, too */
+      const SearchPoint location = (run / 5) % 2 == 0
+        ? SearchPoint::Invalid()
+        : SearchPoint(RandomPoint(boundaries[active].front().GetLocation(),
+                                  50000));
+
+      full_min.SetTaskSize(n_stages);
+      SetBoundaries(full_min, active);
+      incremental_min.SetTaskSize(n_stages);
+      SetBoundaries(incremental_min, active);
+
+      if (!full_min.DistanceMin(location) ||
+          !incremental_min.DistanceMin(location) ||
+          SolutionDistance(full_min, n_stages, location) !=
+          SolutionDistance(incremental_min, n_stages, location))
+        min_ok = false;
+
+      full_max.SetTaskSize(NUM_STAGES);
+      SetBoundaries(full_max, 0);
+      incremental_max.SetTaskSize(NUM_STAGES);
+      SetBoundaries(incremental_max, 0);
+
+      if (!full_max.DistanceMax() || !incremental_max.DistanceMax() ||
+          SolutionDistance(full_max, NUM_STAGES, SearchPoint::Invalid()) !=
+          SolutionDistance(incremental_max, NUM_STAGES,
+                           SearchPoint::Invalid()))
+        max_ok = false;
+    }
+  }
+
+  ok(min_ok, "incremental minimum search", 0);
+  ok(max_ok, "incremental maximum search", 0);
+}
+
+/**
+ * Measure typical flight situations: the aircraft moves, and (if
+ * add_samples is true) the samples of the active task point change.
+ */
+static void
+BenchIncremental(bool incremental, bool add_samples)
+{
+  for (unsigned i = 0; i < NUM_STAGES; ++i)
+    RandomiseStage(i);
+
+  static constexpr unsigned active = 2;
+  static constexpr unsigned n_runs = 200;
+
+  SearchPointVector samples;
+  Serial samples_serial;
+  samples.emplace_back(boundaries[active].front());
+
+  TaskDijkstraMin dijkstra_min;
+  TaskDijkstraMax dijkstra_max;
+  dijkstra_min.SetIncremental(incremental);
+  dijkstra_max.SetIncremental(incremental);
+
+  const auto start = MonotonicClockUS();
+
+  for (unsigned run = 0; run < n_runs; ++run) {
+    const SearchPoint location(RandomPoint(boundaries[active].front()
+                                           .GetLocation(), 20000));
+
+    if (add_samples) {
+      /* SampledTaskPoint keeps at most 64 samples */
+      if (samples.size() >= 64)
+        samples.erase(samples.begin());
+      samples.emplace_back(location);
+      ++samples_serial;
+    }
+
+    /* like OrderedTask: the minimum search uses the samples of the
+       active task point, the maximum search its whole boundary */
+    dijkstra_min.SetTaskSize(NUM_STAGES - active);
+    SetBoundaries(dijkstra_min, active);
+    dijkstra_min.SetBoundary(0, samples, samples_serial);
+    dijkstra_min.DistanceMin(location);
+
+    if (add_samples) {
+      /* OrderedTask runs the maximum search only after the samples
+         have changed */
+      dijkstra_max.SetTaskSize(NUM_STAGES);
+      SetBoundaries(dijkstra_max, 0);
+      dijkstra_max.DistanceMax();
+    }
+  }
+
+  const auto elapsed = MonotonicClockUS() - start;
+  printf("# %s search, %s: %u us per fix\n",
+         incremental ? "incremental" : "full",
+         add_samples ? "new sample" : "moving",
+         unsigned(elapsed / n_runs));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(2);
+
+  srand(42);
+  TestIncremental();
+
+  BenchIncremental(false, false);
+  BenchIncremental(true, false);
+  BenchIncremental(false, true);
+  BenchIncremental(true, true);
+
+  return exit_status();
+}
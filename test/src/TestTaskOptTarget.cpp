@@ -0,0 +1,152 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Task/Ordered/OrderedTask.hpp"
+#include "Engine/Task/Ordered/Settings.hpp"
+#include "Engine/Task/Ordered/Points/AATPoint.hpp"
+#include "Engine/Task/Ordered/Points/StartPoint.hpp"
+#include "Engine/Task/Ordered/Points/FinishPoint.hpp"
+#include "Engine/Task/ObservationZones/CylinderZone.hpp"
+#include "Engine/Task/Solvers/TaskOptTarget.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "TestUtil.hpp"
+
+static TaskBehaviour task_behaviour;
+static OrderedTaskSettings ordered_task_settings;
+static GlidePolar glide_polar(1);
+
+static GeoPoint
+MakeGeoPoint(double longitude, double latitude)
+{
+  return GeoPoint(Angle::Degrees(longitude),
+                  Angle::Degrees(latitude));
+}
+
+static WaypointPtr
+MakeWaypointPtr(double longitude, double latitude)
+{
+  Waypoint wp(MakeGeoPoint(longitude, latitude));
+  wp.elevation = 50;
+  return WaypointPtr(new Waypoint(wp));
+}
+
+static const auto wp1 = MakeWaypointPtr(0, 45);
+static const auto wp2 = MakeWaypointPtr(0.1, 45.5);
+static const auto wp3 = MakeWaypointPtr(0.7, 45.8);
+static const auto wp4 = MakeWaypointPtr(1.1, 45.3);
+static const auto wp5 = MakeWaypointPtr(0.3, 45.1);
+
+/**
+ * Creates a task with three areas; the aircraft is on its way to the
+ * given one.
+ */
+static void
+MakeTask(OrderedTask &task, unsigned active, AircraftState &aircraft)
+{
+  task.Append(StartPoint(new CylinderZone(wp1->location, 500),
+                         WaypointPtr(wp1), task_behaviour,
+                         ordered_task_settings.start_constraints));
+  task.Append(AATPoint(new CylinderZone(wp2->location, 20000),
+                       WaypointPtr(wp2), task_behaviour));
+  task.Append(AATPoint(new CylinderZone(wp3->location, 25000),
+                       WaypointPtr(wp3), task_behaviour));
+  task.Append(AATPoint(new CylinderZone(wp4->location, 15000),
+                       WaypointPtr(wp4), task_behaviour));
+  task.Append(FinishPoint(new CylinderZone(wp5->location, 500),
+                          WaypointPtr(wp5), task_behaviour,
+                          ordered_task_settings.finish_constraints));
+  task.SetActiveTaskPoint(active);
+  task.UpdateGeometry();
+
+  /* halfway along the leg to the active area */
+  aircraft.Reset();
+  aircraft.location =
+    task.GetPoint(active - 1).GetWaypoint().location
+    .Interpolate(task.GetPoint(active).GetWaypoint().location, 0.5);
+  aircraft.altitude = 1500;
+  aircraft.flying = true;
+}
+
+struct OptResult {
+  double p;
+  double time_elapsed;
+};
+
+/**
+ * Optimise the target of the active area.  If #sequential is set,
+ * then only the minimum search of the original implementation is
+ * used.
+ */
+static OptResult
+Optimise(unsigned active, bool sequential)
+{
+  OrderedTask task(task_behaviour);
+  AircraftState aircraft;
+  MakeTask(task, active, aircraft);
+
+  std::vector<OrderedTaskPoint *> tps;
+  for (unsigned i = 0; i < task.TaskSize(); ++i)
+    tps.push_back(&task.GetPoint(i));
+
+  TaskOptTarget tot(tps, active, aircraft, task_behaviour.glide,
+                    glide_polar, (AATPoint &)task.GetPoint(active),
+                    task.GetTaskProjection(),
+                    (StartPoint *)&task.GetPoint(0));
+
+  OptResult result;
+  result.p = sequential
+    ? tot.find_min(0.5)
+    : tot.search(0.5);
+
+  result.time_elapsed = result.p >= 0 ? tot.f(result.p) : -1;
+  return result;
+}
+
+static void
+TestOptimise(unsigned active)
+{
+  const OptResult old_result = Optimise(active, true);
+  const OptResult result = Optimise(active, false);
+
+  ok1(result.p >= 0);
+  ok1(result.time_elapsed > 0);
+
+  /* the batch must find a target at least as good as the sequential
+     minimum search */
+  ok1(result.time_elapsed <= old_result.time_elapsed + 1);
+  ok1(equals(result.p, old_result.p, 50));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(3 * 4);
+
+  task_behaviour.SetDefaults();
+  ordered_task_settings.SetDefaults();
+
+  for (unsigned active = 1; active <= 3; ++active)
+    TestOptimise(active);
+
+  return exit_status();
+}
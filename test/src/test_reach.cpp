@@ -35,6 +35,8 @@
 #include "Geo/SpeedVector.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/FileUtil.hpp"
+#include "OS/Clock.hpp"
+#include "Thread/Parallel.hpp"
 
 #include <zzip/zzip.h>
 
@@ -101,6 +103,75 @@ test_reach(const RasterMap &map, double mwind, double mc, double height_min_work
   //  printf("# pixel size %g\n", (double)pd);
 }
 
+/**
+ * Sum of the terrain arrival heights on a grid around the origin;
+ * used to verify that the parallel solver gives the same result.
+ */
+static long
+ReachChecksum(const TerrainRoute &route, const RasterMap &map,
+              const GeoPoint &origin)
+{
+  long sum = 0;
+  for (int i = -10; i <= 10; ++i) {
+    for (int j = -10; j <= 10; ++j) {
+      GeoPoint x(origin.longitude + Angle::Degrees(0.05 * i),
+                 origin.latitude + Angle::Degrees(0.05 * j));
+      AGeoPoint adest(x, map.GetInterpolatedHeight(x).GetValueOr0());
+      ReachResult reach;
+      route.FindPositiveArrival(adest, reach);
+      sum += (long)reach.terrain;
+    }
+  }
+
+  return sum;
+}
+
+/**
+ * Measure the terrain reach solve time with 1, 2 and 4 worker
+ * threads.
+ */
+static void
+bench_reach(const RasterMap &map)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  RoutePlannerConfig config;
+  config.SetDefaults();
+
+  GlidePolar polar(0.1);
+  SpeedVector wind(Angle::Degrees(0), 0);
+  TerrainRoute route;
+  route.UpdatePolar(settings, config, polar, polar, wind, 0);
+  route.SetTerrain(&map);
+
+  const GeoPoint origin(map.GetMapCenter());
+  const AGeoPoint aorigin(origin,
+                          map.GetHeight(origin).GetValueOr0() + 1000);
+
+  static constexpr unsigned n_runs = 20;
+  long checksum = 0;
+
+  for (unsigned n_workers = 1; n_workers <= 4; n_workers *= 2) {
+    route.SetParallel(ParallelRun, n_workers);
+
+    const auto start = MonotonicClockUS();
+    for (unsigned i = 0; i < n_runs; ++i)
+      route.SolveReachTerrain(aorigin, config, INT_MAX);
+    const auto elapsed = MonotonicClockUS() - start;
+
+    printf("# reach terrain with %u thread(s): %u us per solve\n",
+           n_workers, unsigned(elapsed / n_runs));
+
+    const long sum = ReachChecksum(route, map, origin);
+    if (n_workers == 1)
+      checksum = sum;
+    else
+      ok(sum == checksum, "parallel reach terrain", 0);
+  }
+
+  printf("# %u processor(s)\n", GetProcessorCount());
+}
+
 int main(int argc, char** argv) {
   static const char hc_path[] = "tmp/map.xcm";
   const char *map_path;
@@ -135,11 +206,12 @@ int main(int argc, char** argv) {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(8);
+  plan_tests(10);
   test_reach(map, 0, 0.1, 0);
   test_reach(map, 0, 0.1, 750);
   test_reach(map, 0, 0.1, 500);
   test_reach(map, 0, 0.1, 250);
+  bench_reach(map);
 
   return exit_status();
 }
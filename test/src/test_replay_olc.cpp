@@ -6,6 +6,7 @@
 #include "Computer/Settings.hpp"
 #include "OS/ConvertPathName.hpp"
 #include "OS/FileUtil.hpp"
+#include "OS/Clock.hpp"
 #include "IO/FileLineReader.hpp"
 #include "NMEA/MoreData.hpp"
 #include "NMEA/Derived.hpp"
@@ -165,6 +166,8 @@ test_replay(const Contest olc_type,
 
   DerivedInfo calculated;
 
+  uint64_t solver_us = 0;
+
   while (sim.Update(basic)) {
     n_samples++;
 
@@ -176,7 +179,9 @@ test_replay(const Contest olc_type,
     
     trace_computer.Update(settings_computer, basic, calculated);
     
+    const auto start = MonotonicClockUS();
     contest_manager.UpdateIdle();
+    solver_us += MonotonicClockUS() - start;
   
     if (verbose>1) {
       sim.print(f, basic);
@@ -188,7 +193,11 @@ test_replay(const Contest olc_type,
     do_print = (++print_counter % output_skip ==0) && verbose;
   };
 
+  const auto start = MonotonicClockUS();
   contest_manager.SolveExhaustive();
+  solver_us += MonotonicClockUS() - start;
+
+  std::cout << "# solver time " << solver_us / 1000 << " ms\n";
 
   if (verbose) {
     PrintDistanceCounts();
@@ -25,6 +25,8 @@
 #include "Route/AirspaceRoute.hpp"
 #include "Engine/Airspace/AirspaceAircraftPerformance.hpp"
 #include "Engine/Airspace/Predicate/AirspacePredicate.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspaceIntersectionVector.hpp"
 #include "Geo/SpeedVector.hpp"
 #include "Geo/GeoVector.hpp"
 #include "GlideSolvers/GlideSettings.hpp"
@@ -33,6 +35,7 @@
 #include "Terrain/Loader.hpp"
 #include "OS/ConvertPathName.hpp"
 #include "OS/FileUtil.hpp"
+#include "OS/Clock.hpp"
 #include "Compatibility/path.h"
 #include "Operation/Operation.hpp"
 #include "test_debug.hpp"
@@ -45,6 +48,167 @@
 
 #define NUM_SOL 15
 
+/**
+ * Solve a series of routes with an approaching destination, and
+ * return the total solver time in microseconds.
+ */
+static uint64_t
+solve_routes(AirspaceRoute &route, const Airspaces &airspaces,
+             const RasterMap &map, const RoutePlannerConfig &config,
+             const AGeoPoint &loc_start, AGeoPoint loc_end,
+             std::vector<Route> &solutions)
+{
+  AirspacePredicateTrue predicate;
+
+  uint64_t total = 0;
+  for (int i = 0; i < NUM_SOL; i++) {
+    loc_end.latitude += Angle::Degrees(0.1);
+    loc_end.altitude = map.GetHeight(loc_end).GetValueOr0() + 100;
+
+    const auto start = MonotonicClockUS();
+    route.Synchronise(airspaces, predicate, loc_start, loc_end);
+    route.Solve(loc_start, loc_end, config);
+    total += MonotonicClockUS() - start;
+
+    solutions.push_back(route.GetSolution());
+  }
+
+  return total;
+}
+
+/**
+ * Compare the solver with and without the airspace clearance grid.
+ */
+static bool
+test_clearance_grid(const Airspaces &airspaces, const RasterMap &map,
+                    const AGeoPoint &loc_start, const AGeoPoint &loc_end)
+{
+  SpeedVector wind(Angle::Degrees(0), 0);
+  GlidePolar polar(1);
+
+  GlideSettings settings;
+  settings.SetDefaults();
+  RoutePlannerConfig config;
+  config.mode = RoutePlannerConfig::Mode::BOTH;
+
+  std::vector<Route> solutions[2];
+  uint64_t elapsed[2];
+
+  for (unsigned use_grid = 0; use_grid < 2; ++use_grid) {
+    AirspaceRoute route;
+    route.UpdatePolar(settings, config, polar, polar, wind);
+    route.SetTerrain(&map);
+    route.SetClearanceGrid(use_grid);
+
+    elapsed[use_grid] = solve_routes(route, airspaces, map, config,
+                                     loc_start, loc_end,
+                                     solutions[use_grid]);
+  }
+
+  printf("# route solve without clearance grid: %u us\n",
+         (unsigned)elapsed[0]);
+  printf("# route solve with clearance grid: %u us\n",
+         (unsigned)elapsed[1]);
+
+  if (solutions[0].size() != solutions[1].size())
+    return false;
+
+  for (unsigned i = 0; i < solutions[0].size(); ++i) {
+    const Route &a = solutions[0][i], &b = solutions[1][i];
+    if (a.size() != b.size())
+      return false;
+
+    for (unsigned j = 0; j < a.size(); ++j)
+      if (!(a[j] == b[j]) || a[j].altitude != b[j].altitude)
+        return false;
+  }
+
+  return true;
+}
+
+/**
+ * Check one link against the clearance grid: if the exact test finds
+ * an intersection with any airspace, the grid must not claim that
+ * the link is clear.
+ */
+static bool
+check_clearance_grid_link(const AirspaceClearanceGrid &grid,
+                          const Airspaces &airspaces,
+                          const GeoPoint &a, const GeoPoint &b)
+{
+  const FlatProjection &projection = airspaces.GetProjection();
+  if (!grid.IsClear(projection.ProjectInteger(a),
+                    projection.ProjectInteger(b)))
+    return true;
+
+  for (const auto &i : airspaces.QueryAll())
+    if (!i.GetAirspace().Intersects(a, b, projection).empty())
+      return false;
+
+  return true;
+}
+
+/**
+ * Verify that the clearance grid never skips a link which the exact
+ * test would report, including links completely inside a circle or a
+ * polygon.
+ */
+static bool
+test_clearance_grid_links(const GeoPoint &center)
+{
+  Airspaces airspaces;
+  setup_airspaces(airspaces, center, 28);
+
+  AirspaceClearanceGrid grid;
+  grid.Build(airspaces);
+
+  unsigned n_inside_polygon = 0;
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &as = i.GetAirspace();
+    const GeoPoint a = as.GetCenter();
+    GeoPoint b;
+
+    if (as.GetShape() == AbstractAirspace::Shape::CIRCLE) {
+      const AirspaceCircle &circle = (const AirspaceCircle &)as;
+      b = GeoVector(circle.GetRadius() / 2, Angle::Degrees(90)).EndPoint(a);
+    } else {
+      /* the polygons are convex; this link stays well inside, so
+         only the exact test can tell that it is inside */
+      b = a.Interpolate(as.GetPoints().front().GetLocation(), 0.25);
+      if (!as.Inside(a) || !as.Inside(b))
+        return false;
+
+      const FlatProjection &projection = airspaces.GetProjection();
+      if (grid.IsClear(projection.ProjectInteger(a),
+                       projection.ProjectInteger(b)))
+        ++n_inside_polygon;
+    }
+
+    if (!check_clearance_grid_link(grid, airspaces, a, b))
+      return false;
+  }
+
+  if (n_inside_polygon == 0)
+    /* no link inside a polygon was small enough to test the grid's
+       interior cells */
+    return false;
+
+  for (unsigned i = 0; i < 1000; ++i) {
+    GeoPoint a = center;
+    a.longitude += Angle::Degrees((rand() % 1400 - 700) / 1000.);
+    a.latitude += Angle::Degrees((rand() % 1400 - 700) / 1000.);
+
+    GeoPoint b = a;
+    b.longitude += Angle::Degrees((rand() % 200 - 100) / 1000.);
+    b.latitude += Angle::Degrees((rand() % 200 - 100) / 1000.);
+
+    if (!check_clearance_grid_link(grid, airspaces, a, b))
+      return false;
+  }
+
+  return true;
+}
+
 static bool
 test_route(const unsigned n_airspaces, const RasterMap& map)
 {
@@ -146,6 +310,9 @@ test_route(const unsigned n_airspaces, const RasterMap& map)
     RoutePlannerConfig config;
     config.mode = RoutePlannerConfig::Mode::BOTH;
 
+    ok(test_clearance_grid(airspaces, map, loc_start, loc_end),
+       "route with clearance grid", 0);
+
     AirspaceRoute route;
     route.UpdatePolar(settings, config, polar, polar, wind);
     route.SetTerrain(&map);
@@ -182,19 +349,26 @@ main(int argc, char** argv)
 {
   static const char map_path[] = "tmp/map.xcm";
 
+  plan_tests(6 + NUM_SOL);
+
+  /* doesn't need the map */
+  ok(test_clearance_grid_links(GeoPoint(Angle::Degrees(146),
+                                        Angle::Degrees(-36))),
+     "clearance grid links", 0);
+
   ZZIP_DIR *dir = zzip_dir_open(map_path, nullptr);
   if (dir == nullptr) {
-    fprintf(stderr, "Failed to open %s\n", map_path);
-    return EXIT_FAILURE;
+    skip(5 + NUM_SOL, 1, "Failed to open map");
+    return exit_status();
   }
 
   RasterMap map;
 
   NullOperationEnvironment operation;
   if (!LoadTerrainOverview(dir, map.GetTileCache(), operation)) {
-    fprintf(stderr, "failed to load map\n");
     zzip_dir_close(dir);
-    return EXIT_FAILURE;
+    skip(5 + NUM_SOL, 1, "Failed to load map");
+    return exit_status();
   }
 
   map.UpdateProjection();
@@ -207,7 +381,6 @@ main(int argc, char** argv)
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(4 + NUM_SOL);
   ok(test_route(28, map), "route 28", 0);
   return exit_status();
 }
@@ -106,6 +106,67 @@ test_troute(const RasterMap &map, double mwind, double mc, int ceiling)
   // route.UpdatePolar(polar, wind);
 }
 
+/**
+ * Simulate an aircraft approaching a fixed target while climbing, and
+ * verify that the solutions obtained with the terrain clearance cache
+ * equal those of a planner which starts from scratch each time.  The
+ * ceiling follows the aircraft's altitude like in RouteComputer.
+ */
+static void
+test_troute_cache(const RasterMap &map)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.mode = RoutePlannerConfig::Mode::BOTH;
+  config.use_ceiling = true;
+
+  GlidePolar polar(0.1);
+  SpeedVector wind(Angle::Degrees(0), 0);
+
+  TerrainRoute cached, fresh;
+  cached.UpdatePolar(settings, config, polar, polar, wind);
+  cached.SetTerrain(&map);
+  fresh.UpdatePolar(settings, config, polar, polar, wind);
+  fresh.SetTerrain(&map);
+
+  const GeoPoint origin(map.GetMapCenter());
+  const AGeoPoint aorigin(origin, map.GetHeight(origin).GetValueOr0() + 100);
+
+  bool equal = true;
+  for (unsigned i = 0; i < 20; ++i) {
+    const GeoPoint dest =
+      GeoVector(40000. - 200. * i, Angle::Degrees(45)).EndPoint(origin);
+    const AGeoPoint adest(dest, aorigin.altitude + 300 + 3 * i);
+    const int ceiling = adest.altitude + 500;
+
+    cached.Solve(aorigin, adest, config, ceiling);
+
+    fresh.Reset();
+    fresh.Solve(aorigin, adest, config, ceiling);
+
+    const Route &a = cached.GetSolution(), &b = fresh.GetSolution();
+    if (a.size() != b.size())
+      equal = false;
+    else
+      for (unsigned j = 0; j < a.size(); ++j)
+        if (!(a[j] == b[j]) || a[j].altitude != b[j].altitude)
+          equal = false;
+  }
+
+  const auto &stats = cached.GetClearanceCacheStatistics();
+  printf("# clearance cache: %lu hits, %lu misses (%.0f%%), %lu flushes\n",
+         stats.hits, stats.misses, stats.GetHitRate() * 100,
+         stats.flushes);
+
+  ok(fresh.GetClearanceCacheStatistics().misses > 0,
+     "terrain route queries terrain", 0);
+  ok(equal, "terrain route with clearance cache", 0);
+  ok(stats.hits > stats.misses,
+     "clearance cache survives ceiling changes", 0);
+}
+
 int main(int argc, char** argv) {
   static const char hc_path[] = "tmp/map.xcm";
   const char *map_path;
@@ -141,10 +202,11 @@ int main(int argc, char** argv) {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(16*3);
+  plan_tests(17*3+3);
   test_troute(map, 0, 0.1, 10000);
   test_troute(map, 0, 0, 10000);
   test_troute(map, 5.0, 1, 10000);
+  test_troute_cache(map);
 
   return exit_status();
 }